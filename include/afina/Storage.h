@@ -1,7 +1,11 @@
 #ifndef AFINA_STORAGE_H
 #define AFINA_STORAGE_H
 
+#include <functional>
+#include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace Afina {
 
@@ -84,6 +88,48 @@ public:
      * @param value output parameter to copy value to
      */
     virtual bool Get(const std::string &key, std::string &value) = 0;
+
+    /**
+     * Appends backend specific statistics to be reported by the stats command, as
+     * name/value pairs. Default implementation reports nothing
+     *
+     * @param stats output parameter to append statistics to
+     */
+    virtual void Stats(std::vector<std::pair<std::string, std::string>> &stats) {}
+
+    /**
+     * Calls visitor for every item, least recently used first, so putting items back in the same order restores
+     * eviction order too. Visitor must not change the storage. Default implementation doesn't support iteration
+     * and throws std::runtime_error
+     *
+     * @param visitor function to be called with key and value of every item
+     */
+    virtual void ForEach(const std::function<void(const std::string &key, const std::string &value)> &visitor) {
+        throw std::runtime_error("Storage doesn't support iteration");
+    }
+
+    /**
+     * Same as ForEach(), but for the process forked inside Exclusive(). Locks copied into such child are held by
+     * the parent's thread, so the child must neither take nor release them: thread safe backends iterate here
+     * without locking. Backends which data isn't copied by fork, like shared memory, keep locking. Default
+     * implementation calls ForEach()
+     *
+     * @param visitor function to be called with key and value of every item
+     */
+    virtual void ForEachUnlocked(const std::function<void(const std::string &key, const std::string &value)> &visitor) {
+        ForEach(visitor);
+    }
+
+    /**
+     * Runs the function while no other thread could change the storage. Thread safe backends hold their lock for
+     * the call, single threaded ones just call it
+     *
+     * Function may fork. Child must not return from it, since that releases the lock it doesn't own, it reads the
+     * storage only by ForEachUnlocked() and finishes by _exit()
+     *
+     * @param fn function to be called
+     */
+    virtual void Exclusive(const std::function<void()> &fn) { fn(); }
 };
 
 } // namespace Afina
@@ -0,0 +1,88 @@
+#ifndef AFINA_ALLOCATOR_ARENA_H
+#define AFINA_ALLOCATOR_ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * # Bump arena
+ * Hands out memory by moving pointer forward through the current block, individual frees do nothing and
+ * memory gets back all at once by reset(). Once block is exhausted the next one, at least twice larger, is
+ * taken from heap. On reset all blocks are merged into the single one of their total size, so after warm up
+ * the same request pattern gets served without touching heap at all.
+ *
+ * Objects placed into arena must be destroyed before reset, arena doesn't call destructors. Not threadsafe
+ */
+class Arena {
+public:
+    explicit Arena(std::size_t block_size = 4096);
+    Arena(const Arena &) = delete;
+    ~Arena();
+
+    /**
+     * Returns size bytes aligned to the given boundary, which must not exceed alignment of std::max_align_t.
+     * Throws std::bad_alloc if heap is exhausted
+     */
+    void *alloc(std::size_t size, std::size_t align = alignof(std::max_align_t)) {
+        std::size_t offset = (_used + align - 1) & ~(align - 1);
+        if (_head == nullptr || offset + size > _head->size) {
+            return _Grow(size);
+        }
+        _used = offset + size;
+        return _head->data() + offset;
+    }
+
+    /**
+     * Does nothing, memory is released by reset()
+     */
+    void free(void *) {}
+
+    /**
+     * Constructs object of type T in the arena
+     */
+    template <typename T, typename... Args> T *make(Args &&... args) {
+        return new (alloc(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * Makes all memory available again, all objects must be destroyed already
+     */
+    void reset();
+
+    /**
+     * Returns number of bytes reserved by the arena
+     */
+    std::size_t capacity() const;
+
+private:
+    struct alignas(std::max_align_t) block {
+        block *next;
+        std::size_t size;
+
+        char *data() { return reinterpret_cast<char *>(this) + sizeof(block); }
+    };
+
+    // Takes new block from heap and allocates from it
+    void *_Grow(std::size_t size);
+
+    // Returns all blocks to heap
+    void _Release();
+
+    // Current block, previous ones are linked through next
+    block *_head;
+
+    // Bytes allocated in the current block
+    std::size_t _used;
+
+    // Size of the first block
+    const std::size_t _block_size;
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_ARENA_H
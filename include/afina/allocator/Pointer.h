@@ -7,6 +7,14 @@ namespace Allocator {
 // to avoid expensive macros calculations and increase compile speed
 class Simple;
 
+/**
+ * Handle to the memory block allocated by Simple. Instead of the block address pointer keeps address of the
+ * slot in the allocator's descriptors table, which holds the block address. That way allocator could move
+ * blocks, for example during defragmentation, and pointers remain valid.
+ *
+ * Copies of the pointer refer to the same block. Once block is freed through some pointer the rest of copies
+ * become dangling
+ */
 class Pointer {
 public:
     Pointer();
@@ -17,7 +25,18 @@ public:
     Pointer &operator=(const Pointer &);
     Pointer &operator=(Pointer &&);
 
-    void *get() const { return 0; }
+    /**
+     * Returns current address of the block or nullptr if pointer doesn't refer to any
+     */
+    void *get() const { return _slot == nullptr ? nullptr : *_slot; }
+
+private:
+    friend class Simple;
+
+    explicit Pointer(void **slot) : _slot(slot) {}
+
+    // Slot in the descriptors table, nullptr for empty pointer
+    void **_slot;
 };
 
 } // namespace Allocator
@@ -0,0 +1,144 @@
+#ifndef AFINA_ALLOCATOR_RELOCATABLE_H
+#define AFINA_ALLOCATOR_RELOCATABLE_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * # Position independent allocator
+ * The same handle idea as Simple has, but the whole allocator state lives inside the managed area and refers to
+ * everything by offsets from the area beginning. Area could be mapped at any address, by another process as well,
+ * and Attach() picks the state up as it was. Blocks are referred by handles, indices in the descriptors table,
+ * which stay valid while blocks move during defragmentation.
+ *
+ * Memory layout: allocator header at the beginning of the area, then blocks placed one after another, each one
+ * starts with a header. Descriptors table grows from the end of the area towards blocks, each descriptor holds
+ * offset of some block data. Free blocks are kept in lists by size, exact fit is taken first, then never used
+ * space, then larger block split. Free blocks are never merged, defrag() moves used blocks to the beginning of
+ * the area and turns all free memory into never used one.
+ *
+ * Allocator doesn't synchronize anything, callers have to.
+ */
+class Relocatable {
+public:
+    // Zero handle refers to nothing
+    typedef uint32_t Handle;
+
+    /**
+     * Formats the area and places allocator at its beginning. Returns nullptr if area is too small
+     */
+    static Relocatable *Create(void *base, std::size_t size);
+
+    /**
+     * Returns allocator created in the area before, possibly at different address. Returns nullptr if there is no
+     * allocator of the same size and version
+     */
+    static Relocatable *Attach(void *base, std::size_t size);
+
+    Relocatable(const Relocatable &) = delete;
+    Relocatable &operator=(const Relocatable &) = delete;
+
+    /**
+     * Allocates block of at least N bytes, returns zero handle if there is no space
+     */
+    Handle alloc(std::size_t N);
+
+    /**
+     * Releases block, zero handle is ignored. Throws AllocError of type InvalidFree if handle doesn't refer to
+     * allocated block
+     */
+    void free(Handle h);
+
+    /**
+     * Returns current address of the block, nullptr for zero handle. Handle isn't validated
+     */
+    void *get(Handle h) const {
+        return h == 0 ? nullptr : const_cast<char *>(_Base()) + *_Descriptor(h);
+    }
+
+    /**
+     * Returns usable size of the allocated block
+     */
+    std::size_t size(Handle h) const;
+
+    /**
+     * Moves all used blocks to the beginning of the area, so all free memory becomes never used space at the end.
+     * Handles remain valid, addresses don't
+     */
+    void defrag();
+
+    /**
+     * Bytes in the blocks released and not reused yet, could be given back by defrag()
+     */
+    std::size_t free_bytes() const { return _free_bytes; }
+
+    /**
+     * Bytes never used since last defrag(), available without defragmentation
+     */
+    std::size_t unused_bytes() const;
+
+    /**
+     * Bytes in allocated blocks, including headers
+     */
+    std::size_t used_bytes() const { return _used_bytes; }
+
+private:
+    struct block;
+
+    // Block data sizes are multiple of that, up to kSmall bytes every size has own free list
+    static const std::size_t kAlign = 16;
+    static const std::size_t kSmall = 4096;
+    static const std::size_t kLists = kSmall / kAlign + 1;
+
+    Relocatable(std::size_t size);
+
+    const char *_Base() const { return reinterpret_cast<const char *>(this); }
+    char *_Base() { return reinterpret_cast<char *>(this); }
+
+    const uint64_t *_Descriptor(Handle h) const {
+        return reinterpret_cast<const uint64_t *>(_Base() + _size) - h;
+    }
+    uint64_t *_Descriptor(Handle h) { return reinterpret_cast<uint64_t *>(_Base() + _size) - h; }
+
+    block *_Block(uint64_t offset) { return reinterpret_cast<block *>(_Base() + offset); }
+
+    // Returns block of at least size bytes, 0 if there is none
+    uint64_t _AllocBlock(std::size_t size);
+
+    // Puts free block into its list
+    void _Release(uint64_t offset);
+
+    // Takes free block of exactly the list size, 0 if there is none
+    uint64_t _Take(std::size_t list);
+
+    // Returns free descriptor, table grows if needed. Returns 0 if there is no space
+    Handle _AllocHandle();
+
+    // Beginning of the descriptors table
+    uint64_t _TableBegin() const { return _size - _handles * sizeof(uint64_t); }
+
+    uint64_t _magic;
+    uint64_t _size;
+
+    // Offset of the first block and end of the last one
+    uint64_t _blocks_begin;
+    uint64_t _blocks_end;
+
+    // Descriptors in the table, free ones form the list
+    uint64_t _handles;
+    Handle _free_handle;
+
+    uint64_t _free_bytes;
+    uint64_t _used_bytes;
+
+    // Heads of free block lists, last one holds blocks larger than kSmall
+    uint64_t _free_lists[kLists];
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_RELOCATABLE_H
@@ -18,44 +18,92 @@ class Pointer;
  * Allocator instance doesn't take ownership of wrapped memmory and do not delete it
  * on destruction. So caller must take care of resource cleaup after allocator stop
  * being needs
+ *
+ * Memory layout: blocks are placed one after another from the beginning of the area,
+ * each one starts with a header. Descriptors table grows from the end of the area towards
+ * blocks, each descriptor holds address of some block data. Pointer refers to the descriptor,
+ * so blocks could be moved without invalidating pointers
+ *
+ * See StlAllocator.h to use it with standard containers
  */
-// TODO: Implements interface to allow usage as C++ allocators
 class Simple {
 public:
     Simple(void *base, const size_t size);
 
     /**
-     * TODO: semantics
+     * Allocates block of at least N bytes. Doesn't defragment memory by itself,
+     * throws AllocError of type NoMemory if there is no free block large enough
+     *
      * @param N size_t
      */
     Pointer alloc(size_t N);
 
     /**
-     * TODO: semantics
+     * Changes size of the block to N bytes preserving its content (up to the lesser
+     * of old and new sizes). Block grows in place if free space follows it, otherwise
+     * it gets moved, but pointer remains valid. Empty pointer gets new block allocated.
+     * Throws AllocError of type NoMemory if there is no space for the new size
+     *
      * @param p Pointer
      * @param N size_t
      */
     void realloc(Pointer &p, size_t N);
 
     /**
-     * TODO: semantics
+     * Releases block referred by the pointer, pointer becomes empty. Does nothing for
+     * empty pointer. Throws AllocError of type InvalidFree if pointer doesn't belong to
+     * this allocator or refers to the block freed already
+     *
      * @param p Pointer
      */
     void free(Pointer &p);
 
     /**
-     * TODO: semantics
+     * Moves all used blocks to the beginning of the area, so that all free memory forms
+     * single continuous block at the end. All pointers remain valid
      */
     void defrag();
 
     /**
-     * TODO: semantics
+     * Returns human readable description of the allocator state: total, used and free
+     * bytes followed by the list of blocks
      */
     std::string dump() const;
 
 private:
-    void *_base;
+    struct block;
+
+    // Returns free descriptor, table grows if needed. Returns nullptr if there is no space
+    void **_AllocSlot();
+
+    // Returns free block of at least size bytes, splitting bigger one if needed. nullptr if there is no such block
+    block *_AllocBlock(size_t size);
+
+    // Splits tail of the block off if it's big enough to hold a separate one
+    void _Split(block *b, size_t size);
+
+    // Merges free blocks following the given one into it
+    void _Merge(block *b);
+
+    // Returns block of the descriptor, throws InvalidFree if descriptor is not valid
+    block *_Block(void **slot) const;
+
+    // Releases block, merges it with following free ones and shrinks area if block is the last one
+    void _FreeBlock(block *b);
+
+    // Returns descriptor back, shrinks table if possible
+    void _FreeSlot(void **slot);
+
+    // Beginning of the managed area, aligned
+    char *_base;
     const size_t _base_len;
+
+    // End of the last block
+    char *_blocks_end;
+
+    // Descriptors table, _slots_count entries just before the end of the area
+    void **_slots_end;
+    size_t _slots_count;
 };
 
 } // namespace Allocator
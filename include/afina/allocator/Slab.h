@@ -0,0 +1,199 @@
+#ifndef AFINA_ALLOCATOR_SLAB_H
+#define AFINA_ALLOCATOR_SLAB_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * # Slab allocator
+ * Memory area of the fixed size gets split into pages of equal size. Each page belongs to a single size class
+ * and is cut into chunks of that class. Class sizes grow geometrically (by factor 1.25 by default), so no more
+ * than ~20% of the chunk is wasted and external fragmentation is bounded by the page size.
+ *
+ * Every page keeps its own list of free chunks; class keeps list of pages having free chunks. Once all chunks
+ * of some page get free, the page could be reassigned to another class: class keeps at most one empty page
+ * for itself and returns the rest to the common pool, and when the pool is exhausted empty pages get taken
+ * away from other classes.
+ *
+ * Allocator owns the area, pages get backed by physical memory on the first touch only. Area could be backed by
+ * 2MB huge pages to reduce TLB misses: explicit hugetlb pages are tried first, then transparent huge pages get
+ * advised, and ordinary pages are used if neither is available. Not threadsafe
+ */
+class Slab {
+public:
+    static const unsigned kNoClass = ~0u;
+
+    /**
+     * Per class statistics
+     */
+    struct Stats {
+        // Size of the chunk
+        std::size_t chunk_size = 0;
+
+        // Number of chunks per page
+        std::size_t per_page = 0;
+
+        // Pages assigned to the class
+        std::size_t pages = 0;
+
+        // Chunks allocated and free in pages of the class
+        std::size_t used = 0;
+        std::size_t free = 0;
+
+        // Number of successful allocations
+        uint64_t allocs = 0;
+
+        // Number of allocations failed due to memory limit, usually followed by evictions
+        uint64_t fails = 0;
+
+        // Number of pages taken away from other classes
+        uint64_t reassigned = 0;
+    };
+
+    /**
+     * @param max_size bytes available to the allocator, rounded down to whole pages
+     * @param page_size size of the page, also size of the largest class
+     * @param min_chunk size of the smallest class
+     * @param factor ratio between sizes of adjacent classes
+     * @param huge_pages back the area by huge pages if possible
+     */
+    Slab(std::size_t max_size, std::size_t page_size = 1 << 20, std::size_t min_chunk = 48, double factor = 1.25,
+         bool huge_pages = false);
+    Slab(const Slab &) = delete;
+    ~Slab();
+
+    /**
+     * Returns chunk of at least size bytes or nullptr if size is larger than page or memory limit is reached
+     */
+    void *alloc(std::size_t size);
+
+    /**
+     * Returns chunk back, nullptr is ignored. Throws AllocError of type InvalidFree if pointer doesn't belong to
+     * the area
+     */
+    void free(void *p);
+
+    /**
+     * Returns class suitable for the given size, kNoClass if size is larger than page
+     */
+    unsigned class_of(std::size_t size) const;
+
+    /**
+     * Returns true if pointer belongs to the area
+     */
+    bool owns(const void *p) const {
+        const char *chunk = static_cast<const char *>(p);
+        return chunk >= _base && chunk < _base + _pages.size() * _page_size;
+    }
+
+    /**
+     * Returns class of the allocated chunk
+     */
+    unsigned chunk_class(const void *p) const {
+        return _pages[(static_cast<const char *>(p) - _base) / _page_size].cls;
+    }
+
+    /**
+     * Returns number of usable bytes in the allocated chunk
+     */
+    std::size_t usable_size(const void *p) const { return _classes[chunk_class(p)].size; }
+
+    /**
+     * Returns size of chunks of the given class
+     */
+    std::size_t chunk_size(unsigned cls) const { return _classes[cls].size; }
+
+    /**
+     * Returns number of size classes
+     */
+    unsigned classes() const { return static_cast<unsigned>(_classes.size()); }
+
+    /**
+     * Returns statistics of the given class
+     */
+    Stats stats(unsigned cls) const;
+
+    /**
+     * Returns size of the page
+     */
+    std::size_t page_size() const { return _page_size; }
+
+    /**
+     * Returns size of memory pages actually backing the area
+     */
+    std::size_t memory_page_size() const { return _memory_page_size; }
+
+    /**
+     * Returns total number of pages and number of pages not assigned to any class
+     */
+    std::size_t pages() const { return _pages.size(); }
+    std::size_t free_pages() const { return _free_pages.size() + (_pages.size() - _pages_touched); }
+
+private:
+    struct page {
+        // Owner class, kNoClass for page in the common pool
+        unsigned cls = kNoClass;
+
+        // Number of allocated chunks
+        std::size_t used = 0;
+
+        // Number of chunks ever cut from the page, the rest was never touched
+        std::size_t carved = 0;
+
+        // Free chunks list, next chunk address is stored in the chunk itself
+        void *free_list = nullptr;
+
+        // Position in the list of class pages having free chunks
+        page *prev = nullptr;
+        page *next = nullptr;
+    };
+
+    struct size_class {
+        std::size_t size;
+        std::size_t per_page;
+
+        // Pages having free chunks
+        page *partial = nullptr;
+
+        // Completely free page kept for the class
+        page *empty = nullptr;
+
+        Stats stats;
+    };
+
+    // Returns page for the class from the common pool or from another class, nullptr if nothing is available
+    page *_TakePage(unsigned cls);
+
+    // Gives page back to the common pool
+    void _ReleasePage(page *p);
+
+    void _Link(size_class &c, page *p);
+    void _Unlink(size_class &c, page *p);
+
+    char *_PageBase(const page *p) const { return _base + (p - _pages.data()) * _page_size; }
+
+    // Mapped area, its length and size of memory pages backing it
+    char *_base;
+    std::size_t _mapped;
+    std::size_t _memory_page_size;
+    std::size_t _page_size;
+
+    std::vector<page> _pages;
+    std::vector<size_class> _classes;
+
+    // Class of small sizes, indexed by size in words
+    std::vector<unsigned> _small_classes;
+
+    // Pages returned to the common pool; pages starting from _pages_touched were never used
+    std::vector<page *> _free_pages;
+    std::size_t _pages_touched;
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_SLAB_H
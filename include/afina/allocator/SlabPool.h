@@ -0,0 +1,116 @@
+#ifndef AFINA_ALLOCATOR_SLAB_POOL_H
+#define AFINA_ALLOCATOR_SLAB_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <afina/allocator/Slab.h>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * # Threadsafe slab allocator
+ * Slab shared between threads. Every thread keeps small cache of free chunks per size class in front of it, so
+ * most allocations and frees touch thread local data only. Empty cache gets refilled by the batch of chunks,
+ * overflowed one gives half of its chunks back by the single batch as well.
+ *
+ * Batches given back are pushed onto the lock free per class "remote" lists and refills look there first, so
+ * chunks allocated on one thread and freed on another flow back to allocating threads without the pool lock.
+ * Slab itself is locked only when remote lists are empty, and all of them get drained into slab before the
+ * pool reports out of memory, so cached chunks don't prevent page reassignment.
+ *
+ * Chunks larger than the cache limit bypass caches. Pool must outlive threads using it
+ */
+class SlabPool {
+public:
+    /**
+     * See Slab for parameters meaning
+     */
+    SlabPool(std::size_t max_size, std::size_t page_size = 1 << 20, std::size_t min_chunk = 48,
+             double factor = 1.25, bool huge_pages = false);
+    SlabPool(const SlabPool &) = delete;
+    ~SlabPool();
+
+    /**
+     * Returns chunk of at least size bytes or nullptr if size is larger than page or memory limit is reached
+     */
+    void *alloc(std::size_t size);
+
+    /**
+     * Returns chunk back, could be called from any thread. nullptr is ignored
+     */
+    void free(void *p);
+
+    /**
+     * Gives all chunks cached by the calling thread back to the pool
+     */
+    void flush();
+
+    /**
+     * See Slab.h
+     */
+    unsigned class_of(std::size_t size) const { return _slab.class_of(size); }
+    std::size_t usable_size(const void *p) const { return _slab.usable_size(p); }
+    unsigned classes() const { return _slab.classes(); }
+    std::size_t page_size() const { return _slab.page_size(); }
+    std::size_t memory_page_size() const { return _slab.memory_page_size(); }
+
+    /**
+     * Returns statistics of the given class, chunks cached by threads are accounted as used
+     */
+    Slab::Stats stats(unsigned cls) const;
+
+private:
+    // Thread local cache of the single class, chunks are linked through their first word
+    struct bin {
+        void *head = nullptr;
+        std::size_t count = 0;
+    };
+
+    // Thread local caches of all classes
+    struct cache {
+        std::vector<bin> bins;
+    };
+
+    // Caches of the thread in all pools, flushed on thread exit
+    struct thread_caches;
+
+    // Returns cache of the calling thread, creates new one if needed
+    cache *_Cache();
+
+    // Allocates chunk of the class when thread cache is empty
+    void *_Refill(bin &b, unsigned cls);
+
+    // Pushes chain of chunks onto the remote list of the class
+    void _PushRemote(unsigned cls, void *head, void *tail);
+
+    // Returns all chunks of remote lists back to slab, must be called with the lock held
+    void _DrainRemote();
+
+    // Gives all chunks of the cache back
+    void _Flush(cache *c);
+
+    // Pool identifier, never reused
+    const uint64_t _id;
+
+    // Maximum number of chunks thread could cache per class, 0 if class isn't cached
+    std::vector<std::size_t> _limits;
+
+    // Remote lists heads
+    std::unique_ptr<std::atomic<void *>[]> _remote;
+
+    // Protects slab and list of caches
+    mutable std::mutex _mutex;
+    Slab _slab;
+    std::vector<std::unique_ptr<cache>> _caches;
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_SLAB_POOL_H
@@ -0,0 +1,102 @@
+#ifndef AFINA_ALLOCATOR_STL_ALLOCATOR_H
+#define AFINA_ALLOCATOR_STL_ALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+#include <afina/allocator/Error.h>
+#include <afina/allocator/Pointer.h>
+#include <afina/allocator/Simple.h>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * Describes how to get raw memory out of the arena. Default one fits allocators returning nullptr once
+ * they are out of memory, such as Slab and SlabPool
+ */
+template <typename Arena> struct ArenaTraits {
+    static void *alloc(Arena &arena, std::size_t size) { return arena.alloc(size); }
+    static void free(Arena &arena, void *p) { arena.free(p); }
+};
+
+/**
+ * Simple hands out movable blocks, so block keeps its Pointer in front of the data to free it later. Blocks
+ * must not be moved while used by containers, that is defrag() must not be called
+ */
+template <> struct ArenaTraits<Simple> {
+    static const std::size_t kHeader = alignof(std::max_align_t);
+    static_assert(sizeof(Pointer) <= kHeader, "Pointer doesn't fit block header");
+
+    static void *alloc(Simple &arena, std::size_t size) {
+        try {
+            Pointer p = arena.alloc(size + kHeader);
+            char *data = static_cast<char *>(p.get());
+            new (data) Pointer(p);
+            return data + kHeader;
+        } catch (AllocError &) {
+            return nullptr;
+        }
+    }
+
+    static void free(Simple &arena, void *p) {
+        Pointer *handle = reinterpret_cast<Pointer *>(static_cast<char *>(p) - kHeader);
+        Pointer copy(*handle);
+        handle->~Pointer();
+        arena.free(copy);
+    }
+};
+
+/**
+ * # Standard allocator adaptor
+ * Lets STL containers and strings draw memory from the Afina allocator, so that memory is bounded by the arena
+ * size. Throws std::bad_alloc once arena is exhausted. Adaptor doesn't own the arena, copies and rebound copies
+ * refer to the same one; allocators are equal if they share the arena
+ */
+template <typename T, typename Arena> class StlAllocator {
+public:
+    using value_type = T;
+
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    explicit StlAllocator(Arena &arena) noexcept : _arena(&arena) {}
+
+    template <typename U> StlAllocator(const StlAllocator<U, Arena> &other) noexcept : _arena(other.arena()) {}
+
+    T *allocate(std::size_t n) {
+        if (n > std::size_t(-1) / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+
+        void *p = ArenaTraits<Arena>::alloc(*_arena, n * sizeof(T));
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T *>(p);
+    }
+
+    void deallocate(T *p, std::size_t) noexcept { ArenaTraits<Arena>::free(*_arena, p); }
+
+    Arena *arena() const noexcept { return _arena; }
+
+private:
+    Arena *_arena;
+};
+
+template <typename T, typename U, typename Arena>
+bool operator==(const StlAllocator<T, Arena> &a, const StlAllocator<U, Arena> &b) noexcept {
+    return a.arena() == b.arena();
+}
+
+template <typename T, typename U, typename Arena>
+bool operator!=(const StlAllocator<T, Arena> &a, const StlAllocator<U, Arena> &b) noexcept {
+    return a.arena() != b.arena();
+}
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_STL_ALLOCATOR_H
@@ -0,0 +1,127 @@
+#ifndef AFINA_COROUTINE_CHANNEL_H
+#define AFINA_COROUTINE_CHANNEL_H
+
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <afina/coroutine/Sync.h>
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * # Bounded multi-producer multi-consumer channel
+ * Values are passed in FIFO order through the ring buffer of fixed capacity. Sender is suspended while
+ * channel is full, receiver while it is empty. Routines are parked, ordinary threads are blocked.
+ *
+ * Once channel gets closed all suspended senders and receivers are resumed, senders fail immediately,
+ * receivers get values left in the buffer and fail after that
+ */
+template <typename T> class Channel {
+public:
+    explicit Channel(std::size_t capacity) : _buffer(capacity), _head(0), _size(0), _closed(false) {
+        if (capacity == 0) {
+            throw std::invalid_argument("Channel capacity must be positive");
+        }
+    }
+    Channel(const Channel &) = delete;
+
+    /**
+     * Puts value into the channel, waits for free space if needed. Returns false if channel is closed
+     */
+    bool send(T value) {
+        std::unique_lock<std::mutex> lock(_guard);
+        while (_size == _buffer.size() && !_closed) {
+            _senders.wait(lock);
+        }
+        return _Push(std::move(value));
+    }
+
+    /**
+     * Same as send but never waits, returns false if channel is full or closed
+     */
+    bool try_send(T value) {
+        std::lock_guard<std::mutex> lock(_guard);
+        if (_size == _buffer.size()) {
+            return false;
+        }
+        return _Push(std::move(value));
+    }
+
+    /**
+     * Takes value out of the channel, waits for one if needed. Returns false if channel is closed and empty
+     */
+    bool recv(T &value) {
+        std::unique_lock<std::mutex> lock(_guard);
+        while (_size == 0 && !_closed) {
+            _receivers.wait(lock);
+        }
+        return _Pop(value);
+    }
+
+    /**
+     * Same as recv but never waits, returns false if channel is empty
+     */
+    bool try_recv(T &value) {
+        std::lock_guard<std::mutex> lock(_guard);
+        return _Pop(value);
+    }
+
+    /**
+     * Prohibits new values, resumes everybody waiting on the channel
+     */
+    void close() {
+        std::lock_guard<std::mutex> lock(_guard);
+        _closed = true;
+        _senders.notify_all();
+        _receivers.notify_all();
+    }
+
+    std::size_t capacity() const { return _buffer.size(); }
+
+private:
+    // Must be called with guard held
+    bool _Push(T &&value) {
+        if (_closed) {
+            return false;
+        }
+
+        _buffer[(_head + _size) % _buffer.size()] = std::move(value);
+        _size++;
+        _receivers.notify_one();
+        return true;
+    }
+
+    // Must be called with guard held
+    bool _Pop(T &value) {
+        if (_size == 0) {
+            return false;
+        }
+
+        value = std::move(_buffer[_head]);
+        _head = (_head + 1) % _buffer.size();
+        _size--;
+        _senders.notify_one();
+        return true;
+    }
+
+    std::mutex _guard;
+
+    // Ring buffer of values, _size of them starting from _head
+    std::vector<T> _buffer;
+    std::size_t _head;
+    std::size_t _size;
+    bool _closed;
+
+    // Suspended senders and receivers
+    WaitQueue _senders;
+    WaitQueue _receivers;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_CHANNEL_H
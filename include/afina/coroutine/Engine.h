@@ -4,9 +4,12 @@
 #include <cstdint>
 #include <iostream>
 #include <map>
+#include <new>
 #include <setjmp.h>
 #include <tuple>
 
+#include <afina/coroutine/StackPool.h>
+
 namespace Afina {
 namespace Coroutine {
 
@@ -28,7 +31,7 @@ private:
         // coroutine stack end address
         char *Hight = nullptr;
 
-        // coroutine stack copy buffer
+        // coroutine stack copy buffer and its capacity, buffer is owned by the engine's StackPool
         std::tuple<char *, uint32_t> Stack = std::make_tuple(nullptr, 0);
 
         // Saved coroutine context (registers)
@@ -59,6 +62,21 @@ private:
      */
     context *idle_ctx;
 
+    /**
+     * Completed routines contexts kept for reuse, linked by context::next
+     */
+    context *free_ctx;
+
+    /**
+     * Number of contexts in the free_ctx list
+     */
+    std::size_t free_ctx_size;
+
+    /**
+     * Buffers to store routines stack in
+     */
+    StackPool stack_pool;
+
 protected:
     /**
      * Save stack of the current coroutine in the given context
@@ -75,10 +93,27 @@ protected:
      */
     // void Enter(context& ctx);
 
+    /**
+     * Returns new context, possibly reused one of completed routines
+     */
+    context *NewContext();
+
+    /**
+     * Returns context of completed routine back to the engine, stack buffer goes back to the pool
+     */
+    void FreeContext(context *ctx);
+
 public:
-    Engine() : StackBottom(0), cur_routine(nullptr), alive(nullptr) {}
+    /**
+     * @param max_stack_bytes limit on memory used to keep stacks of all routines
+     * @param max_cached_stack_bytes limit on memory kept for reuse once routines are done
+     */
+    Engine(std::size_t max_stack_bytes = 256 * 1024 * 1024, std::size_t max_cached_stack_bytes = 16 * 1024 * 1024)
+        : StackBottom(0), cur_routine(nullptr), alive(nullptr), idle_ctx(nullptr), free_ctx(nullptr),
+          free_ctx_size(0), stack_pool(max_stack_bytes, max_cached_stack_bytes) {}
     Engine(Engine &&) = delete;
     Engine(const Engine &) = delete;
+    ~Engine();
 
     /**
      * Gives up current routine execution and let engine to schedule other one. It is not defined when
@@ -116,7 +151,7 @@ public:
 
         // Start routine execution
         void *pc = run(main, std::forward<Ta>(args)...);
-        idle_ctx = new context();
+        idle_ctx = NewContext();
 
         if (setjmp(idle_ctx->Environment) > 0) {
             // Here: correct finish of the coroutine section
@@ -127,13 +162,14 @@ public:
         }
 
         // Shutdown runtime
-        delete idle_ctx;
+        FreeContext(idle_ctx);
+        idle_ctx = nullptr;
         this->StackBottom = 0;
     }
 
     /**
      * Register new coroutine. It won't receive control until scheduled explicitely or implicitly. In case of some
-     * errors function returns -1
+     * errors, such as stack memory limit reached, function returns nullptr
      */
     template <typename... Ta> void *run(void (*func)(Ta...), Ta &&... args) {
         if (this->StackBottom == 0) {
@@ -142,7 +178,7 @@ public:
         }
 
         // New coroutine context that carries around all information enough to call function
-        context *pc = new context();
+        context *pc = NewContext();
 
         // Store current state right here, i.e just before enter new coroutine, later, once it gets scheduled
         // execution starts here. Note that we have to acquire stack of the current function call to ensure
@@ -173,8 +209,7 @@ public:
             // current coroutine finished, and the pointer is not relevant now
             cur_routine = nullptr;
             pc->prev = pc->next = nullptr;
-            delete std::get<0>(pc->Stack);
-            delete pc;
+            FreeContext(pc);
 
             // We cannot return here, as this function "returned" once already, so here we must select some other
             // coroutine to run. As current coroutine is completed and can't be scheduled anymore, it is safe to
@@ -184,8 +219,13 @@ public:
 
         // setjmp remembers position from which routine could starts execution, but to make it correctly
         // it is neccessary to save arguments, pointer to body function, pointer to context, e.t.c - i.e
-        // save stack.
-        Store(*pc);
+        // save stack. Store fails only if stack memory limit is reached
+        try {
+            Store(*pc);
+        } catch (std::bad_alloc &) {
+            FreeContext(pc);
+            return nullptr;
+        }
 
         // Add routine as alive double-linked list
         pc->next = alive;
@@ -0,0 +1,268 @@
+#ifndef AFINA_COROUTINE_SCHEDULER_H
+#define AFINA_COROUTINE_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <afina/coroutine/StackPool.h>
+#include <afina/coroutine/TimerWheel.h>
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * # M:N coroutine scheduler
+ * Runs coroutines on the fixed set of OS threads, one per core by default. Each thread has private run queue,
+ * once it gets empty thread steals half of the runnable routines from the other one.
+ *
+ * Unlike Engine, which copies routine stack in/out of the single thread stack, every routine here has its own
+ * stack from the StackPool. Stack never moves, so pointers into it stay valid and routine could continue on any
+ * thread after it was suspended: yield puts it back into the queue where it could be stolen, park/wake lets it
+ * block and get resumed on the thread of whoever woke it up.
+ *
+ * Scheduler owns epoll instance and timer wheel with millisecond ticks. Idle thread, or a busy one every few
+ * switches, polls epoll and advances the wheel in the same loop iteration, so routine could sleep or wait for
+ * IO with deadline without holding OS thread or issuing syscall per timer.
+ *
+ * Note that thread_local variables must not be cached by the routine code across suspension points
+ */
+class Scheduler final {
+public:
+    /**
+     * Scheduler counters
+     */
+    struct Stats {
+        // Routines registered by spawn
+        uint64_t spawned = 0;
+
+        // Routines finished execution
+        uint64_t completed = 0;
+
+        // Number of times control was passed to some routine
+        uint64_t switches = 0;
+
+        // Number of routines moved from one thread queue to another
+        uint64_t stolen = 0;
+    };
+
+    /**
+     * @param threads number of OS threads to run, 0 means one per core
+     * @param stack_size size of each routine stack, including guard page
+     * @param max_stack_bytes limit on memory used by all routine stacks
+     * @param pin_threads bind each thread to its own core
+     */
+    Scheduler(std::size_t threads = 0, std::size_t stack_size = 64 * 1024,
+              std::size_t max_stack_bytes = 256 * 1024 * 1024, bool pin_threads = false);
+    ~Scheduler();
+
+    Scheduler(Scheduler &&) = delete;
+    Scheduler(const Scheduler &) = delete;
+
+    /**
+     * Starts OS threads. Routines spawned before start get executed once threads are running
+     */
+    void Start();
+
+    /**
+     * Signal threads to stop once there are no more alive routines. Routines are still could be spawned
+     * while some of them alive
+     */
+    void Stop();
+
+    /**
+     * Blocks calling thread until all routines done and threads are stopped
+     */
+    void Join();
+
+    /**
+     * Register new routine, it gets control on some of the threads later. Returns false if routine couldn't be
+     * created, for example because of stack memory limit
+     */
+    template <typename F, typename... Ta> bool spawn(F &&func, Ta &&... args) {
+        return Spawn(std::bind(std::forward<F>(func), std::forward<Ta>(args)...));
+    }
+
+    /**
+     * See spawn
+     */
+    bool Spawn(std::function<void()> body);
+
+    /**
+     * Returns counters of the scheduler
+     */
+    Stats GetStats() const;
+
+    /**
+     * Returns number of OS threads running routines
+     */
+    std::size_t Threads() const { return _workers.size(); }
+
+    /**
+     * Returns routine that is running in the calling thread or nullptr if caller isn't a routine
+     */
+    static void *current();
+
+    /**
+     * Gives up current routine execution, it is placed back into the run queue. If caller is not a routine
+     * then OS thread yields
+     */
+    static void yield();
+
+    /**
+     * Suspend current routine until some one calls wake for it. Caller must hold given lock, it gets released
+     * once routine is suspended, and acquired back before method returns. Waker must hold the same lock, that
+     * way wakeup couldn't be lost and routine couldn't be resumed before it actually suspended.
+     *
+     * Routine could be resumed on a different OS thread
+     */
+    static void park(std::unique_lock<std::mutex> &lock);
+
+    /**
+     * Makes parked routine runnable again. Caller must hold the lock routine passed to park
+     */
+    static void wake(void *routine);
+
+    /**
+     * Suspends current routine for the given time. If caller is not a routine then OS thread sleeps
+     */
+    static void sleep(std::chrono::milliseconds duration);
+
+    /**
+     * Suspends current routine until file descriptor gets any of the given epoll events, or timeout expires.
+     * Negative timeout means wait forever. Returns events happened or 0 on timeout.
+     *
+     * Only one routine at a time could wait on the same descriptor. If caller is not a routine then OS thread
+     * blocks in poll
+     */
+    static uint32_t wait_io(int fd, uint32_t events, std::chrono::milliseconds timeout = std::chrono::milliseconds(-1));
+
+private:
+    struct task;
+    struct worker;
+    struct waiter;
+
+    /**
+     * Method executing by each OS thread
+     */
+    void OnRun(worker *w);
+
+    /**
+     * Pass control to the given routine and process its state once it gives control back
+     */
+    void Switch(worker *w, task *t);
+
+    /**
+     * Put runnable routine into the queue, prefers queue of the calling thread
+     */
+    void Enqueue(task *t);
+
+    /**
+     * Take routine from the thread own queue
+     */
+    task *Pop(worker *w);
+
+    /**
+     * Take half of the routines from some other thread queue, returns one of them
+     */
+    task *Steal(worker *w);
+
+    /**
+     * Sleep until new work arrives
+     */
+    void Idle(worker *w);
+
+    /**
+     * Returns true if some thread queue has runnable routines
+     */
+    bool HasWork();
+
+    /**
+     * Wakeup one of the idle threads, if any
+     */
+    void Notify();
+
+    /**
+     * Wait for IO events up to timeout, then expire timers. Resumes routines whose waits are over
+     */
+    void Poll(int timeout);
+
+    /**
+     * Suspends current routine until timer or IO event fires, must be called with _timers_mutex held
+     */
+    uint32_t Wait(std::unique_lock<std::mutex> &lock, waiter &w, int64_t timeout);
+
+    /**
+     * Current time in the timer wheel ticks
+     */
+    uint64_t Now() const;
+
+    /**
+     * Free routine resources
+     */
+    void Destroy(task *t);
+
+    // Entry point of the routine stack, exception escaping the routine terminates the process
+    static void Trampoline();
+
+    // Worker of the calling thread, never inlined so that routine re-reads it after migration
+    static worker *CurrentWorker();
+
+    // Size of each routine stack
+    const std::size_t _stack_size;
+
+    // Should threads be bound to cores
+    const bool _pin_threads;
+
+    // OS threads running routines
+    std::vector<std::unique_ptr<worker>> _workers;
+
+    // Shared pool of routine stacks
+    std::mutex _stack_mutex;
+    StackPool _stack_pool;
+
+    // Threads that have nothing to do sleep here
+    std::mutex _idle_mutex;
+    std::condition_variable _idle_condition;
+    std::atomic<std::size_t> _sleeping;
+
+    // Queue for routines enqueued from outside of the scheduler threads
+    std::atomic<std::size_t> _next_queue;
+
+    // Number of routines spawned but not completed yet
+    std::atomic<std::size_t> _alive;
+
+    // Only one thread polls at a time, rest sleep on the condition variable
+    std::mutex _poll_mutex;
+    std::atomic<bool> _polling;
+
+    // Epoll to wait for IO, event fd in it wakes up polling thread
+    int _epoll_fd;
+    int _event_fd;
+
+    // Timers and IO waiters, indexed by file descriptor
+    std::mutex _timers_mutex;
+    TimerWheel _timers;
+    std::vector<waiter *> _io_waiters;
+    uint32_t _io_generation;
+
+    // Point timer ticks are counted from
+    const std::chrono::steady_clock::time_point _epoch;
+
+    // Set once Stop called
+    std::atomic<bool> _stopping;
+    bool _started;
+
+    std::atomic<uint64_t> _spawned;
+    std::atomic<uint64_t> _completed;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_SCHEDULER_H
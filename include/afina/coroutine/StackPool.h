@@ -0,0 +1,98 @@
+#ifndef AFINA_COROUTINE_STACK_POOL_H
+#define AFINA_COROUTINE_STACK_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * # Pool of coroutine stack buffers
+ * Engine copies stack of the suspended routine into the separate buffer, once routine is done buffer is
+ * not needed anymore. Instead of returning buffers back to the heap pool keeps them in the size classes
+ * (powers of two, starting from the page size) and gives them out for the next routines.
+ *
+ * Buffers are mmap'ed, so memory is commited lazily on the first touch. Once buffer returns back to the pool
+ * its pages are marked by MADV_FREE: kernel could take them back under memory pressure but while it doesn't
+ * reuse costs nothing.
+ *
+ * Pool limits both the total amount of stack memory (in use + cached) and the amount of memory kept in
+ * the cache. Not threadsafe, same as Engine
+ */
+class StackPool {
+public:
+    /**
+     * Process wide counters, aggregated over all pools
+     */
+    struct Stats {
+        // Number of buffers mapped from the OS
+        uint64_t allocated = 0;
+
+        // Number of buffers given out from the cache
+        uint64_t reused = 0;
+
+        // Number of buffers unmapped back to the OS
+        uint64_t released = 0;
+
+        // Number of acquire requests failed due to the memory limit
+        uint64_t failed = 0;
+
+        // Bytes in buffers given out to the routines
+        uint64_t in_use_bytes = 0;
+
+        // Bytes in buffers waiting in the cache for reuse
+        uint64_t cached_bytes = 0;
+    };
+
+    /**
+     * @param max_bytes limit on the total stack memory, in use and cached
+     * @param max_cached_bytes limit on the memory kept in the cache for reuse
+     */
+    StackPool(std::size_t max_bytes = 256 * 1024 * 1024, std::size_t max_cached_bytes = 16 * 1024 * 1024);
+    ~StackPool();
+
+    StackPool(StackPool &&) = delete;
+    StackPool(const StackPool &) = delete;
+
+    /**
+     * Returns buffer of at least size bytes, real size of the buffer written into capacity. In case
+     * if memory limit is reached method returns nullptr
+     */
+    char *Acquire(std::size_t size, uint32_t &capacity);
+
+    /**
+     * Returns buffer back to the pool, buffer must be acquired from the same pool before
+     */
+    void Release(char *buffer, uint32_t capacity);
+
+    /**
+     * Returns snapshot of the counters aggregated over all pools in the process
+     */
+    static Stats GlobalStats();
+
+private:
+    // Index of the smallest size class enough to fit size bytes
+    static std::size_t _SizeClass(std::size_t size);
+
+    // Limit on the total stack memory
+    const std::size_t _max_bytes;
+
+    // Limit on the memory kept in cache
+    const std::size_t _max_cached_bytes;
+
+    // Memory given out to the routines
+    std::size_t _in_use_bytes;
+
+    // Memory kept in the cache
+    std::size_t _cached_bytes;
+
+    // Cached buffers, one list per size class
+    std::vector<std::vector<char *>> _cache;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_STACK_POOL_H
@@ -0,0 +1,124 @@
+#ifndef AFINA_COROUTINE_SYNC_H
+#define AFINA_COROUTINE_SYNC_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * # Queue of suspended waiters
+ * Building block for the primitives below. If waiter is a Scheduler routine then it gets parked, so that
+ * OS thread continues to run other routines. Otherwise calling thread blocks on the private condition variable,
+ * which allows to share primitives between routines and ordinary threads.
+ *
+ * All methods must be called with the same external lock held
+ */
+class WaitQueue {
+public:
+    WaitQueue() : _head(nullptr), _tail(nullptr) {}
+    WaitQueue(const WaitQueue &) = delete;
+
+    /**
+     * Suspends caller until notified, lock is released while suspended
+     */
+    void wait(std::unique_lock<std::mutex> &lock);
+
+    /**
+     * Resumes the oldest waiter, returns false if there is nobody to resume
+     */
+    bool notify_one();
+
+    /**
+     * Resumes all waiters
+     */
+    void notify_all();
+
+    /**
+     * Returns true if there are no waiters
+     */
+    bool empty() const { return _head == nullptr; }
+
+private:
+    struct waiter;
+
+    // Waiters in order of arrival, each lives on the stack of the waiting routine or thread
+    waiter *_head;
+    waiter *_tail;
+};
+
+/**
+ * # Mutex that parks routine instead of blocking thread
+ * Satisfies Lockable requirements so could be used with std::lock_guard and std::unique_lock
+ */
+class Mutex {
+public:
+    Mutex() : _locked(false) {}
+    Mutex(const Mutex &) = delete;
+
+    void lock();
+    bool try_lock();
+    void unlock();
+
+private:
+    std::mutex _guard;
+    bool _locked;
+    WaitQueue _waiters;
+};
+
+/**
+ * # Condition variable to be used along with Coroutine::Mutex
+ */
+class ConditionVariable {
+public:
+    ConditionVariable() {}
+    ConditionVariable(const ConditionVariable &) = delete;
+
+    /**
+     * Atomically releases lock and suspends caller until notified, lock is reacquired before return.
+     * Spurious wakeups are possible, same as for std::condition_variable
+     */
+    void wait(std::unique_lock<Mutex> &lock);
+
+    /**
+     * Same as wait, but loops until predicate holds
+     */
+    template <typename Predicate> void wait(std::unique_lock<Mutex> &lock, Predicate pred) {
+        while (!pred()) {
+            wait(lock);
+        }
+    }
+
+    void notify_one();
+    void notify_all();
+
+private:
+    std::mutex _guard;
+    WaitQueue _waiters;
+};
+
+/**
+ * # Waits for a collection of routines to finish
+ * Counter incremented by add, decremented by done, wait suspends caller until counter drops to zero
+ */
+class WaitGroup {
+public:
+    WaitGroup() : _counter(0) {}
+    WaitGroup(const WaitGroup &) = delete;
+
+    void add(std::size_t n = 1);
+    void done();
+    void wait();
+
+private:
+    std::mutex _guard;
+    std::size_t _counter;
+    WaitQueue _waiters;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_SYNC_H
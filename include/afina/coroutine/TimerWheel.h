@@ -0,0 +1,116 @@
+#ifndef AFINA_COROUTINE_TIMER_WHEEL_H
+#define AFINA_COROUTINE_TIMER_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * # Hierarchical timer wheel
+ * Timers are kept in 4 levels of 64 slots each. Level 0 slot covers single tick, level 1 slot covers 64 ticks
+ * and so on, so the whole wheel spans 64^4 ticks ahead; more distant timers get clamped to that span. Once time
+ * crosses a slot boundary of the upper level, its timers are cascaded down to the lower levels.
+ *
+ * Add and cancel are O(1), timers are intrusive nodes so the wheel never allocates. Not threadsafe
+ */
+class TimerWheel {
+public:
+    /**
+     * Timer node, owned by the caller. Must not be destroyed while added to the wheel
+     */
+    struct timer {
+        // Tick at which timer expires
+        uint64_t expires = 0;
+
+        // Arbitrary user data
+        void *data = nullptr;
+
+        // Position in the slot list, both nullptr while timer isn't in the wheel
+        timer *prev = nullptr;
+        timer *next = nullptr;
+
+        bool active() const { return prev != nullptr; }
+    };
+
+    explicit TimerWheel(uint64_t now = 0);
+    TimerWheel(const TimerWheel &) = delete;
+
+    /**
+     * Adds timer expiring at the given tick. Expired ones fire on the next advance
+     */
+    void Add(timer *t, uint64_t expires);
+
+    /**
+     * Removes timer from the wheel, does nothing if timer is not active
+     */
+    void Cancel(timer *t);
+
+    /**
+     * Moves wheel time forward up to the given tick, all expired timers get removed from wheel and passed to
+     * the callback
+     */
+    template <typename F> void Advance(uint64_t now, F callback) {
+        if (_size == 0 && _now < now) {
+            _now = now;
+            return;
+        }
+
+        while (_now < now) {
+            _now++;
+            _Cascade();
+
+            timer &head = _slots[0][_now & kMask];
+            while (head.next != &head) {
+                timer *t = head.next;
+                _Unlink(t);
+                callback(t);
+            }
+        }
+    }
+
+    /**
+     * Returns number of ticks until the wheel must be advanced next time, at most limit
+     */
+    uint64_t NextExpiration(uint64_t limit) const;
+
+    /**
+     * Returns current wheel time
+     */
+    uint64_t Now() const { return _now; }
+
+    /**
+     * Returns number of active timers
+     */
+    std::size_t Size() const { return _size; }
+
+private:
+    static const unsigned kLevels = 4;
+    static const unsigned kBits = 6;
+    static const uint64_t kSlots = 1 << kBits;
+    static const uint64_t kMask = kSlots - 1;
+
+    // Moves timers of the upper levels down if time crossed their slot boundary
+    void _Cascade();
+
+    // Puts timer into the slot according to its expiration time, which must not be in the past
+    void _Insert(timer *t);
+
+    // Removes timer from its slot list
+    void _Unlink(timer *t);
+
+    // Current time
+    uint64_t _now;
+
+    // Number of timers in the wheel
+    std::size_t _size;
+
+    // Sentinel heads of the circular slot lists
+    timer _slots[kLevels][kSlots];
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_TIMER_WHEEL_H
@@ -1,6 +1,7 @@
 #ifndef AFINA_EXECUTE_COMMAND_H
 #define AFINA_EXECUTE_COMMAND_H
 
+#include <memory>
 #include <string>
 
 namespace Afina {
@@ -21,6 +22,27 @@ public:
     virtual void Execute(Storage &storage, const std::string &args, std::string &out) = 0;
 };
 
+/**
+ * Destroys command allocated either on heap or in the arena, in the latter case memory is released
+ * together with the arena
+ */
+struct CommandDeleter {
+    CommandDeleter(bool in_arena = false) : in_arena(in_arena) {}
+
+    void operator()(Command *command) const {
+        if (in_arena) {
+            command->~Command();
+        } else {
+            delete command;
+        }
+    }
+
+    bool in_arena;
+};
+
+// Owning pointer to the command, see Protocol::Parser::Build
+using CommandPtr = std::unique_ptr<Command, CommandDeleter>;
+
 } // namespace Execute
 } // namespace Afina
 
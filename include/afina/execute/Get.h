@@ -1,9 +1,13 @@
 #ifndef AFINA_EXECUTE_GET_H
 #define AFINA_EXECUTE_GET_H
 
+#include <memory>
 #include <string>
 #include <vector>
 
+#include <afina/allocator/Arena.h>
+#include <afina/allocator/StlAllocator.h>
+
 #include "Command.h"
 
 namespace Afina {
@@ -34,15 +38,34 @@ namespace Execute {
  */
 class Get : public Command {
 public:
-    Get(const std::vector<std::string> &keys) : _keys(keys) {}
+    /**
+     * Keys are copied into the command's own arena
+     */
+    Get(const std::vector<std::string> &keys);
+
+    /**
+     * Keys are copied into the given arena, which must outlive the command. Once arena is warmed up neither
+     * building nor executing the command touches heap
+     */
+    Get(const std::vector<std::string> &keys, Allocator::Arena &arena);
+
     ~Get() {}
 
-    inline const std::vector<std::string> &keys() const { return _keys; }
+    std::vector<std::string> keys() const;
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
 
 private:
-    std::vector<std::string> _keys;
+    template <typename T> using arena_allocator = Allocator::StlAllocator<T, Allocator::Arena>;
+    using key = std::basic_string<char, std::char_traits<char>, arena_allocator<char>>;
+
+    // Copies keys into the arena
+    void _Assign(const std::vector<std::string> &keys);
+
+    // Set only if command was built without arena
+    std::unique_ptr<Allocator::Arena> _own_arena;
+
+    std::vector<key, arena_allocator<key>> _keys;
 };
 
 } // namespace Execute
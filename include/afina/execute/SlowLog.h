@@ -0,0 +1,126 @@
+#ifndef AFINA_EXECUTE_SLOW_LOG_H
+#define AFINA_EXECUTE_SLOW_LOG_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Cheap monotonic clock
+ * Reads time stamp counter where available, that takes few nanoseconds and no system call. Ticks are converted
+ * to nanoseconds using rate calibrated against steady clock on the first use. Modern x86 CPUs have invariant
+ * TSC, on older ones readings are approximate if frequency changes
+ */
+class TscClock {
+public:
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+#endif
+    }
+
+    /**
+     * Returns number of ticks per nanosecond. First call could take few milliseconds, so it is better made on
+     * start rather than while serving
+     */
+    static double ticks_per_ns();
+
+    static uint64_t to_ns(uint64_t ticks) { return static_cast<uint64_t>(ticks / ticks_per_ns()); }
+    static uint64_t from_ns(uint64_t ns) { return static_cast<uint64_t>(ns * ticks_per_ns()); }
+};
+
+/**
+ * # Log of slow commands
+ * Keeps last commands executed longer than threshold in the fixed size ring. Check is a single comparison of
+ * clock ticks, so normal commands pay nothing but two clock readings; only slow ones take the lock to be recorded
+ */
+class SlowLog {
+public:
+    struct Entry {
+        // Sequence number of the entry
+        uint64_t id;
+
+        // Unix time the command finished at
+        int64_t timestamp;
+
+        // Time spent in the command
+        uint64_t elapsed_us;
+
+        std::string command;
+        std::size_t keys;
+
+        // Argument and response sizes
+        std::size_t bytes_in;
+        std::size_t bytes_out;
+
+        // Address of the client
+        std::string client;
+    };
+
+    /**
+     * @param capacity number of entries to keep
+     * @param threshold_us commands slower than that are recorded
+     */
+    explicit SlowLog(std::size_t capacity = 128, uint64_t threshold_us = 10000);
+
+    /**
+     * Changes threshold, commands slower than that are recorded
+     */
+    void SetThreshold(uint64_t threshold_us);
+    uint64_t Threshold() const { return _threshold_us.load(std::memory_order_relaxed); }
+
+    /**
+     * Returns true if command took that many clock ticks should be recorded
+     */
+    bool IsSlow(uint64_t ticks) const { return ticks >= _threshold_ticks.load(std::memory_order_relaxed); }
+
+    /**
+     * Records the command, client is the address captured on accept, see Logging::PeerAddress
+     */
+    void Add(const std::string &command, std::size_t keys, std::size_t bytes_in, std::size_t bytes_out,
+             const char *client, uint64_t ticks);
+
+    /**
+     * Returns entries kept, newest first
+     */
+    std::vector<Entry> Entries() const;
+
+    /**
+     * Returns number of entries ever recorded
+     */
+    uint64_t Total() const;
+
+    /**
+     * Log shared by all network services
+     */
+    static SlowLog &Global();
+
+private:
+    std::atomic<uint64_t> _threshold_us;
+    std::atomic<uint64_t> _threshold_ticks;
+
+    // Entries ring, next one is written at _next_id % capacity
+    mutable std::mutex _mutex;
+    std::vector<Entry> _entries;
+    uint64_t _next_id;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_SLOW_LOG_H
@@ -0,0 +1,29 @@
+#ifndef AFINA_EXECUTE_SNAPSHOT_H
+#define AFINA_EXECUTE_SNAPSHOT_H
+
+#include <string>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Start writing snapshot of the storage
+ * Snapshot is written in background, server replies right away:
+ * OK - snapshot is started
+ * SERVER_ERROR snapshot is in progress - previous one isn't finished yet
+ * SERVER_ERROR snapshots are disabled - server has no snapshot file configured
+ */
+class Snapshot : public Command {
+public:
+    Snapshot() {}
+    ~Snapshot() {}
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_SNAPSHOT_H
@@ -2,17 +2,27 @@
 #define AFINA_EXECUTE_STATS_H
 
 #include <string>
+#include <vector>
 
 #include "Command.h"
 
 namespace Afina {
 namespace Execute {
 
+/**
+ * # Server statistics
+ * Without arguments reports general counters. "stats slowlog" lists commands recorded by the slow log, newest
+ * first, one per line
+ */
 class Stats : public Command {
 public:
     Stats() {}
+    Stats(const std::vector<std::string> &args) : _args(args) {}
     ~Stats() {}
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+private:
+    std::vector<std::string> _args;
 };
 
 } // namespace Execute
@@ -1,6 +1,7 @@
 #ifndef AFINA_LOGGING_CONFIG_H
 #define AFINA_LOGGING_CONFIG_H
 
+#include <cstddef>
 #include <map>
 #include <string>
 #include <vector>
@@ -107,6 +108,19 @@ public:
  */
 class Config {
 public:
+    enum Overflow { DROP, BLOCK };
+
+    /*
+     * Size of per thread ring buffer records are written to, in bytes. Background thread drains rings and writes
+     * records to appenders. If 0, spdlog async queue is used instead
+     */
+    std::size_t ring_size = 64 << 10;
+
+    /*
+     * What to do once ring is full: drop the record and count it or wait until logging thread frees space
+     */
+    Config::Overflow ring_overflow = DROP;
+
     /*
      * Appenders by name
      */
@@ -0,0 +1,92 @@
+#ifndef AFINA_LOGGING_CONTEXT_H
+#define AFINA_LOGGING_CONTEXT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Afina {
+namespace Logging {
+
+/**
+ * Address of the peer connected to the socket as "host:port", or "?" if there is no one. It is captured once,
+ * when connection is accepted: by the time some record is logged socket could be closed or its descriptor
+ * reused. Value is small and doesn't own anything, connection keeps it and tags refer to it
+ */
+class PeerAddress {
+public:
+    explicit PeerAddress(int socket);
+
+    const char *c_str() const { return _text; }
+
+private:
+    // Enough for IPv6 address and port
+    char _text[64];
+};
+
+/**
+ * # Thread local logging context
+ * While the tag is alive every record logged by the thread gets "key=value" attached. Setting a tag is just a
+ * couple of stores: value is neither copied nor formatted, tags get rendered only once some record is actually
+ * emitted, as " {key=value, ...}" suffix of the message.
+ *
+ * Tags must be destroyed in reverse order of creation, that is they should live on the stack. Strings and peer
+ * addresses must outlive tags referring to them, empty strings aren't rendered. Tags above the limit are ignored
+ */
+class ContextTag {
+public:
+    static const std::size_t kMaxTags = 8;
+
+    ContextTag(const char *key, const char *value);
+    ContextTag(const char *key, const std::string &value);
+    ContextTag(const char *key, int64_t value);
+    ContextTag(const char *key, const PeerAddress &value);
+    ContextTag(const char *key, PeerAddress &&value) = delete;
+    ContextTag(const ContextTag &) = delete;
+    ContextTag &operator=(const ContextTag &) = delete;
+    ~ContextTag();
+
+    /**
+     * Replaces tag value
+     */
+    void set(const char *value) {
+        _kind = Kind::CString;
+        _cstring = value;
+    }
+    void set(const std::string &value) {
+        _kind = Kind::String;
+        _string = &value;
+    }
+    void set(int64_t value) {
+        _kind = Kind::Integer;
+        _integer = value;
+    }
+
+    /**
+     * Renders tags of the calling thread into the buffer, returns number of bytes written. Output is truncated
+     * if buffer is too small
+     */
+    static std::size_t Render(char *buffer, std::size_t size);
+
+private:
+    enum class Kind { CString, String, Integer };
+
+    // Appends the tag to the buffer, returns new position
+    char *_Render(char *out, char *end) const;
+
+    void _Push();
+
+    const char *_key;
+    Kind _kind;
+    union {
+        const char *_cstring;
+        const std::string *_string;
+        int64_t _integer;
+    };
+    bool _pushed;
+};
+
+} // namespace Logging
+} // namespace Afina
+
+#endif // AFINA_LOGGING_CONTEXT_H
@@ -0,0 +1,85 @@
+#ifndef AFINA_LOGGING_LOG_H
+#define AFINA_LOGGING_LOG_H
+
+#include <spdlog/logger.h>
+
+/**
+ * # Logging macros
+ * Wrappers over loggers provided by Logging::Service for the hot paths. Calls below AFINA_LOG_LEVEL are removed
+ * by the preprocessor together with their arguments; the rest check logger level with a single relaxed load
+ * before arguments get evaluated, so disabled calls cost nothing but a branch.
+ *
+ * Level values match spdlog::level::level_enum. By default release builds keep info and above, debug builds keep
+ * everything. Could be overridden with -DAFINA_LOG_LEVEL=<value> or AFINA_LOG_LEVEL cmake option
+ */
+#define AFINA_LOG_LEVEL_TRACE 0
+#define AFINA_LOG_LEVEL_DEBUG 1
+#define AFINA_LOG_LEVEL_INFO 2
+#define AFINA_LOG_LEVEL_WARN 3
+#define AFINA_LOG_LEVEL_ERROR 4
+#define AFINA_LOG_LEVEL_CRITICAL 5
+#define AFINA_LOG_LEVEL_OFF 6
+
+#ifndef AFINA_LOG_LEVEL
+#ifdef NDEBUG
+#define AFINA_LOG_LEVEL AFINA_LOG_LEVEL_INFO
+#else
+#define AFINA_LOG_LEVEL AFINA_LOG_LEVEL_TRACE
+#endif
+#endif
+
+/**
+ * True if records of the level are compiled in and enabled for the logger. Use it to guard preparation of
+ * expensive arguments, such as address formatting
+ */
+#define AFINA_LOG_ENABLED(logger, lvl)                                                                                 \
+    (AFINA_LOG_LEVEL_##lvl >= AFINA_LOG_LEVEL &&                                                                       \
+     (logger)->should_log(static_cast<spdlog::level::level_enum>(AFINA_LOG_LEVEL_##lvl)))
+
+/**
+ * Writes record if the level is enabled, arguments are evaluated only in that case
+ */
+#define AFINA_LOG(logger, lvl, ...)                                                                                    \
+    do {                                                                                                               \
+        if (AFINA_LOG_ENABLED(logger, lvl)) {                                                                          \
+            (logger)->log(static_cast<spdlog::level::level_enum>(AFINA_LOG_LEVEL_##lvl), __VA_ARGS__);                 \
+        }                                                                                                              \
+    } while (0)
+
+#if AFINA_LOG_LEVEL <= AFINA_LOG_LEVEL_TRACE
+#define AFINA_TRACE(logger, ...) AFINA_LOG(logger, TRACE, __VA_ARGS__)
+#else
+#define AFINA_TRACE(logger, ...) (void)0
+#endif
+
+#if AFINA_LOG_LEVEL <= AFINA_LOG_LEVEL_DEBUG
+#define AFINA_DEBUG(logger, ...) AFINA_LOG(logger, DEBUG, __VA_ARGS__)
+#else
+#define AFINA_DEBUG(logger, ...) (void)0
+#endif
+
+#if AFINA_LOG_LEVEL <= AFINA_LOG_LEVEL_INFO
+#define AFINA_INFO(logger, ...) AFINA_LOG(logger, INFO, __VA_ARGS__)
+#else
+#define AFINA_INFO(logger, ...) (void)0
+#endif
+
+#if AFINA_LOG_LEVEL <= AFINA_LOG_LEVEL_WARN
+#define AFINA_WARN(logger, ...) AFINA_LOG(logger, WARN, __VA_ARGS__)
+#else
+#define AFINA_WARN(logger, ...) (void)0
+#endif
+
+#if AFINA_LOG_LEVEL <= AFINA_LOG_LEVEL_ERROR
+#define AFINA_ERROR(logger, ...) AFINA_LOG(logger, ERROR, __VA_ARGS__)
+#else
+#define AFINA_ERROR(logger, ...) (void)0
+#endif
+
+#if AFINA_LOG_LEVEL <= AFINA_LOG_LEVEL_CRITICAL
+#define AFINA_CRITICAL(logger, ...) AFINA_LOG(logger, CRITICAL, __VA_ARGS__)
+#else
+#define AFINA_CRITICAL(logger, ...) (void)0
+#endif
+
+#endif // AFINA_LOGGING_LOG_H
@@ -24,9 +24,17 @@ public:
 
     virtual std::shared_ptr<spdlog::logger> select(const std::string &name) noexcept = 0;
 
+    /**
+     * Creates logger with MDC values substituted into the pattern. Per connection or per request tags are cheaper
+     * to attach through the thread context, see Context.h
+     */
     virtual std::unique_ptr<spdlog::logger> create(const std::string &name,
                                                    const std::map<std::string, std::string> &mdc) noexcept = 0;
 
+    /**
+     * Reopens all log files, for example once they were moved away by logrotate. Could be done asynchronously,
+     * so records logged right after the call could still get into old files
+     */
     virtual void reopen_all() = 0;
 };
 
@@ -18,7 +18,7 @@ namespace Network {
 class Server {
 public:
     Server(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl)
-        : pStorage(ps), pLogging(pl) {}
+        : pStorage(ps), pLogging(pl), inheritedSocket(-1) {}
     virtual ~Server() {}
 
     /**
@@ -33,6 +33,8 @@ public:
      * no more connections should be accept, existing connections should stop receive commands,
      * but must wait until currently run commands executed.
      *
+     * Listening socket itself is left intact, it could be served by the next process already.
+     *
      * After existing connections drain each should be closed and once worker has no more connection
      * its thread should be exit
      */
@@ -44,6 +46,17 @@ public:
      */
     virtual void Join() = 0;
 
+    /**
+     * Makes the next Start() accept connections on the socket which is already bound and listening, for example
+     * one received from the previous process, instead of creating a new one. Port is ignored then
+     */
+    void UseListenSocket(int socket) { inheritedSocket = socket; }
+
+    /**
+     * Socket server accepts connections on, valid between Start() and Join()
+     */
+    virtual int ListenSocket() const = 0;
+
 protected:
     /**
      * Instance of backing storeage on which current server should execute
@@ -55,6 +68,11 @@ protected:
      * Logging service to be used in order to report application progress
      */
     std::shared_ptr<Afina::Logging::Service> pLogging;
+
+    /**
+     * Listening socket passed to UseListenSocket(), -1 if server has to create its own one
+     */
+    int inheritedSocket;
 };
 
 } // namespace Network
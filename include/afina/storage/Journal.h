@@ -0,0 +1,214 @@
+#ifndef AFINA_STORAGE_JOURNAL_H
+#define AFINA_STORAGE_JOURNAL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Append only log of storage changes
+ * Wraps another storage and records every successful change into the log, which is replayed on start. Request
+ * path only encodes the record and pushes it into the lock free queue, the dedicated thread drains the queue and
+ * writes everything it found by the single write (group commit), then syncs the file according to the policy.
+ *
+ * Records are idempotent: Put, PutIfAbsent and Set are logged as put of the resulting value, Delete as delete, so
+ * the log could be replayed on top of any storage state it has partially seen. Changes of the same key are
+ * serialized by the striped lock around storage call and push, so the log keeps their order.
+ *
+ * Log is split into segments, files "<path>.<number>". Exclusive() starts the new segment while storage is held,
+ * so snapshot taken inside it covers all previous segments; they are removed by Compact() once snapshot is saved.
+ *
+ * Record format, integers are little endian:
+ * u8 type (1 - put, 2 - delete), u32 key size, u32 value size, key, value, u32 CRC32 of everything before
+ * Replay stops at the first broken record of the segment, that is a write torn by crash.
+ */
+class Journal : public Afina::Storage {
+public:
+    enum class Sync {
+        // Change is synced before storage method returns
+        Always,
+
+        // File is synced once in the interval if anything was written
+        Periodic,
+
+        // File is never synced explicitly, OS writes it when it decides to
+        Never
+    };
+
+    /**
+     * @param storage storage to record changes of
+     * @param path prefix of the segment file names
+     * @param sync when file is synced
+     * @param sync_interval how often file is synced with Sync::Periodic
+     */
+    Journal(std::shared_ptr<Afina::Storage> storage, const std::string &path, Sync sync = Sync::Periodic,
+            std::chrono::milliseconds sync_interval = std::chrono::milliseconds(1000));
+    ~Journal();
+
+    /**
+     * Replays existing segments into the storage, starts the new segment and the writer. Nothing is logged before
+     * that, so snapshot could be loaded through the journal beforehand. Throws std::runtime_error if segment can't
+     * be created
+     */
+    void Start() override;
+
+    /**
+     * Writes and syncs everything queued, stops the writer
+     */
+    void Stop() override;
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override;
+
+    // Implements Afina::Storage interface
+    void Stats(std::vector<std::pair<std::string, std::string>> &stats) override;
+
+    // Implements Afina::Storage interface
+    void ForEach(const std::function<void(const std::string &key, const std::string &value)> &visitor) override;
+
+    // Implements Afina::Storage interface
+    void ForEachUnlocked(const std::function<void(const std::string &key, const std::string &value)> &visitor) override;
+
+    /**
+     * Starts the new segment and runs function while storage is held, see Storage.h
+     */
+    void Exclusive(const std::function<void()> &fn) override;
+
+    /**
+     * Must be called once for every Exclusive() call, in the same order, when snapshot taken in it is finished.
+     * If it was saved, segments it covers are removed
+     */
+    void Compact(bool saved);
+
+    /**
+     * Number of records replayed by Start()
+     */
+    std::size_t Replayed() const { return _replayed; }
+
+    static const char *SyncName(Sync sync);
+
+private:
+    // Element of the queue: encoded record, or command to start the next segment
+    struct node {
+        std::atomic<node *> next;
+        std::string data;
+
+        // Segment to start, zero for records
+        uint64_t segment;
+
+        // Producer waits for the record to be synced, node belongs to it
+        bool wait;
+        bool done;
+
+        node() : next(nullptr), segment(0), wait(false), done(false) {}
+    };
+
+    static const std::size_t kStripes = 64;
+
+    // Encodes the record into node
+    static void _Encode(node &n, char type, const std::string &key, const std::string &value);
+
+    // Pushes node into the queue, wakes writer up if it sleeps. Lock free
+    void _Push(node *n);
+
+    // Pops node from the queue, nullptr if it is empty. Writer only
+    node *_Pop();
+
+    // Pushes the change into the queue. With Sync::Always record itself is pushed, otherwise its copy
+    void _Log(node &record, char type, const std::string &key, const std::string &value);
+
+    // Waits for the record to be synced if it was pushed by Sync::Always
+    void _Wait(node &record);
+
+    std::mutex &_Stripe(const std::string &key);
+
+    // Replays segment into the storage, returns number of records
+    std::size_t _Replay(const std::string &file);
+
+    // Segment numbers existing on disk, ascending
+    std::vector<uint64_t> _Segments() const;
+    std::string _SegmentPath(uint64_t segment) const;
+
+    // Opens new segment file, closes current one
+    void _Open(uint64_t segment);
+
+    // Writes batch to the current segment
+    void _Write(const std::string &batch);
+    void _Sync();
+
+    void _OnRun();
+
+    std::shared_ptr<Afina::Storage> _storage;
+    std::string _path;
+    Sync _sync;
+    std::chrono::milliseconds _sync_interval;
+
+    std::unique_ptr<std::mutex[]> _stripes;
+    bool _logging;
+
+    // Queue, producers push to _head, writer pops from _tail
+    std::atomic<node *> _head;
+    node *_tail;
+    node _stub;
+
+    // Writer sleeps when queue is empty
+    std::thread _thread;
+    std::atomic<bool> _running;
+    std::atomic<bool> _sleeping;
+    std::mutex _wakeup_mutex;
+    std::condition_variable _wakeup;
+
+    // Producers waiting for Sync::Always records
+    std::mutex _synced_mutex;
+    std::condition_variable _synced;
+
+    // Current segment, changed only while storage is held exclusively
+    std::atomic<uint64_t> _segment;
+
+    // Segments started by Exclusive() calls which snapshots aren't finished yet
+    std::mutex _compact_mutex;
+    std::deque<uint64_t> _checkpoints;
+
+    // Writer state
+    int _fd;
+    bool _dirty;
+
+    std::size_t _replayed;
+    std::atomic<uint64_t> _records;
+    std::atomic<uint64_t> _bytes;
+    std::atomic<uint64_t> _batches;
+    std::atomic<uint64_t> _syncs;
+    std::atomic<uint64_t> _errors;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_JOURNAL_H
@@ -0,0 +1,125 @@
+#ifndef AFINA_STORAGE_SNAPSHOT_H
+#define AFINA_STORAGE_SNAPSHOT_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <sys/types.h>
+
+namespace Afina {
+
+class Storage;
+
+namespace Backend {
+
+/**
+ * # Point in time snapshot of the storage
+ * Snapshot is written by the forked child. Fork happens while storage is held exclusively, so the child gets
+ * consistent copy of it and the parent continues to serve requests right away, paying only for copy-on-write
+ * page faults. Child streams items into the temporary file which replaces the previous snapshot once written and
+ * synced, so crash never leaves partial snapshot behind.
+ *
+ * File format, integers are little endian:
+ * "AFSNAP1\n"
+ * item: u32 key size, u32 value size, key, value; repeated
+ * u32 0xffffffff, u64 number of items, u32 CRC32 of everything before the checksum
+ */
+class Snapshot {
+public:
+    struct Status {
+        bool in_progress = false;
+
+        // Unix time the last snapshot finished at, 0 if there was none
+        int64_t last_time = 0;
+        bool last_ok = false;
+        int64_t last_duration_ms = 0;
+        uint64_t last_bytes = 0;
+    };
+
+    /**
+     * @param storage storage to be saved and loaded
+     * @param path snapshot file
+     * @param interval snapshot is written that often once started, zero disables timer
+     */
+    Snapshot(std::shared_ptr<Storage> storage, const std::string &path,
+             std::chrono::seconds interval = std::chrono::seconds(0));
+    ~Snapshot();
+
+    /**
+     * Starts the thread triggering snapshots by timer and waiting for children to finish, makes the snapshot
+     * current one
+     */
+    void Start();
+
+    /**
+     * Stops the thread, waits for running snapshot to finish
+     */
+    void Stop();
+
+    /**
+     * Starts writing snapshot in background, returns false if one is already in progress. Throws
+     * std::runtime_error if fork fails
+     */
+    bool Trigger();
+
+    /**
+     * Waits for the snapshot in progress to finish, returns true if the last one succeeded
+     */
+    bool Wait();
+
+    /**
+     * Puts items from the snapshot file to the storage, returns number of items loaded, zero if there is no file.
+     * File is verified before anything is loaded, corrupted one is rejected by std::runtime_error
+     */
+    std::size_t Load();
+
+    Status GetStatus() const;
+
+    /**
+     * Sets function to be called with result of every snapshot once it finishes, snapshots failed to fork are
+     * reported too. Must be set before any snapshot is triggered
+     */
+    void OnFinish(std::function<void(bool ok)> callback);
+
+    /**
+     * Snapshot started last, nullptr if there is no running one
+     */
+    static Snapshot *Current();
+
+private:
+    // Runs in the child, writes snapshot file, returns exit code
+    int _Write();
+
+    // Reaps finished child, must be called under the lock
+    void _Reap();
+
+    void _OnRun();
+
+    std::shared_ptr<Storage> _storage;
+    std::string _path;
+    std::chrono::seconds _interval;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _changed;
+    std::thread _thread;
+    bool _running;
+
+    // Child writing snapshot, -1 if there is none
+    pid_t _child;
+    std::chrono::steady_clock::time_point _started;
+    Status _status;
+    std::function<void(bool ok)> _on_finish;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_SNAPSHOT_H
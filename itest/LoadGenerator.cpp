@@ -0,0 +1,769 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cxxopts.hpp>
+
+#include "Histogram.h"
+
+using Afina::Test::Histogram;
+
+namespace {
+
+// Monotonic time in nanoseconds, same clock timerfd uses
+int64_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+struct Config {
+    std::string host;
+    uint16_t port = 0;
+    std::size_t threads = 0;
+    std::size_t connections = 0;
+    std::size_t depth = 0;
+
+    // Requests per second over all connections, 0 runs closed loop
+    double rate = 0;
+
+    double warmup = 0;
+    double duration = 0;
+    std::size_t keys = 0;
+    std::size_t value_size = 0;
+    double reads = 0;
+    uint64_t seed = 0;
+};
+
+// Results of the measured interval
+struct Stats {
+    uint64_t gets = 0;
+    uint64_t hits = 0;
+    uint64_t sets = 0;
+    uint64_t errors = 0;
+    uint64_t unfinished = 0;
+    uint64_t dropped = 0;
+
+    // Time from the moment request was due to be sent, includes time it waited for the connection
+    Histogram latency;
+
+    // Time from the moment request was actually sent
+    Histogram service;
+
+    void merge(const Stats &other) {
+        gets += other.gets;
+        hits += other.hits;
+        sets += other.sets;
+        errors += other.errors;
+        unfinished += other.unfinished;
+        dropped += other.dropped;
+        latency.merge(other.latency);
+        service.merge(other.service);
+    }
+};
+
+/**
+ * Client connection, keeps up to depth requests in flight. In open loop requests are issued by the schedule
+ * no matter how fast server responds, ones that don't fit into the pipeline wait in the backlog. Latency is
+ * counted from the scheduled time, so server stalls are not hidden by the client backing off (coordinated
+ * omission)
+ */
+class Connection {
+public:
+    struct request {
+        bool get;
+        int64_t intended;
+        int64_t sent;
+    };
+
+    Connection(int fd, int64_t first_due, int64_t interval) : fd(fd), next_due(first_due), interval(interval) {}
+    ~Connection() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    int fd;
+
+    // Schedule of the open loop
+    int64_t next_due;
+    int64_t interval;
+
+    // Requests due but not sent yet, intended send times
+    std::deque<int64_t> backlog;
+
+    // Requests sent, waiting for response
+    std::deque<request> pending;
+
+    // Data to be sent from the position
+    std::string out;
+    std::size_t out_pos = 0;
+
+    // Data received, responses are parsed from the position
+    std::string in;
+    std::size_t in_pos = 0;
+
+    // Current get response has values
+    bool hit = false;
+
+    bool writing = false;
+};
+
+class Worker {
+public:
+    Worker(const Config &config, std::size_t id, std::size_t connections, int64_t start)
+        : _config(config), _rng(config.seed + id) {
+        _measure_from = start + static_cast<int64_t>(config.warmup * 1e9);
+        _end = _measure_from + static_cast<int64_t>(config.duration * 1e9);
+
+        _epoll = epoll_create1(EPOLL_CLOEXEC);
+        _timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (_epoll < 0 || _timer < 0) {
+            throw std::runtime_error("Failed to create epoll: " + std::string(strerror(errno)));
+        }
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = nullptr;
+        epoll_ctl(_epoll, EPOLL_CTL_ADD, _timer, &ev);
+
+        // Connections of the open loop are staggered so they don't fire at once
+        const int64_t interval =
+            config.rate > 0 ? static_cast<int64_t>(config.connections * 1e9 / config.rate) : 0;
+        for (std::size_t i = 0; i < connections; i++) {
+            const int64_t offset = interval * (id + i * config.threads) / std::max<std::size_t>(config.connections, 1);
+            _connections.emplace_back(new Connection(_Connect(), start + offset, interval));
+
+            Connection *conn = _connections.back().get();
+            ev.events = EPOLLIN;
+            ev.data.ptr = conn;
+            epoll_ctl(_epoll, EPOLL_CTL_ADD, conn->fd, &ev);
+        }
+
+        _value.assign(config.value_size, 'v');
+    }
+
+    ~Worker() {
+        close(_epoll);
+        close(_timer);
+    }
+
+    void Run() {
+        const int64_t drain_until = _end + 2000000000LL;
+        std::vector<struct epoll_event> events(64);
+        while (!_connections.empty()) {
+            int64_t now = Now();
+            if (now >= _end && (now >= drain_until || _Idle())) {
+                break;
+            }
+
+            int64_t next = now + 100000000LL;
+            for (auto &conn : _connections) {
+                _Pump(*conn, now);
+                if (conn->interval > 0 && conn->next_due < _end) {
+                    next = std::min(next, conn->next_due);
+                }
+            }
+            _Arm(std::max(next, now + 1000));
+
+            int n = epoll_wait(_epoll, events.data(), events.size(), -1);
+            if (n < 0 && errno != EINTR) {
+                throw std::runtime_error("epoll_wait failed: " + std::string(strerror(errno)));
+            }
+
+            for (int i = 0; i < n; i++) {
+                Connection *conn = static_cast<Connection *>(events[i].data.ptr);
+                if (conn == nullptr) {
+                    uint64_t expirations;
+                    while (read(_timer, &expirations, sizeof(expirations)) > 0) {
+                    }
+                    continue;
+                }
+
+                if ((events[i].events & EPOLLIN) && !_Read(*conn)) {
+                    _Drop(conn);
+                    continue;
+                }
+                if ((events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) && !_Write(*conn)) {
+                    _Drop(conn);
+                }
+            }
+        }
+
+        // Requests left without response, including ones stuck since warmup
+        for (auto &conn : _connections) {
+            _stats.unfinished += conn->pending.size() + conn->backlog.size();
+        }
+    }
+
+    const Stats &stats() const { return _stats; }
+    int64_t measure_from() const { return _measure_from; }
+    int64_t end() const { return _end; }
+
+private:
+    int _Connect() {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to create socket: " + std::string(strerror(errno)));
+        }
+
+        struct sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(_config.port);
+        if (inet_pton(AF_INET, _config.host.c_str(), &addr.sin_addr) != 1) {
+            close(fd);
+            throw std::runtime_error("Bad address: " + _config.host);
+        }
+        if (connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0) {
+            close(fd);
+            throw std::runtime_error("Failed to connect: " + std::string(strerror(errno)));
+        }
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        return fd;
+    }
+
+    bool _Measured(int64_t intended) const { return intended >= _measure_from && intended < _end; }
+
+    bool _Idle() const {
+        for (auto &conn : _connections) {
+            if (!conn->pending.empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void _Arm(int64_t when) {
+        struct itimerspec spec;
+        std::memset(&spec, 0, sizeof(spec));
+        spec.it_value.tv_sec = when / 1000000000LL;
+        spec.it_value.tv_nsec = when % 1000000000LL;
+        timerfd_settime(_timer, TFD_TIMER_ABSTIME, &spec, nullptr);
+    }
+
+    // Issues requests due by now and sends as many as pipeline allows
+    void _Pump(Connection &conn, int64_t now) {
+        if (conn.interval > 0) {
+            for (; conn.next_due <= now && conn.next_due < _end; conn.next_due += conn.interval) {
+                conn.backlog.push_back(conn.next_due);
+            }
+        } else if (now < _end) {
+            while (conn.backlog.size() + conn.pending.size() < _config.depth) {
+                conn.backlog.push_back(now);
+            }
+        }
+
+        bool queued = false;
+        while (!conn.backlog.empty() && conn.pending.size() < _config.depth) {
+            Connection::request r;
+            r.get = std::uniform_real_distribution<double>(0, 1)(_rng) < _config.reads;
+            r.intended = conn.backlog.front();
+            r.sent = now;
+            conn.backlog.pop_front();
+            conn.pending.push_back(r);
+
+            const std::string key = "key:" + std::to_string(_rng() % _config.keys);
+            if (r.get) {
+                conn.out += "get " + key + "\r\n";
+            } else {
+                conn.out += "set " + key + " 0 0 " + std::to_string(_value.size()) + "\r\n";
+                conn.out += _value;
+                conn.out += "\r\n";
+            }
+            queued = true;
+        }
+
+        if (queued && !conn.writing) {
+            _Write(conn);
+        }
+    }
+
+    bool _Write(Connection &conn) {
+        while (conn.out_pos < conn.out.size()) {
+            ssize_t n = send(conn.fd, conn.out.data() + conn.out_pos, conn.out.size() - conn.out_pos, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            } else if (n <= 0) {
+                return false;
+            }
+            conn.out_pos += n;
+        }
+
+        if (conn.out_pos == conn.out.size()) {
+            conn.out.clear();
+            conn.out_pos = 0;
+        }
+
+        // Wait for the socket to become writable only while there is something to write
+        const bool writing = !conn.out.empty();
+        if (writing != conn.writing) {
+            struct epoll_event ev;
+            ev.events = EPOLLIN | (writing ? EPOLLOUT : 0);
+            ev.data.ptr = &conn;
+            epoll_ctl(_epoll, EPOLL_CTL_MOD, conn.fd, &ev);
+            conn.writing = writing;
+        }
+        return true;
+    }
+
+    bool _Read(Connection &conn) {
+        char buffer[16384];
+        while (true) {
+            ssize_t n = recv(conn.fd, buffer, sizeof(buffer), 0);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            } else if (n <= 0) {
+                return false;
+            }
+            conn.in.append(buffer, n);
+        }
+
+        const int64_t now = Now();
+        while (_Parse(conn, now)) {
+        }
+        conn.in.erase(0, conn.in_pos);
+        conn.in_pos = 0;
+
+        _Pump(conn, now);
+        return true;
+    }
+
+    // Parses the next line of response, returns false if more data is needed
+    bool _Parse(Connection &conn, int64_t now) {
+        const std::size_t eol = conn.in.find("\r\n", conn.in_pos);
+        if (eol == std::string::npos) {
+            return false;
+        }
+
+        const char *line = conn.in.data() + conn.in_pos;
+        const std::size_t line_size = eol - conn.in_pos;
+        if (line_size > 6 && std::strncmp(line, "VALUE ", 6) == 0) {
+            // VALUE <key> <flags> <bytes>, block of data follows
+            const std::size_t space = conn.in.rfind(' ', eol);
+            const std::size_t bytes = std::strtoull(conn.in.c_str() + space + 1, nullptr, 10);
+            if (conn.in.size() < eol + 2 + bytes + 2) {
+                return false;
+            }
+            conn.in_pos = eol + 2 + bytes + 2;
+            conn.hit = true;
+            return true;
+        }
+        conn.in_pos = eol + 2;
+
+        if (conn.pending.empty()) {
+            throw std::runtime_error("Unexpected response: " + std::string(line, line_size));
+        }
+        const Connection::request r = conn.pending.front();
+        conn.pending.pop_front();
+
+        const bool error = (line_size == 5 && std::strncmp(line, "ERROR", 5) == 0) ||
+                           (line_size > 12 && std::strncmp(line, "CLIENT_ERROR", 12) == 0) ||
+                           (line_size > 12 && std::strncmp(line, "SERVER_ERROR", 12) == 0);
+        if (_Measured(r.intended)) {
+            if (error) {
+                _stats.errors++;
+            } else if (r.get) {
+                _stats.gets++;
+                _stats.hits += conn.hit;
+            } else {
+                _stats.sets++;
+            }
+            _stats.latency.add(now - r.intended);
+            _stats.service.add(now - r.sent);
+        }
+        conn.hit = false;
+        return true;
+    }
+
+    void _Drop(Connection *conn) {
+        _stats.dropped++;
+        epoll_ctl(_epoll, EPOLL_CTL_DEL, conn->fd, nullptr);
+        for (const Connection::request &r : conn->pending) {
+            _stats.errors += _Measured(r.intended);
+        }
+
+        auto it = std::find_if(_connections.begin(), _connections.end(),
+                               [conn](const std::unique_ptr<Connection> &c) { return c.get() == conn; });
+        _connections.erase(it);
+    }
+
+    const Config &_config;
+    std::mt19937_64 _rng;
+
+    // Schedule: measurement starts, load stops
+    int64_t _measure_from;
+    int64_t _end;
+
+    int _epoll;
+    int _timer;
+    std::vector<std::unique_ptr<Connection>> _connections;
+    std::string _value;
+    Stats _stats;
+};
+
+// Starts afina with the given arguments, output is discarded
+pid_t Spawn(const std::string &binary, const std::string &args) {
+    std::vector<std::string> argv_storage{binary};
+    std::istringstream in(args);
+    for (std::string arg; in >> arg;) {
+        argv_storage.push_back(arg);
+    }
+
+    std::vector<char *> argv;
+    for (std::string &arg : argv_storage) {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        throw std::runtime_error("Failed to fork: " + std::string(strerror(errno)));
+    } else if (pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+        execv(binary.c_str(), argv.data());
+        _exit(127);
+    }
+    return pid;
+}
+
+// Waits until server accepts connections
+void WaitServer(const Config &config, pid_t pid) {
+    const int64_t deadline = Now() + 10000000000LL;
+    while (Now() < deadline) {
+        int status;
+        if (pid > 0 && waitpid(pid, &status, WNOHANG) == pid) {
+            throw std::runtime_error("Server exited");
+        }
+
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        struct sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(config.port);
+        inet_pton(AF_INET, config.host.c_str(), &addr.sin_addr);
+        const bool ok = connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) == 0;
+        close(fd);
+        if (ok) {
+            // Let the server notice the probe is closed, so it doesn't hold connection slot
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    throw std::runtime_error("Server doesn't accept connections");
+}
+
+// Stops the server, kills it if it doesn't stop in time
+void StopServer(pid_t pid) {
+    kill(pid, SIGTERM);
+    for (int i = 0; i < 100; i++) {
+        if (waitpid(pid, nullptr, WNOHANG) == pid) {
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+}
+
+// Resources used by the process so far
+struct Usage {
+    int64_t cpu_ns = 0;
+    uint64_t context_switches = 0;
+};
+
+// Reads usage of the process from procfs. Context switches are summed over live threads, ones of exited
+// threads are lost
+Usage Sample(pid_t pid) {
+    Usage usage;
+    const std::string proc = "/proc/" + std::to_string(pid);
+
+    // utime and stime are 14th and 15th fields, name in the 2nd one could have spaces
+    std::ifstream stat(proc + "/stat");
+    std::string line;
+    if (std::getline(stat, line) && line.rfind(')') != std::string::npos) {
+        std::istringstream fields(line.substr(line.rfind(')') + 2));
+        std::string field;
+        unsigned long long utime = 0, stime = 0;
+        for (int i = 3; i <= 13 && fields >> field; i++) {
+        }
+        fields >> utime >> stime;
+        usage.cpu_ns = static_cast<int64_t>((utime + stime) * (1e9 / sysconf(_SC_CLK_TCK)));
+    }
+
+    DIR *tasks = opendir((proc + "/task").c_str());
+    if (tasks == nullptr) {
+        return usage;
+    }
+    while (struct dirent *entry = readdir(tasks)) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        std::ifstream status(proc + "/task/" + entry->d_name + "/status");
+        while (std::getline(status, line)) {
+            if (line.compare(0, 23, "voluntary_ctxt_switches") == 0 ||
+                line.compare(0, 26, "nonvoluntary_ctxt_switches") == 0) {
+                usage.context_switches += std::strtoull(line.c_str() + line.find(':') + 1, nullptr, 10);
+            }
+        }
+    }
+    closedir(tasks);
+    return usage;
+}
+
+struct Report {
+    std::string label;
+    Config config;
+    Stats stats;
+
+    // Server resources used during the measurement, if server was started by us
+    bool has_usage = false;
+    Usage usage;
+
+    std::string error;
+};
+
+void PrintLatency(const char *name, const Histogram &h) {
+    std::printf("%s:\n", name);
+    const double percentiles[] = {50, 75, 90, 99, 99.9, 99.99};
+    for (double p : percentiles) {
+        std::printf("  %7.2f%%  %10.1f us\n", p, h.percentile(p) / 1000.0);
+    }
+    std::printf("  %8s  %10.1f us\n", "max", h.max() / 1000.0);
+}
+
+void PrintText(const Report &r) {
+    const Config &config = r.config;
+    const Stats &stats = r.stats;
+    const uint64_t completed = stats.gets + stats.sets + stats.errors;
+    std::printf("%s loop, %zu connections, depth %zu, %zu threads", config.rate > 0 ? "open" : "closed",
+                config.connections, config.depth, config.threads);
+    if (config.rate > 0) {
+        std::printf(", target %.0f req/s", config.rate);
+    }
+    std::printf("\n");
+    std::printf("throughput: %.0f req/s\n", completed / config.duration);
+    std::printf("gets: %llu, hit ratio %.4f, sets: %llu, errors: %llu, unfinished: %llu, dropped connections: %llu\n",
+                static_cast<unsigned long long>(stats.gets), stats.gets > 0 ? double(stats.hits) / stats.gets : 0,
+                static_cast<unsigned long long>(stats.sets), static_cast<unsigned long long>(stats.errors),
+                static_cast<unsigned long long>(stats.unfinished), static_cast<unsigned long long>(stats.dropped));
+    if (r.has_usage && completed > 0) {
+        std::printf("server: %.2f us cpu/req, %.3f context switches/req\n", r.usage.cpu_ns / 1000.0 / completed,
+                    double(r.usage.context_switches) / completed);
+    }
+    PrintLatency(config.rate > 0 ? "latency (from scheduled time)" : "latency", stats.latency);
+    if (config.rate > 0) {
+        PrintLatency("service time (from actual send)", stats.service);
+    }
+}
+
+const char *kCsvHeader = "label,connections,depth,value_size,rate,throughput,gets,hit_ratio,sets,errors,unfinished,"
+                         "dropped,p50_us,p90_us,p99_us,p999_us,max_us,cpu_us_per_req,ctx_switches_per_req,error";
+
+// Prints report as a row of CSV with the header above
+void PrintCsv(const Report &r) {
+    const Config &config = r.config;
+    const Stats &stats = r.stats;
+    const uint64_t completed = stats.gets + stats.sets + stats.errors;
+    const double throughput = config.duration > 0 ? completed / config.duration : 0;
+    std::printf("%s,%zu,%zu,%zu,%.0f,%.0f,%llu,%.4f,%llu,%llu,%llu,%llu,%.1f,%.1f,%.1f,%.1f,%.1f,", r.label.c_str(),
+                config.connections, config.depth, config.value_size, config.rate, throughput,
+                static_cast<unsigned long long>(stats.gets), stats.gets > 0 ? double(stats.hits) / stats.gets : 0,
+                static_cast<unsigned long long>(stats.sets), static_cast<unsigned long long>(stats.errors),
+                static_cast<unsigned long long>(stats.unfinished), static_cast<unsigned long long>(stats.dropped),
+                stats.latency.percentile(50) / 1000.0, stats.latency.percentile(90) / 1000.0,
+                stats.latency.percentile(99) / 1000.0, stats.latency.percentile(99.9) / 1000.0,
+                stats.latency.max() / 1000.0);
+    if (r.has_usage && completed > 0) {
+        std::printf("%.2f,%.3f", r.usage.cpu_ns / 1000.0 / completed, double(r.usage.context_switches) / completed);
+    } else {
+        std::printf(",");
+    }
+
+    // Error is quoted, so it could have commas
+    std::string error = r.error;
+    for (char &c : error) {
+        c = c == '"' ? '\'' : c;
+    }
+    std::printf(",%s\n", error.empty() ? "" : ("\"" + error + "\"").c_str());
+}
+
+} // namespace
+
+/**
+ * Memcached protocol load generator. Connections are spread over threads, each thread serves own connections
+ * with epoll. Without --rate every connection keeps --depth requests in flight (closed loop), with the rate
+ * requests are issued by the fixed schedule regardless of responses (open loop) and latency accounts for the time
+ * request waited to be sent.
+ *
+ * Usage: afina-load [--afina path/to/afina --afina-args "-n mt_block"] [--connections 16] [--rate 50000] ...
+ */
+int main(int argc, char **argv) {
+    cxxopts::Options options("afina-load", "Memcached protocol load generator");
+    options.add_options()("host", "Server address", cxxopts::value<std::string>()->default_value("127.0.0.1"));
+    options.add_options()("port", "Server port", cxxopts::value<uint16_t>()->default_value("8080"));
+    options.add_options()("threads", "Number of threads", cxxopts::value<std::size_t>()->default_value("1"));
+    options.add_options()("connections", "Number of connections", cxxopts::value<std::size_t>()->default_value("16"));
+    options.add_options()("depth", "Requests in flight per connection",
+                          cxxopts::value<std::size_t>()->default_value("1"));
+    options.add_options()("rate", "Requests per second, open loop if set",
+                          cxxopts::value<double>()->default_value("0"));
+    options.add_options()("warmup", "Seconds before measurement", cxxopts::value<double>()->default_value("1"));
+    options.add_options()("duration", "Seconds to measure", cxxopts::value<double>()->default_value("10"));
+    options.add_options()("keys", "Number of distinct keys", cxxopts::value<std::size_t>()->default_value("10000"));
+    options.add_options()("value-size", "Value size, bytes", cxxopts::value<std::size_t>()->default_value("100"));
+    options.add_options()("reads", "Fraction of get requests", cxxopts::value<double>()->default_value("0.9"));
+    options.add_options()("seed", "Random seed", cxxopts::value<uint64_t>()->default_value("1"));
+    options.add_options()("afina", "Start server binary before the load", cxxopts::value<std::string>());
+    options.add_options()("afina-args", "Arguments of the server", cxxopts::value<std::string>()->default_value(""));
+    options.add_options()("csv", "Print results as CSV row");
+    options.add_options()("csv-header", "Print header of CSV and exit");
+    options.add_options()("label", "First column of CSV row", cxxopts::value<std::string>()->default_value(""));
+    options.add_options()("h,help", "Print usage info");
+
+    Report report;
+    bool csv = false;
+    pid_t server = -1;
+    try {
+        options.parse(argc, argv);
+        if (options.count("help") > 0) {
+            std::cout << options.help() << std::endl;
+            return 0;
+        } else if (options.count("csv-header") > 0) {
+            std::printf("%s\n", kCsvHeader);
+            return 0;
+        }
+
+        csv = options.count("csv") > 0;
+        report.label = options["label"].as<std::string>();
+
+        Config &config = report.config;
+        config.host = options["host"].as<std::string>();
+        config.port = options["port"].as<uint16_t>();
+        config.connections = std::max<std::size_t>(1, options["connections"].as<std::size_t>());
+        config.threads = std::min(config.connections, std::max<std::size_t>(1, options["threads"].as<std::size_t>()));
+        config.depth = std::max<std::size_t>(1, options["depth"].as<std::size_t>());
+        config.rate = options["rate"].as<double>();
+        config.warmup = options["warmup"].as<double>();
+        config.duration = options["duration"].as<double>();
+        config.keys = std::max<std::size_t>(1, options["keys"].as<std::size_t>());
+        config.value_size = options["value-size"].as<std::size_t>();
+        config.reads = options["reads"].as<double>();
+        config.seed = options["seed"].as<uint64_t>();
+        if (config.duration <= 0) {
+            throw std::runtime_error("Duration must be positive");
+        }
+
+        if (options.count("afina") > 0) {
+            server = Spawn(options["afina"].as<std::string>(), options["afina-args"].as<std::string>());
+        }
+        WaitServer(config, server);
+
+        // Connections are established before the schedule starts
+        const int64_t start = Now() + 100000000LL;
+        std::vector<std::unique_ptr<Worker>> workers;
+        for (std::size_t id = 0; id < config.threads; id++) {
+            const std::size_t connections =
+                config.connections / config.threads + (id < config.connections % config.threads);
+            workers.emplace_back(new Worker(config, id, connections, start));
+        }
+
+        std::vector<std::thread> threads;
+        std::vector<std::string> errors(workers.size());
+        for (std::size_t id = 0; id < workers.size(); id++) {
+            threads.emplace_back([&workers, &errors, id] {
+                try {
+                    workers[id]->Run();
+                } catch (std::exception &e) {
+                    errors[id] = e.what();
+                }
+            });
+        }
+
+        // Server resources are sampled at the bounds of the measured interval
+        if (server > 0) {
+            auto sleep_until = [](int64_t when) {
+                const int64_t now = Now();
+                if (when > now) {
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(when - now));
+                }
+            };
+
+            sleep_until(workers[0]->measure_from());
+            const Usage from = Sample(server);
+            sleep_until(workers[0]->end());
+            const Usage to = Sample(server);
+
+            report.has_usage = true;
+            report.usage.cpu_ns = to.cpu_ns - from.cpu_ns;
+            report.usage.context_switches = to.context_switches - from.context_switches;
+        }
+
+        for (auto &t : threads) {
+            t.join();
+        }
+        for (const std::string &error : errors) {
+            if (!error.empty()) {
+                throw std::runtime_error(error);
+            }
+        }
+
+        for (auto &worker : workers) {
+            report.stats.merge(worker->stats());
+        }
+        if (report.stats.gets + report.stats.sets + report.stats.errors == 0) {
+            throw std::runtime_error("No responses received");
+        }
+    } catch (std::exception &e) {
+        report.error = e.what();
+    }
+
+    if (server > 0) {
+        StopServer(server);
+    }
+
+    if (!report.error.empty()) {
+        std::cerr << "Error: " << report.error << std::endl;
+    }
+    if (csv) {
+        PrintCsv(report);
+    } else if (report.error.empty()) {
+        PrintText(report);
+    }
+    return report.error.empty() ? 0 : 1;
+}
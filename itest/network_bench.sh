@@ -0,0 +1,62 @@
+#!/bin/bash
+#
+# Compares network services of afina: every service is started in turn and loaded by afina-load with each
+# combination of connection count, pipeline depth and value size. Results go to CSV, one row per run.
+#
+# Usage: network_bench.sh <build dir> [report.csv]
+#
+# Matrix is configured by environment, lists are space separated:
+#   NETWORKS     network services to compare, "st_block mt_block" by default. non_block isn't listed as it
+#                doesn't reply to commands yet, afina-load would measure nothing but timeouts
+#   STORAGE      storage to run them with, mt_slab by default
+#   CONNECTIONS  connection counts, "1 8 32" by default
+#   DEPTHS       pipeline depths, "1 8" by default
+#   VALUE_SIZES  value sizes, "100 4096" by default
+#   DURATION     seconds to measure each run, 5 by default
+#   WARMUP       seconds before measurement, 1 by default
+#   LOAD_ARGS    extra arguments of afina-load, for example "--rate 20000 --threads 2"
+set -u
+
+if [ $# -lt 1 ]; then
+    echo "Usage: $0 <build dir> [report.csv]" >&2
+    exit 1
+fi
+
+BUILD=$1
+REPORT=${2:-network_bench.csv}
+AFINA=$BUILD/src/afina
+LOAD=$BUILD/itest/afina-load
+
+NETWORKS=${NETWORKS:-"st_block mt_block"}
+STORAGE=${STORAGE:-mt_slab}
+CONNECTIONS=${CONNECTIONS:-"1 8 32"}
+DEPTHS=${DEPTHS:-"1 8"}
+VALUE_SIZES=${VALUE_SIZES:-"100 4096"}
+DURATION=${DURATION:-5}
+WARMUP=${WARMUP:-1}
+LOAD_ARGS=${LOAD_ARGS:-}
+
+for binary in "$AFINA" "$LOAD"; do
+    if [ ! -x "$binary" ]; then
+        echo "$binary not found, build afina and afina-load first" >&2
+        exit 1
+    fi
+done
+
+"$LOAD" --csv-header > "$REPORT"
+for network in $NETWORKS; do
+    for connections in $CONNECTIONS; do
+        for depth in $DEPTHS; do
+            for value_size in $VALUE_SIZES; do
+                echo "$network: $connections connections, depth $depth, value size $value_size" >&2
+
+                # Failed runs still produce the row with error column filled
+                "$LOAD" --afina "$AFINA" --afina-args "-n $network -s $STORAGE" --label "$network" --csv \
+                    --connections "$connections" --depth "$depth" --value-size "$value_size" \
+                    --duration "$DURATION" --warmup "$WARMUP" $LOAD_ARGS >> "$REPORT"
+            done
+        done
+    done
+done
+
+echo "Report: $REPORT" >&2
@@ -0,0 +1,67 @@
+#include <afina/allocator/Arena.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace Afina {
+namespace Allocator {
+
+// See Arena.h
+Arena::Arena(std::size_t block_size) : _head(nullptr), _used(0), _block_size(block_size) {}
+
+// See Arena.h
+Arena::~Arena() { _Release(); }
+
+// See Arena.h
+void Arena::reset() {
+    _used = 0;
+    if (_head == nullptr || _head->next == nullptr) {
+        return;
+    }
+
+    // Several blocks were needed, replace them by the single one
+    std::size_t total = capacity();
+    _Release();
+    _Grow(total);
+    _used = 0;
+}
+
+// See Arena.h
+std::size_t Arena::capacity() const {
+    std::size_t total = 0;
+    for (block *b = _head; b != nullptr; b = b->next) {
+        total += b->size;
+    }
+    return total;
+}
+
+// See Arena.h
+void *Arena::_Grow(std::size_t size) {
+    std::size_t block_size = std::max(_block_size, _head == nullptr ? std::size_t(0) : 2 * _head->size);
+    block_size = std::max(block_size, size);
+
+    void *memory = std::malloc(sizeof(block) + block_size);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    block *b = static_cast<block *>(memory);
+    b->next = _head;
+    b->size = block_size;
+    _head = b;
+
+    _used = size;
+    return b->data();
+}
+
+// See Arena.h
+void Arena::_Release() {
+    while (_head != nullptr) {
+        block *next = _head->next;
+        std::free(_head);
+        _head = next;
+    }
+}
+
+} // namespace Allocator
+} // namespace Afina
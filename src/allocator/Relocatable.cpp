@@ -0,0 +1,239 @@
+#include <afina/allocator/Relocatable.h>
+
+#include <cstring>
+#include <new>
+
+#include <afina/allocator/Error.h>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * Block header, block data follows it immediately. Free block keeps offset of the next one in the list at the
+ * beginning of data
+ */
+struct Relocatable::block {
+    // Size of the data, multiple of kAlign
+    uint64_t size;
+
+    // Descriptor refers to the block, zero for the free one
+    Handle handle;
+    uint32_t unused;
+};
+
+namespace {
+
+// "AFRELOC" and layout version
+const uint64_t kMagic = 0x414652454c4f4301ull;
+
+uint64_t AlignUp(uint64_t n, uint64_t align) { return (n + align - 1) & ~(align - 1); }
+
+char *AreaBegin(void *base) { return reinterpret_cast<char *>(AlignUp(reinterpret_cast<uintptr_t>(base), 16)); }
+
+// Size of the aligned area, zero if it is smaller than alignment
+std::size_t AreaSize(void *base, std::size_t size) {
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(AreaBegin(base));
+    const uintptr_t end = (reinterpret_cast<uintptr_t>(base) + size) & ~uintptr_t(sizeof(uint64_t) - 1);
+    return end > begin ? end - begin : 0;
+}
+
+uint64_t &NextFree(char *data) { return *reinterpret_cast<uint64_t *>(data); }
+
+} // namespace
+
+// See Relocatable.h
+Relocatable *Relocatable::Create(void *base, std::size_t size) {
+    const std::size_t area = AreaSize(base, size);
+    if (area < AlignUp(sizeof(Relocatable), kAlign) + sizeof(block) + kAlign + sizeof(uint64_t)) {
+        return nullptr;
+    }
+    return new (AreaBegin(base)) Relocatable(area);
+}
+
+// See Relocatable.h
+Relocatable *Relocatable::Attach(void *base, std::size_t size) {
+    const std::size_t area = AreaSize(base, size);
+    if (area < sizeof(Relocatable)) {
+        return nullptr;
+    }
+
+    Relocatable *allocator = reinterpret_cast<Relocatable *>(AreaBegin(base));
+    if (allocator->_magic != kMagic || allocator->_size != area) {
+        return nullptr;
+    }
+    return allocator;
+}
+
+// See Relocatable.h
+Relocatable::Relocatable(std::size_t size)
+    : _magic(kMagic), _size(size), _blocks_begin(AlignUp(sizeof(Relocatable), kAlign)), _blocks_end(_blocks_begin),
+      _handles(0), _free_handle(0), _free_bytes(0), _used_bytes(0) {
+    std::memset(_free_lists, 0, sizeof(_free_lists));
+}
+
+// See Relocatable.h
+Relocatable::Handle Relocatable::alloc(std::size_t N) {
+    const std::size_t size = AlignUp(N == 0 ? 1 : N, kAlign);
+    const Handle h = _AllocHandle();
+    if (h == 0) {
+        return 0;
+    }
+
+    const uint64_t offset = _AllocBlock(size);
+    if (offset == 0) {
+        *_Descriptor(h) = (uint64_t(_free_handle) << 1) | 1;
+        _free_handle = h;
+        return 0;
+    }
+
+    block *b = _Block(offset);
+    b->handle = h;
+    *_Descriptor(h) = offset + sizeof(block);
+    _used_bytes += sizeof(block) + b->size;
+    return h;
+}
+
+// See Relocatable.h
+void Relocatable::free(Handle h) {
+    if (h == 0) {
+        return;
+    }
+
+    const uint64_t data = h <= _handles ? *_Descriptor(h) : 1;
+    if ((data & 1) != 0 || data < _blocks_begin + sizeof(block) || data >= _blocks_end) {
+        throw AllocError(AllocErrorType::InvalidFree, "Handle doesn't refer to allocated block");
+    }
+
+    const uint64_t offset = data - sizeof(block);
+    block *b = _Block(offset);
+    if (b->handle != h) {
+        throw AllocError(AllocErrorType::InvalidFree, "Handle doesn't refer to allocated block");
+    }
+
+    *_Descriptor(h) = (uint64_t(_free_handle) << 1) | 1;
+    _free_handle = h;
+    _used_bytes -= sizeof(block) + b->size;
+
+    // The last block goes back to never used space
+    if (data + b->size == _blocks_end) {
+        _blocks_end = offset;
+    } else {
+        _Release(offset);
+    }
+}
+
+// See Relocatable.h
+std::size_t Relocatable::size(Handle h) const {
+    return reinterpret_cast<const block *>(_Base() + *_Descriptor(h) - sizeof(block))->size;
+}
+
+// See Relocatable.h
+void Relocatable::defrag() {
+    uint64_t dst = _blocks_begin;
+    for (uint64_t cur = _blocks_begin; cur < _blocks_end;) {
+        block *b = _Block(cur);
+        const uint64_t len = sizeof(block) + b->size;
+        const Handle h = b->handle;
+        if (h != 0) {
+            if (cur != dst) {
+                std::memmove(_Base() + dst, b, len);
+                *_Descriptor(h) = dst + sizeof(block);
+            }
+            dst += len;
+        }
+        cur += len;
+    }
+
+    _blocks_end = dst;
+    _free_bytes = 0;
+    std::memset(_free_lists, 0, sizeof(_free_lists));
+}
+
+// See Relocatable.h
+std::size_t Relocatable::unused_bytes() const { return _TableBegin() - _blocks_end; }
+
+// See Relocatable.h
+uint64_t Relocatable::_AllocBlock(std::size_t size) {
+    const std::size_t list = size <= kSmall ? size / kAlign - 1 : kLists - 1;
+    if (size <= kSmall) {
+        if (uint64_t offset = _Take(list)) {
+            return offset;
+        }
+    }
+
+    if (_TableBegin() - _blocks_end >= sizeof(block) + size) {
+        const uint64_t offset = _blocks_end;
+        block *b = _Block(offset);
+        b->size = size;
+        b->handle = 0;
+        _blocks_end += sizeof(block) + size;
+        return offset;
+    }
+
+    // Split larger block, the rest has to be large enough for the header and some data
+    uint64_t offset = 0;
+    for (std::size_t i = list + 2; i < kLists - 1 && offset == 0; i++) {
+        offset = _Take(i);
+    }
+    if (offset == 0) {
+        for (uint64_t *prev = &_free_lists[kLists - 1]; *prev != 0; prev = &NextFree(_Base() + *prev + sizeof(block))) {
+            block *b = _Block(*prev);
+            if (b->size == size || b->size >= size + sizeof(block) + kAlign) {
+                offset = *prev;
+                *prev = NextFree(_Base() + offset + sizeof(block));
+                _free_bytes -= sizeof(block) + b->size;
+                break;
+            }
+        }
+    }
+    if (offset == 0) {
+        return 0;
+    }
+
+    block *b = _Block(offset);
+    if (b->size > size) {
+        const uint64_t rest = offset + sizeof(block) + size;
+        _Block(rest)->size = b->size - size - sizeof(block);
+        b->size = size;
+        _Release(rest);
+    }
+    return offset;
+}
+
+// See Relocatable.h
+void Relocatable::_Release(uint64_t offset) {
+    block *b = _Block(offset);
+    const std::size_t list = b->size <= kSmall ? b->size / kAlign - 1 : kLists - 1;
+    b->handle = 0;
+    NextFree(_Base() + offset + sizeof(block)) = _free_lists[list];
+    _free_lists[list] = offset;
+    _free_bytes += sizeof(block) + b->size;
+}
+
+// See Relocatable.h
+uint64_t Relocatable::_Take(std::size_t list) {
+    const uint64_t offset = _free_lists[list];
+    if (offset != 0) {
+        _free_lists[list] = NextFree(_Base() + offset + sizeof(block));
+        _free_bytes -= sizeof(block) + _Block(offset)->size;
+    }
+    return offset;
+}
+
+// See Relocatable.h
+Relocatable::Handle Relocatable::_AllocHandle() {
+    if (_free_handle != 0) {
+        const Handle h = _free_handle;
+        _free_handle = static_cast<Handle>(*_Descriptor(h) >> 1);
+        return h;
+    }
+
+    if (_TableBegin() - _blocks_end < sizeof(uint64_t) || _handles == UINT32_MAX) {
+        return 0;
+    }
+    _handles++;
+    return static_cast<Handle>(_handles);
+}
+
+} // namespace Allocator
+} // namespace Afina
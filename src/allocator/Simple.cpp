@@ -1,40 +1,281 @@
 #include <afina/allocator/Simple.h>
 
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+
+#include <afina/allocator/Error.h>
 #include <afina/allocator/Pointer.h>
 
 namespace Afina {
 namespace Allocator {
 
-Simple::Simple(void *base, size_t size) : _base(base), _base_len(size) {}
-
 /**
- * TODO: semantics
- * @param N size_t
+ * Block header, block data follows it immediately
  */
-Pointer Simple::alloc(size_t N) { return Pointer(); }
+struct Simple::block {
+    // Size of the data, multiple of kAlign
+    size_t size;
 
-/**
- * TODO: semantics
- * @param p Pointer
- * @param N size_t
- */
-void Simple::realloc(Pointer &p, size_t N) {}
+    // Descriptor refers to the block, nullptr for the free one
+    void **slot;
+};
 
-/**
- * TODO: semantics
- * @param p Pointer
- */
-void Simple::free(Pointer &p) {}
+namespace {
 
-/**
- * TODO: semantics
- */
-void Simple::defrag() {}
+const size_t kAlign = alignof(std::max_align_t);
 
-/**
- * TODO: semantics
- */
-std::string Simple::dump() const { return ""; }
+size_t AlignUp(size_t n) { return (n + kAlign - 1) & ~(kAlign - 1); }
+
+// Header size keeps block data aligned
+const size_t kHeader = AlignUp(sizeof(size_t) + sizeof(void *));
+
+char *AreaBegin(void *base) { return reinterpret_cast<char *>(AlignUp(reinterpret_cast<uintptr_t>(base))); }
+
+char *AreaEnd(void *base, size_t size) {
+    uintptr_t begin = AlignUp(reinterpret_cast<uintptr_t>(base));
+    uintptr_t end = (reinterpret_cast<uintptr_t>(base) + size) & ~(sizeof(void *) - 1);
+    return reinterpret_cast<char *>(end < begin ? begin : end);
+}
+
+} // namespace
+
+// See Simple.h
+Simple::Simple(void *base, size_t size)
+    : _base(AreaBegin(base)), _base_len(AreaEnd(base, size) - _base), _blocks_end(_base),
+      _slots_end(reinterpret_cast<void **>(_base + _base_len)), _slots_count(0) {}
+
+// See Simple.h
+Pointer Simple::alloc(size_t N) {
+    void **slot = _AllocSlot();
+    if (slot == nullptr) {
+        throw AllocError(AllocErrorType::NoMemory, "No space for block descriptor");
+    }
+
+    block *b = _AllocBlock(AlignUp(N));
+    if (b == nullptr) {
+        _FreeSlot(slot);
+        throw AllocError(AllocErrorType::NoMemory, "No free block of " + std::to_string(N) + " bytes");
+    }
+
+    b->slot = slot;
+    *slot = reinterpret_cast<char *>(b) + kHeader;
+    return Pointer(slot);
+}
+
+// See Simple.h
+void Simple::realloc(Pointer &p, size_t N) {
+    if (p._slot == nullptr) {
+        p = alloc(N);
+        return;
+    }
+
+    block *b = _Block(p._slot);
+    const size_t size = AlignUp(N);
+    if (size <= b->size) {
+        _Split(b, size);
+        return;
+    }
+
+    // Try to grow in place: absorb free neighbours, or move the end of the area if block is the last one
+    _Merge(b);
+    char *data = reinterpret_cast<char *>(b) + kHeader;
+    if (data + b->size == _blocks_end && data + size <= reinterpret_cast<char *>(_slots_end - _slots_count)) {
+        b->size = size;
+        _blocks_end = data + size;
+        return;
+    }
+    if (size <= b->size) {
+        _Split(b, size);
+        return;
+    }
+
+    block *nb = _AllocBlock(size);
+    if (nb == nullptr) {
+        throw AllocError(AllocErrorType::NoMemory, "No free block of " + std::to_string(N) + " bytes");
+    }
+
+    char *ndata = reinterpret_cast<char *>(nb) + kHeader;
+    std::memcpy(ndata, data, b->size);
+    nb->slot = p._slot;
+    *p._slot = ndata;
+    _FreeBlock(b);
+}
+
+// See Simple.h
+void Simple::free(Pointer &p) {
+    if (p._slot == nullptr) {
+        return;
+    }
+
+    block *b = _Block(p._slot);
+    _FreeBlock(b);
+    _FreeSlot(p._slot);
+    p._slot = nullptr;
+}
+
+// See Simple.h
+void Simple::defrag() {
+    char *dst = _base;
+    for (char *cur = _base; cur < _blocks_end;) {
+        block *b = reinterpret_cast<block *>(cur);
+        const size_t len = kHeader + b->size;
+        const bool used = b->slot != nullptr;
+        cur += len;
+
+        if (!used) {
+            continue;
+        }
+
+        if (reinterpret_cast<char *>(b) != dst) {
+            std::memmove(dst, b, len);
+            b = reinterpret_cast<block *>(dst);
+            *b->slot = dst + kHeader;
+        }
+        dst += len;
+    }
+    _blocks_end = dst;
+}
+
+// See Simple.h
+std::string Simple::dump() const {
+    size_t used = 0, blocks = 0;
+    std::stringstream out;
+    for (char *cur = _base; cur < _blocks_end; cur += kHeader + reinterpret_cast<block *>(cur)->size) {
+        const block *b = reinterpret_cast<block *>(cur);
+        out << (cur - _base) << "\t" << b->size << "\t" << (b->slot != nullptr ? "used" : "free") << "\n";
+        if (b->slot != nullptr) {
+            used += b->size;
+        }
+        blocks++;
+    }
+
+    std::stringstream head;
+    head << "total " << _base_len << ", used " << used << ", blocks " << blocks << ", descriptors " << _slots_count
+         << ", unmapped " << (reinterpret_cast<char *>(_slots_end - _slots_count) - _blocks_end) << "\n";
+    return head.str() + out.str();
+}
+
+// See Simple.h
+void **Simple::_AllocSlot() {
+    void **first = _slots_end - _slots_count;
+    for (void **slot = first; slot < _slots_end; slot++) {
+        if (*slot == nullptr) {
+            return slot;
+        }
+    }
+
+    // Table grows towards blocks
+    if (reinterpret_cast<char *>(first - 1) < _blocks_end) {
+        return nullptr;
+    }
+    _slots_count++;
+    *(first - 1) = nullptr;
+    return first - 1;
+}
+
+// See Simple.h
+Simple::block *Simple::_AllocBlock(size_t size) {
+    // First fit, coalescing free blocks along the way
+    for (char *cur = _base; cur < _blocks_end; cur += kHeader + reinterpret_cast<block *>(cur)->size) {
+        block *b = reinterpret_cast<block *>(cur);
+        if (b->slot != nullptr) {
+            continue;
+        }
+
+        _Merge(b);
+        if (cur + kHeader + b->size == _blocks_end) {
+            // Free tail, give it back to the unallocated space
+            _blocks_end = cur;
+            break;
+        }
+
+        if (b->size >= size) {
+            _Split(b, size);
+            return b;
+        }
+    }
+
+    char *limit = reinterpret_cast<char *>(_slots_end - _slots_count);
+    if (static_cast<size_t>(limit - _blocks_end) < kHeader + size) {
+        return nullptr;
+    }
+
+    block *b = reinterpret_cast<block *>(_blocks_end);
+    b->size = size;
+    b->slot = nullptr;
+    _blocks_end += kHeader + size;
+    return b;
+}
+
+// See Simple.h
+void Simple::_Split(block *b, size_t size) {
+    char *data = reinterpret_cast<char *>(b) + kHeader;
+    if (data + b->size == _blocks_end) {
+        b->size = size;
+        _blocks_end = data + size;
+        return;
+    }
+
+    if (b->size < size + kHeader + kAlign) {
+        return;
+    }
+
+    block *rest = reinterpret_cast<block *>(data + size);
+    rest->size = b->size - size - kHeader;
+    rest->slot = nullptr;
+    b->size = size;
+    _Merge(rest);
+}
+
+// See Simple.h
+void Simple::_Merge(block *b) {
+    char *next = reinterpret_cast<char *>(b) + kHeader + b->size;
+    while (next < _blocks_end) {
+        block *n = reinterpret_cast<block *>(next);
+        if (n->slot != nullptr) {
+            break;
+        }
+        b->size += kHeader + n->size;
+        next += kHeader + n->size;
+    }
+}
+
+// See Simple.h
+Simple::block *Simple::_Block(void **slot) const {
+    if (slot < _slots_end - _slots_count || slot >= _slots_end || *slot == nullptr) {
+        throw AllocError(AllocErrorType::InvalidFree, "Pointer doesn't refer to allocated block");
+    }
+
+    block *b = reinterpret_cast<block *>(static_cast<char *>(*slot) - kHeader);
+    if (b->slot != slot) {
+        throw AllocError(AllocErrorType::InvalidFree, "Pointer doesn't refer to allocated block");
+    }
+    return b;
+}
+
+// See Simple.h
+void Simple::_FreeBlock(block *b) {
+    b->slot = nullptr;
+    _Merge(b);
+
+    char *cur = reinterpret_cast<char *>(b);
+    if (cur + kHeader + b->size == _blocks_end) {
+        _blocks_end = cur;
+    }
+}
+
+// See Simple.h
+void Simple::_FreeSlot(void **slot) {
+    *slot = nullptr;
+
+    // Drop free descriptors from the table edge, so blocks could use that space
+    void **first = _slots_end - _slots_count;
+    while (_slots_count > 0 && *first == nullptr) {
+        first++;
+        _slots_count--;
+    }
+}
 
 } // namespace Allocator
 } // namespace Afina
@@ -0,0 +1,309 @@
+#include <afina/allocator/Slab.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <afina/allocator/Error.h>
+
+namespace Afina {
+namespace Allocator {
+
+namespace {
+
+const std::size_t kAlign = sizeof(void *);
+
+// Sizes up to that one get class by the table lookup
+const std::size_t kSmallSize = 1024;
+
+std::size_t AlignUp(std::size_t n) { return (n + kAlign - 1) & ~(kAlign - 1); }
+
+// Size of huge page on x86-64
+const std::size_t kHugePage = 2 << 20;
+
+// Returns true if transparent huge pages could be used via madvise
+bool TransparentHugePages() {
+    std::ifstream enabled("/sys/kernel/mm/transparent_hugepage/enabled");
+    std::string mode((std::istreambuf_iterator<char>(enabled)), std::istreambuf_iterator<char>());
+    return !mode.empty() && mode.find("[never]") == std::string::npos;
+}
+
+/**
+ * Maps area of at least size bytes, huge pages are tried first if requested. Returns nullptr on failure,
+ * mapped length and size of memory pages backing the area are reported through out parameters
+ */
+char *MapArea(std::size_t size, bool huge_pages, std::size_t &mapped, std::size_t &page_size) {
+    const int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+    page_size = sysconf(_SC_PAGESIZE);
+
+    if (huge_pages) {
+        mapped = (size + kHugePage - 1) & ~(kHugePage - 1);
+
+#ifdef MAP_HUGETLB
+        // Huge pages get reserved up front, otherwise mapping succeeds without them and first touch faults
+        void *huge = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (huge != MAP_FAILED) {
+            page_size = kHugePage;
+            return static_cast<char *>(huge);
+        }
+#endif
+
+#ifdef MADV_HUGEPAGE
+        // Over map to align area on the huge page boundary, otherwise its edges can't be backed by huge pages
+        void *raw = mmap(nullptr, mapped + kHugePage, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (raw == MAP_FAILED) {
+            return nullptr;
+        }
+
+        char *begin = static_cast<char *>(raw);
+        char *base = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(begin) + kHugePage - 1) & ~(kHugePage - 1));
+        if (base > begin) {
+            munmap(begin, base - begin);
+        }
+        munmap(base + mapped, begin + mapped + kHugePage - (base + mapped));
+
+        if (madvise(base, mapped, MADV_HUGEPAGE) == 0 && TransparentHugePages()) {
+            page_size = kHugePage;
+        }
+        return base;
+#endif
+    }
+
+    mapped = size;
+    void *base = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, flags, -1, 0);
+    return base == MAP_FAILED ? nullptr : static_cast<char *>(base);
+}
+
+} // namespace
+
+const unsigned Slab::kNoClass;
+
+// See Slab.h
+Slab::Slab(std::size_t max_size, std::size_t page_size, std::size_t min_chunk, double factor, bool huge_pages)
+    : _base(nullptr), _mapped(0), _memory_page_size(0), _page_size(page_size), _pages_touched(0) {
+    if (factor <= 1.0) {
+        throw std::invalid_argument("Slab growth factor must be greater than 1");
+    }
+
+    // Small area is a single page
+    _page_size = AlignUp(std::min(page_size, max_size));
+    min_chunk = AlignUp(std::max(min_chunk, kAlign));
+    if (_page_size < min_chunk) {
+        throw std::invalid_argument("Slab area is too small");
+    }
+
+    for (std::size_t size = min_chunk; size <= _page_size / 2;) {
+        size_class c;
+        c.size = size;
+        c.per_page = _page_size / size;
+        c.stats.chunk_size = c.size;
+        c.stats.per_page = c.per_page;
+        _classes.push_back(c);
+
+        size = std::max(AlignUp(static_cast<std::size_t>(size * factor)), size + kAlign);
+    }
+
+    // The largest class takes the whole page
+    size_class last;
+    last.size = _page_size;
+    last.per_page = 1;
+    last.stats.chunk_size = last.size;
+    last.stats.per_page = last.per_page;
+    _classes.push_back(last);
+
+    for (std::size_t words = 0; words <= kSmallSize / kAlign; words++) {
+        unsigned cls = 0;
+        while (cls < _classes.size() && _classes[cls].size < words * kAlign) {
+            cls++;
+        }
+        _small_classes.push_back(cls < _classes.size() ? cls : kNoClass);
+    }
+
+    std::size_t pages = max_size / _page_size;
+    _base = MapArea(pages * _page_size, huge_pages, _mapped, _memory_page_size);
+    if (_base == nullptr) {
+        throw std::runtime_error("Failed to map slab area");
+    }
+    _pages.resize(pages);
+}
+
+// See Slab.h
+Slab::~Slab() { munmap(_base, _mapped); }
+
+// See Slab.h
+unsigned Slab::class_of(std::size_t size) const {
+    if (size <= kSmallSize) {
+        return _small_classes[(size + kAlign - 1) / kAlign];
+    }
+
+    auto it = std::lower_bound(_classes.begin(), _classes.end(), size,
+                               [](const size_class &c, std::size_t size) { return c.size < size; });
+    if (it == _classes.end()) {
+        return kNoClass;
+    }
+    return static_cast<unsigned>(it - _classes.begin());
+}
+
+// See Slab.h
+void *Slab::alloc(std::size_t size) {
+    unsigned cls = class_of(size);
+    if (cls == kNoClass) {
+        return nullptr;
+    }
+
+    size_class &c = _classes[cls];
+    page *p = c.partial;
+    if (p != nullptr && p == c.empty && p->next != nullptr) {
+        // Keep empty page intact while possible, so it could be reassigned
+        p = p->next;
+    }
+    if (p == nullptr) {
+        p = _TakePage(cls);
+        if (p == nullptr) {
+            c.stats.fails++;
+            return nullptr;
+        }
+    }
+
+    void *chunk;
+    if (p->free_list != nullptr) {
+        chunk = p->free_list;
+        p->free_list = *static_cast<void **>(chunk);
+    } else {
+        chunk = _PageBase(p) + p->carved * c.size;
+        p->carved++;
+    }
+
+    if (p == c.empty) {
+        c.empty = nullptr;
+    }
+    if (++p->used == c.per_page) {
+        _Unlink(c, p);
+    }
+
+    c.stats.used++;
+    c.stats.free--;
+    c.stats.allocs++;
+    return chunk;
+}
+
+// See Slab.h
+void Slab::free(void *ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+
+    char *chunk = static_cast<char *>(ptr);
+    if (!owns(chunk)) {
+        throw AllocError(AllocErrorType::InvalidFree, "Pointer doesn't belong to slab area");
+    }
+
+    page *p = &_pages[(chunk - _base) / _page_size];
+    if (p->cls == kNoClass || p->used == 0) {
+        throw AllocError(AllocErrorType::InvalidFree, "Pointer refers to free page");
+    }
+
+    size_class &c = _classes[p->cls];
+    *reinterpret_cast<void **>(chunk) = p->free_list;
+    p->free_list = chunk;
+
+    if (p->used-- == c.per_page) {
+        _Link(c, p);
+    }
+    c.stats.used--;
+    c.stats.free++;
+
+    if (p->used == 0) {
+        if (c.empty == nullptr) {
+            c.empty = p;
+        } else {
+            _ReleasePage(p);
+        }
+    }
+}
+
+// See Slab.h
+Slab::Stats Slab::stats(unsigned cls) const { return _classes.at(cls).stats; }
+
+// See Slab.h
+Slab::page *Slab::_TakePage(unsigned cls) {
+    page *p = nullptr;
+    if (!_free_pages.empty()) {
+        p = _free_pages.back();
+        _free_pages.pop_back();
+    } else if (_pages_touched < _pages.size()) {
+        p = &_pages[_pages_touched++];
+    } else {
+        // Reassign empty page of another class
+        for (size_class &other : _classes) {
+            if (other.empty != nullptr && &other != &_classes[cls]) {
+                p = other.empty;
+                _ReleasePage(p);
+                _free_pages.pop_back();
+                _classes[cls].stats.reassigned++;
+                break;
+            }
+        }
+        if (p == nullptr) {
+            return nullptr;
+        }
+    }
+
+    size_class &c = _classes[cls];
+    p->cls = cls;
+    p->used = 0;
+    p->carved = 0;
+    p->free_list = nullptr;
+    _Link(c, p);
+
+    c.stats.pages++;
+    c.stats.free += c.per_page;
+    return p;
+}
+
+// See Slab.h
+void Slab::_ReleasePage(page *p) {
+    size_class &c = _classes[p->cls];
+    _Unlink(c, p);
+    if (c.empty == p) {
+        c.empty = nullptr;
+    }
+
+    c.stats.pages--;
+    c.stats.free -= c.per_page;
+
+    p->cls = kNoClass;
+    p->free_list = nullptr;
+    _free_pages.push_back(p);
+}
+
+// See Slab.h
+void Slab::_Link(size_class &c, page *p) {
+    p->prev = nullptr;
+    p->next = c.partial;
+    if (c.partial != nullptr) {
+        c.partial->prev = p;
+    }
+    c.partial = p;
+}
+
+// See Slab.h
+void Slab::_Unlink(size_class &c, page *p) {
+    if (p->prev != nullptr) {
+        p->prev->next = p->next;
+    } else {
+        c.partial = p->next;
+    }
+    if (p->next != nullptr) {
+        p->next->prev = p->prev;
+    }
+    p->prev = p->next = nullptr;
+}
+
+} // namespace Allocator
+} // namespace Afina
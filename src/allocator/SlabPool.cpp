@@ -0,0 +1,261 @@
+#include <afina/allocator/SlabPool.h>
+
+#include <algorithm>
+#include <set>
+
+#include <afina/allocator/Error.h>
+
+namespace Afina {
+namespace Allocator {
+
+namespace {
+
+// Bytes thread could cache per class
+const std::size_t kCacheBytes = 256 << 10;
+
+// Upper bound of chunks thread could cache per class
+const std::size_t kCacheChunks = 64;
+
+// Pools alive, protected by the mutex
+std::mutex pools_mutex;
+std::set<uint64_t> pools;
+std::atomic<uint64_t> next_pool_id(1);
+
+void *&Next(void *chunk) { return *static_cast<void **>(chunk); }
+
+} // namespace
+
+/**
+ * Caches of the thread in all pools it used
+ */
+struct SlabPool::thread_caches {
+    struct entry {
+        uint64_t id;
+        SlabPool *pool;
+        cache *c;
+    };
+
+    std::vector<entry> entries;
+
+    ~thread_caches() {
+        std::lock_guard<std::mutex> lock(pools_mutex);
+        for (entry &e : entries) {
+            if (pools.count(e.id) == 0) {
+                continue;
+            }
+
+            e.pool->_Flush(e.c);
+
+            std::lock_guard<std::mutex> pool_lock(e.pool->_mutex);
+            auto &caches = e.pool->_caches;
+            for (auto it = caches.begin(); it != caches.end(); it++) {
+                if (it->get() == e.c) {
+                    caches.erase(it);
+                    break;
+                }
+            }
+        }
+    }
+};
+
+// See SlabPool.h
+SlabPool::SlabPool(std::size_t max_size, std::size_t page_size, std::size_t min_chunk, double factor,
+                   bool huge_pages)
+    : _id(next_pool_id++), _slab(max_size, page_size, min_chunk, factor, huge_pages) {
+    _limits.resize(_slab.classes());
+    _remote.reset(new std::atomic<void *>[_slab.classes()]);
+    for (unsigned cls = 0; cls < _slab.classes(); cls++) {
+        _limits[cls] = std::min(kCacheChunks, kCacheBytes / _slab.chunk_size(cls));
+        _remote[cls].store(nullptr);
+    }
+
+    std::lock_guard<std::mutex> lock(pools_mutex);
+    pools.insert(_id);
+}
+
+// See SlabPool.h
+SlabPool::~SlabPool() {
+    std::lock_guard<std::mutex> lock(pools_mutex);
+    pools.erase(_id);
+}
+
+// See SlabPool.h
+void *SlabPool::alloc(std::size_t size) {
+    unsigned cls = _slab.class_of(size);
+    if (cls == Slab::kNoClass) {
+        return nullptr;
+    }
+
+    if (_limits[cls] == 0) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        void *p = _slab.alloc(size);
+        if (p == nullptr) {
+            _DrainRemote();
+            p = _slab.alloc(size);
+        }
+        return p;
+    }
+
+    bin &b = _Cache()->bins[cls];
+    if (b.head == nullptr) {
+        return _Refill(b, cls);
+    }
+
+    void *p = b.head;
+    b.head = Next(p);
+    b.count--;
+    return p;
+}
+
+// See SlabPool.h
+void SlabPool::free(void *p) {
+    if (p == nullptr) {
+        return;
+    }
+    if (!_slab.owns(p)) {
+        throw AllocError(AllocErrorType::InvalidFree, "Pointer doesn't belong to slab area");
+    }
+
+    unsigned cls = _slab.chunk_class(p);
+    const std::size_t limit = _limits[cls];
+    if (limit == 0) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _slab.free(p);
+        return;
+    }
+
+    bin &b = _Cache()->bins[cls];
+    Next(p) = b.head;
+    b.head = p;
+    if (++b.count <= limit) {
+        return;
+    }
+
+    // Cache overflowed, keep half of it and give the rest away
+    const std::size_t keep = limit / 2;
+    void *head = b.head;
+    if (keep > 0) {
+        void *last = b.head;
+        for (std::size_t i = 1; i < keep; i++) {
+            last = Next(last);
+        }
+        head = Next(last);
+        Next(last) = nullptr;
+    } else {
+        b.head = nullptr;
+    }
+    b.count = keep;
+
+    void *tail = head;
+    while (Next(tail) != nullptr) {
+        tail = Next(tail);
+    }
+    _PushRemote(cls, head, tail);
+}
+
+// See SlabPool.h
+void SlabPool::flush() { _Flush(_Cache()); }
+
+// See SlabPool.h
+Slab::Stats SlabPool::stats(unsigned cls) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _slab.stats(cls);
+}
+
+// See SlabPool.h
+SlabPool::cache *SlabPool::_Cache() {
+    static thread_local thread_caches caches;
+    for (thread_caches::entry &e : caches.entries) {
+        if (e.id == _id) {
+            return e.c;
+        }
+    }
+
+    std::unique_ptr<cache> c(new cache);
+    c->bins.resize(_slab.classes());
+
+    thread_caches::entry e;
+    e.id = _id;
+    e.pool = this;
+    e.c = c.get();
+    caches.entries.push_back(e);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _caches.push_back(std::move(c));
+    return e.c;
+}
+
+// See SlabPool.h
+void *SlabPool::_Refill(bin &b, unsigned cls) {
+    void *head = _remote[cls].exchange(nullptr, std::memory_order_acquire);
+    if (head == nullptr) {
+        const std::size_t size = _slab.chunk_size(cls);
+        const std::size_t batch = std::max<std::size_t>(_limits[cls] / 2, 1);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (std::size_t i = 0; i < batch; i++) {
+            void *p = _slab.alloc(size);
+            if (p == nullptr && head == nullptr) {
+                _DrainRemote();
+                p = _slab.alloc(size);
+            }
+            if (p == nullptr) {
+                break;
+            }
+            Next(p) = head;
+            head = p;
+        }
+
+        if (head == nullptr) {
+            return nullptr;
+        }
+    }
+
+    void *p = head;
+    b.head = Next(p);
+    for (void *it = b.head; it != nullptr; it = Next(it)) {
+        b.count++;
+    }
+    return p;
+}
+
+// See SlabPool.h
+void SlabPool::_PushRemote(unsigned cls, void *head, void *tail) {
+    void *old = _remote[cls].load(std::memory_order_relaxed);
+    do {
+        Next(tail) = old;
+    } while (!_remote[cls].compare_exchange_weak(old, head, std::memory_order_release, std::memory_order_relaxed));
+}
+
+// See SlabPool.h
+void SlabPool::_DrainRemote() {
+    for (unsigned cls = 0; cls < _slab.classes(); cls++) {
+        void *head = _remote[cls].exchange(nullptr, std::memory_order_acquire);
+        while (head != nullptr) {
+            void *next = Next(head);
+            _slab.free(head);
+            head = next;
+        }
+    }
+}
+
+// See SlabPool.h
+void SlabPool::_Flush(cache *c) {
+    for (unsigned cls = 0; cls < c->bins.size(); cls++) {
+        bin &b = c->bins[cls];
+        if (b.head == nullptr) {
+            continue;
+        }
+
+        void *tail = b.head;
+        while (Next(tail) != nullptr) {
+            tail = Next(tail);
+        }
+        _PushRemote(cls, b.head, tail);
+        b.head = nullptr;
+        b.count = 0;
+    }
+}
+
+} // namespace Allocator
+} // namespace Afina
@@ -7,13 +7,120 @@
 namespace Afina {
 namespace Coroutine {
 
-void Engine::Store(context &ctx) {}
+namespace {
 
-void Engine::Restore(context &ctx) {}
+// How many completed contexts engine keeps for reuse
+const std::size_t kMaxFreeContexts = 1024;
 
-void Engine::yield() {}
+} // namespace
 
-void Engine::sched(void *routine_) {}
+Engine::~Engine() {
+    while (free_ctx != nullptr) {
+        context *next = free_ctx->next;
+        delete free_ctx;
+        free_ctx = next;
+    }
+}
+
+void Engine::Store(context &ctx) {
+    char StackEndsHere;
+    if (&StackEndsHere < StackBottom) {
+        ctx.Low = &StackEndsHere;
+        ctx.Hight = StackBottom;
+    } else {
+        ctx.Low = StackBottom;
+        ctx.Hight = &StackEndsHere;
+    }
+
+    std::size_t size = ctx.Hight - ctx.Low;
+    char *&buffer = std::get<0>(ctx.Stack);
+    uint32_t &capacity = std::get<1>(ctx.Stack);
+    if (capacity < size) {
+        stack_pool.Release(buffer, capacity);
+        buffer = stack_pool.Acquire(size, capacity);
+        if (buffer == nullptr) {
+            capacity = 0;
+            throw std::bad_alloc();
+        }
+    }
+
+    memcpy(buffer, ctx.Low, size);
+}
+
+void Engine::Restore(context &ctx) {
+    // Saved stack must be copied into the place where it was, so move current frame below it first
+    volatile char StackEndsHere[64];
+    if (ctx.Low <= StackEndsHere + sizeof(StackEndsHere) && (char *)StackEndsHere <= ctx.Hight) {
+        Restore(ctx);
+    }
+
+    memcpy(ctx.Low, std::get<0>(ctx.Stack), ctx.Hight - ctx.Low);
+    longjmp(ctx.Environment, 1);
+}
+
+void Engine::yield() {
+    // Round robin starting from the routine next to the current one
+    context *next = (cur_routine != nullptr && cur_routine != idle_ctx) ? cur_routine->next : alive;
+    if (next == nullptr) {
+        next = alive;
+    }
+
+    if (next == nullptr || next == cur_routine) {
+        return;
+    }
+    sched(next);
+}
+
+void Engine::sched(void *routine_) {
+    context *routine = static_cast<context *>(routine_);
+    if (routine == nullptr) {
+        yield();
+        return;
+    }
+
+    if (routine == cur_routine) {
+        return;
+    }
+
+    if (cur_routine != nullptr && cur_routine != idle_ctx) {
+        if (setjmp(cur_routine->Environment) > 0) {
+            return;
+        }
+        Store(*cur_routine);
+    }
+
+    cur_routine = routine;
+    Restore(*routine);
+}
+
+Engine::context *Engine::NewContext() {
+    if (free_ctx == nullptr) {
+        return new context();
+    }
+
+    context *ctx = free_ctx;
+    free_ctx = ctx->next;
+    free_ctx_size--;
+
+    ctx->next = nullptr;
+    return ctx;
+}
+
+void Engine::FreeContext(context *ctx) {
+    stack_pool.Release(std::get<0>(ctx->Stack), std::get<1>(ctx->Stack));
+    ctx->Stack = std::make_tuple(nullptr, 0);
+    ctx->Low = ctx->Hight = nullptr;
+    ctx->prev = nullptr;
+
+    if (free_ctx_size >= kMaxFreeContexts) {
+        delete ctx;
+        return;
+    }
+
+    ctx->next = free_ctx;
+    free_ctx = ctx;
+    free_ctx_size++;
+}
 
 } // namespace Coroutine
 } // namespace Afina
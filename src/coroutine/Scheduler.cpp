@@ -0,0 +1,743 @@
+#include <afina/coroutine/Scheduler.h>
+
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <deque>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Coroutine {
+
+namespace {
+
+/**
+ * Saved registers of the routine or scheduler loop. Control goes from one stack to another, longjmp must not be
+ * used for that: it is allowed only to unwind the current stack, _FORTIFY_SOURCE build aborts such jump
+ */
+#if defined(__x86_64__)
+struct context {
+    // Callee saved registers are pushed on the stack, only stack pointer is kept here
+    void *sp = nullptr;
+};
+
+extern "C" void afina_scheduler_switch(void **save_sp, void *sp);
+
+// Saves registers of the caller into save_sp, restores ones saved in sp and returns where they were saved
+asm(R"(
+    .pushsection .text
+    .globl afina_scheduler_switch
+    .hidden afina_scheduler_switch
+    .type afina_scheduler_switch, @function
+afina_scheduler_switch:
+    pushq %rbp
+    pushq %rbx
+    pushq %r12
+    pushq %r13
+    pushq %r14
+    pushq %r15
+    subq $8, %rsp
+    stmxcsr (%rsp)
+    fnstcw 4(%rsp)
+    movq %rsp, (%rdi)
+
+    movq %rsi, %rsp
+    ldmxcsr (%rsp)
+    fldcw 4(%rsp)
+    addq $8, %rsp
+    popq %r15
+    popq %r14
+    popq %r13
+    popq %r12
+    popq %rbx
+    popq %rbp
+    ret
+    .size afina_scheduler_switch, .-afina_scheduler_switch
+    .popsection
+)");
+
+// Prepares stack so that switching to it calls entry, which must never return
+void MakeContext(context &ctx, char *stack, std::size_t size, void (*entry)()) {
+    // Frame in the same layout as afina_scheduler_switch leaves: control words, six registers, return address
+    uintptr_t top = (reinterpret_cast<uintptr_t>(stack) + size) & ~uintptr_t(15);
+    uint64_t *frame = reinterpret_cast<uint64_t *>(top) - 9;
+
+    // Default MXCSR and x87 control word
+    frame[0] = 0x1F80 | (uint64_t(0x037F) << 32);
+    std::memset(&frame[1], 0, 6 * sizeof(uint64_t));
+    frame[7] = reinterpret_cast<uint64_t>(entry);
+
+    // Entry gets the stack aligned as after a call, return address of zero ends unwinding
+    frame[8] = 0;
+    ctx.sp = frame;
+}
+
+// Saves current registers into from and continues execution saved in to
+inline void SwitchContext(context &from, context &to) { afina_scheduler_switch(&from.sp, to.sp); }
+#else
+struct context {
+    ucontext_t uc;
+};
+
+// See x86_64 version
+void MakeContext(context &ctx, char *stack, std::size_t size, void (*entry)()) {
+    getcontext(&ctx.uc);
+    ctx.uc.uc_stack.ss_sp = stack;
+    ctx.uc.uc_stack.ss_size = size;
+    ctx.uc.uc_link = nullptr;
+    makecontext(&ctx.uc, entry, 0);
+}
+
+// See x86_64 version, here it costs a syscall to save signal mask
+inline void SwitchContext(context &from, context &to) { swapcontext(&from.uc, &to.uc); }
+#endif
+
+} // namespace
+
+/**
+ * Single routine: its own stack and saved registers
+ */
+struct Scheduler::task {
+    enum class State {
+        // Routine is in some run queue
+        kRunnable,
+
+        // Routine is executing on some thread
+        kRunning,
+
+        // Routine asked to be suspended, but still executes on its stack
+        kParking,
+
+        // Routine is suspended until wake
+        kParked,
+
+        // Routine finished execution, its stack could be released
+        kDone
+    };
+
+    Scheduler *owner = nullptr;
+    std::function<void()> body;
+
+    // Stack memory, lowest page is a guard one
+    char *stack = nullptr;
+    uint32_t stack_capacity = 0;
+
+    // Saved routine registers, valid once started
+    context environment;
+    bool started = false;
+
+    // Changed by the thread executing the routine, or under the lock passed to park
+    State state = State::kRunnable;
+
+    // Lock to release once routine is suspended, see park
+    std::mutex *unlock = nullptr;
+};
+
+/**
+ * OS thread running routines
+ */
+struct Scheduler::worker {
+    Scheduler *owner = nullptr;
+    std::size_t index = 0;
+    std::thread thread;
+
+    // Runnable routines, owner takes from the front, thieves from the back
+    std::mutex queue_mutex;
+    std::deque<task *> queue;
+
+    // Scheduler loop registers, routine switches here once it gives up control
+    context environment;
+
+    // Routine that is executing on this thread now
+    task *current = nullptr;
+
+    std::atomic<uint64_t> switches{0};
+    std::atomic<uint64_t> stolen{0};
+};
+
+/**
+ * Routine waiting for timer or IO, lives on the routine stack
+ */
+struct Scheduler::waiter {
+    // Deadline, active only if wait has timeout
+    TimerWheel::timer timer;
+
+    void *routine = nullptr;
+
+    // Descriptor to wait for, -1 for sleep
+    int fd = -1;
+
+    // Distinguishes this wait from previous ones on the same descriptor
+    uint32_t generation = 0;
+
+    // Events happened, 0 on timeout
+    uint32_t events = 0;
+
+    // Set once routine is woken up
+    bool done = false;
+};
+
+namespace {
+
+// Worker of the current thread, nullptr outside of scheduler
+thread_local void *t_worker = nullptr;
+
+// Page protected against stack overflow
+const std::size_t kGuardSize = 4096;
+
+// Epoll data of the event fd, no descriptor could have such value
+const uint64_t kEventFdData = UINT64_MAX;
+
+// Busy thread polls once per this number of routine switches
+const uint64_t kPollInterval = 64;
+
+// Max time idle thread sleeps for, milliseconds
+const int kIdleTimeout = 100;
+
+} // namespace
+
+// See Scheduler.h
+Scheduler::Scheduler(std::size_t threads, std::size_t stack_size, std::size_t max_stack_bytes, bool pin_threads)
+    : _stack_size(stack_size), _pin_threads(pin_threads), _stack_pool(max_stack_bytes, max_stack_bytes / 4),
+      _sleeping(0), _next_queue(0), _alive(0), _polling(false), _epoll_fd(-1), _event_fd(-1), _io_generation(0),
+      _epoch(std::chrono::steady_clock::now()), _stopping(false), _started(false), _spawned(0), _completed(0) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    if (stack_size <= kGuardSize) {
+        throw std::runtime_error("Routine stack is too small");
+    }
+
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll_fd == -1) {
+        throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
+    }
+
+    _event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_event_fd == -1) {
+        close(_epoll_fd);
+        throw std::runtime_error("Failed to create event file descriptor: " + std::string(strerror(errno)));
+    }
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = kEventFdData;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _event_fd, &event)) {
+        close(_event_fd);
+        close(_epoll_fd);
+        throw std::runtime_error("Failed to add eventfd descriptor to epoll");
+    }
+
+    _workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; i++) {
+        _workers.emplace_back(new worker());
+        _workers.back()->owner = this;
+        _workers.back()->index = i;
+    }
+}
+
+// See Scheduler.h
+Scheduler::~Scheduler() {
+    if (_started) {
+        Stop();
+        Join();
+    }
+
+    // Routines that never got started
+    for (auto &w : _workers) {
+        for (task *t : w->queue) {
+            Destroy(t);
+        }
+        w->queue.clear();
+    }
+
+    close(_event_fd);
+    close(_epoll_fd);
+}
+
+// See Scheduler.h
+void Scheduler::Start() {
+    assert(!_started);
+    _started = true;
+
+    for (auto &w : _workers) {
+        worker *pw = w.get();
+        pw->thread = std::thread(&Scheduler::OnRun, this, pw);
+    }
+}
+
+// See Scheduler.h
+void Scheduler::Stop() {
+    _stopping.store(true);
+    eventfd_write(_event_fd, 1);
+
+    std::lock_guard<std::mutex> lock(_idle_mutex);
+    _idle_condition.notify_all();
+}
+
+// See Scheduler.h
+void Scheduler::Join() {
+    for (auto &w : _workers) {
+        if (w->thread.joinable()) {
+            w->thread.join();
+        }
+    }
+}
+
+// See Scheduler.h
+bool Scheduler::Spawn(std::function<void()> body) {
+    uint32_t capacity = 0;
+    char *stack = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_stack_mutex);
+        stack = _stack_pool.Acquire(_stack_size, capacity);
+    }
+
+    if (stack == nullptr) {
+        return false;
+    }
+
+    if (mprotect(stack, kGuardSize, PROT_NONE) != 0) {
+        std::lock_guard<std::mutex> lock(_stack_mutex);
+        _stack_pool.Release(stack, capacity);
+        return false;
+    }
+
+    task *t = new task();
+    t->owner = this;
+    t->body = std::move(body);
+    t->stack = stack;
+    t->stack_capacity = capacity;
+
+    _alive.fetch_add(1);
+    _spawned.fetch_add(1, std::memory_order_relaxed);
+    Enqueue(t);
+    return true;
+}
+
+// See Scheduler.h
+Scheduler::Stats Scheduler::GetStats() const {
+    Stats result;
+    result.spawned = _spawned.load(std::memory_order_relaxed);
+    result.completed = _completed.load(std::memory_order_relaxed);
+    for (auto &w : _workers) {
+        result.switches += w->switches.load(std::memory_order_relaxed);
+        result.stolen += w->stolen.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+// See Scheduler.h
+void *Scheduler::current() {
+    worker *w = CurrentWorker();
+    return w == nullptr ? nullptr : w->current;
+}
+
+// See Scheduler.h
+void Scheduler::yield() {
+    worker *w = CurrentWorker();
+    if (w == nullptr || w->current == nullptr) {
+        std::this_thread::yield();
+        return;
+    }
+
+    // Routine stays in kRunning state, scheduler loop puts it back into the queue
+    task *t = w->current;
+    SwitchContext(t->environment, w->environment);
+}
+
+// See Scheduler.h
+void Scheduler::park(std::unique_lock<std::mutex> &lock) {
+    worker *w = CurrentWorker();
+    if (w == nullptr || w->current == nullptr) {
+        throw std::runtime_error("Only routine could be parked");
+    }
+    assert(lock.owns_lock());
+
+    // Lock is released by the scheduler loop once routine is off the stack
+    task *t = w->current;
+    t->state = task::State::kParking;
+    t->unlock = lock.release();
+
+    std::mutex *mutex = t->unlock;
+    SwitchContext(t->environment, w->environment);
+
+    // Resumed by wake, possibly on some other thread
+    lock = std::unique_lock<std::mutex>(*mutex);
+}
+
+// See Scheduler.h
+void Scheduler::wake(void *routine) {
+    task *t = static_cast<task *>(routine);
+    assert(t->state == task::State::kParked);
+
+    t->state = task::State::kRunnable;
+    t->owner->Enqueue(t);
+}
+
+// See Scheduler.h
+void Scheduler::OnRun(worker *w) {
+    t_worker = w;
+
+    if (_pin_threads) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(w->index % CPU_SETSIZE, &cpuset);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+    }
+
+    while (true) {
+        task *t = Pop(w);
+        if (t == nullptr) {
+            t = Steal(w);
+        }
+
+        if (t != nullptr) {
+            Switch(w, t);
+
+            // Busy threads must not starve timers and IO waiters
+            if (w->switches.load(std::memory_order_relaxed) % kPollInterval == 0 && _poll_mutex.try_lock()) {
+                Poll(0);
+                _poll_mutex.unlock();
+            }
+            continue;
+        }
+
+        if (_stopping.load() && _alive.load() == 0) {
+            break;
+        }
+        Idle(w);
+    }
+
+    t_worker = nullptr;
+}
+
+// See Scheduler.h
+void Scheduler::Switch(worker *w, task *t) {
+    w->current = t;
+    t->state = task::State::kRunning;
+    w->switches.fetch_add(1, std::memory_order_relaxed);
+
+    // First time routine gets control, it starts on its own stack
+    if (!t->started) {
+        t->started = true;
+        MakeContext(t->environment, t->stack + kGuardSize, t->stack_capacity - kGuardSize, &Scheduler::Trampoline);
+    }
+    SwitchContext(w->environment, t->environment);
+
+    // Routine gave control back
+    w->current = nullptr;
+    switch (t->state) {
+    case task::State::kRunning: {
+        // yield
+        t->state = task::State::kRunnable;
+        std::lock_guard<std::mutex> lock(w->queue_mutex);
+        w->queue.push_back(t);
+        break;
+    }
+
+    case task::State::kParking: {
+        // Once lock is released, routine could be woken up by anyone
+        std::mutex *mutex = t->unlock;
+        t->unlock = nullptr;
+        t->state = task::State::kParked;
+        mutex->unlock();
+        break;
+    }
+
+    case task::State::kDone: {
+        Destroy(t);
+        _completed.fetch_add(1, std::memory_order_relaxed);
+        if (_alive.fetch_sub(1) == 1 && _stopping.load()) {
+            eventfd_write(_event_fd, 1);
+            std::lock_guard<std::mutex> lock(_idle_mutex);
+            _idle_condition.notify_all();
+        }
+        break;
+    }
+
+    default:
+        assert(false);
+    }
+}
+
+// See Scheduler.h
+void Scheduler::Enqueue(task *t) {
+    worker *w = CurrentWorker();
+    if (w == nullptr || w->owner != this) {
+        w = _workers[_next_queue.fetch_add(1, std::memory_order_relaxed) % _workers.size()].get();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(w->queue_mutex);
+        w->queue.push_back(t);
+    }
+    Notify();
+}
+
+// See Scheduler.h
+Scheduler::task *Scheduler::Pop(worker *w) {
+    std::lock_guard<std::mutex> lock(w->queue_mutex);
+    if (w->queue.empty()) {
+        return nullptr;
+    }
+
+    task *t = w->queue.front();
+    w->queue.pop_front();
+    return t;
+}
+
+// See Scheduler.h
+Scheduler::task *Scheduler::Steal(worker *w) {
+    std::size_t n = _workers.size();
+    for (std::size_t i = 1; i < n; i++) {
+        worker *victim = _workers[(w->index + i) % n].get();
+
+        std::deque<task *> loot;
+        {
+            std::lock_guard<std::mutex> lock(victim->queue_mutex);
+            std::size_t amount = (victim->queue.size() + 1) / 2;
+            for (std::size_t j = 0; j < amount; j++) {
+                loot.push_front(victim->queue.back());
+                victim->queue.pop_back();
+            }
+        }
+
+        if (loot.empty()) {
+            continue;
+        }
+
+        w->stolen.fetch_add(loot.size(), std::memory_order_relaxed);
+        task *t = loot.front();
+        loot.pop_front();
+        if (!loot.empty()) {
+            std::lock_guard<std::mutex> lock(w->queue_mutex);
+            w->queue.insert(w->queue.end(), loot.begin(), loot.end());
+        }
+        return t;
+    }
+    return nullptr;
+}
+
+// See Scheduler.h
+void Scheduler::Idle(worker *w) {
+    // Single thread sleeps in epoll, so that IO and timers are served
+    if (_poll_mutex.try_lock()) {
+        uint64_t timeout = kIdleTimeout;
+        if (_stopping.load() && _alive.load() == 0) {
+            timeout = 0;
+        } else {
+            std::lock_guard<std::mutex> lock(_timers_mutex);
+            timeout = _timers.NextExpiration(kIdleTimeout);
+        }
+
+        Poll(int(timeout));
+        _poll_mutex.unlock();
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_idle_mutex);
+    _sleeping.fetch_add(1);
+
+    // Recheck after announce sleeping, so that enqueue either sees us sleeping or we see its routine
+    if (!HasWork() && !(_stopping.load() && _alive.load() == 0)) {
+        // Timeout is only a safety net, wakeups are delivered by Notify
+        _idle_condition.wait_for(lock, std::chrono::milliseconds(kIdleTimeout));
+    }
+    _sleeping.fetch_sub(1);
+}
+
+// See Scheduler.h
+bool Scheduler::HasWork() {
+    for (auto &other : _workers) {
+        std::lock_guard<std::mutex> queue_lock(other->queue_mutex);
+        if (!other->queue.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// See Scheduler.h
+void Scheduler::Notify() {
+    if (_sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(_idle_mutex);
+        _idle_condition.notify_one();
+    } else if (_polling.load()) {
+        eventfd_write(_event_fd, 1);
+    }
+}
+
+// See Scheduler.h
+void Scheduler::Poll(int timeout) {
+    if (timeout != 0) {
+        // Same as for idle sleep: either enqueue sees polling flag, or we see its routine
+        _polling.store(true);
+        if (HasWork()) {
+            timeout = 0;
+        }
+    }
+
+    std::array<struct epoll_event, 64> events;
+    int nevents = epoll_wait(_epoll_fd, &events[0], events.size(), timeout);
+    _polling.store(false);
+
+    std::lock_guard<std::mutex> lock(_timers_mutex);
+    for (int i = 0; i < nevents; i++) {
+        uint64_t data = events[i].data.u64;
+        if (data == kEventFdData) {
+            eventfd_t value;
+            eventfd_read(_event_fd, &value);
+            continue;
+        }
+
+        // Event might belong to the wait finished by timeout already
+        std::size_t fd = data & UINT32_MAX;
+        uint32_t generation = data >> 32;
+        if (fd >= _io_waiters.size() || _io_waiters[fd] == nullptr || _io_waiters[fd]->generation != generation) {
+            continue;
+        }
+
+        waiter *w = _io_waiters[fd];
+        _io_waiters[fd] = nullptr;
+        _timers.Cancel(&w->timer);
+        w->events = events[i].events;
+        w->done = true;
+        wake(w->routine);
+    }
+
+    _timers.Advance(Now(), [this](TimerWheel::timer *t) {
+        waiter *w = static_cast<waiter *>(t->data);
+        if (w->fd >= 0 && _io_waiters[w->fd] == w) {
+            _io_waiters[w->fd] = nullptr;
+        }
+        w->events = 0;
+        w->done = true;
+        wake(w->routine);
+    });
+}
+
+// See Scheduler.h
+uint32_t Scheduler::Wait(std::unique_lock<std::mutex> &lock, waiter &w, int64_t timeout) {
+    w.routine = current();
+    if (timeout >= 0) {
+        w.timer.data = &w;
+        _timers.Add(&w.timer, Now() + timeout);
+    }
+
+    while (!w.done) {
+        park(lock);
+    }
+    return w.events;
+}
+
+// See Scheduler.h
+uint64_t Scheduler::Now() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _epoch).count();
+}
+
+// See Scheduler.h
+void Scheduler::sleep(std::chrono::milliseconds duration) {
+    worker *w = CurrentWorker();
+    if (w == nullptr || w->current == nullptr) {
+        std::this_thread::sleep_for(duration);
+        return;
+    }
+
+    Scheduler *scheduler = w->owner;
+    waiter self;
+    std::unique_lock<std::mutex> lock(scheduler->_timers_mutex);
+    scheduler->Wait(lock, self, std::max<int64_t>(duration.count(), 0));
+}
+
+// See Scheduler.h
+uint32_t Scheduler::wait_io(int fd, uint32_t events, std::chrono::milliseconds timeout) {
+    worker *w = CurrentWorker();
+    if (w == nullptr || w->current == nullptr) {
+        // EPOLLIN/EPOLLOUT/EPOLLERR/EPOLLHUP have the same values as poll ones
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = short(events);
+        pfd.revents = 0;
+        int result = poll(&pfd, 1, timeout.count() < 0 ? -1 : int(timeout.count()));
+        return result > 0 ? uint32_t(pfd.revents) : 0;
+    }
+
+    Scheduler *scheduler = w->owner;
+    waiter self;
+    self.fd = fd;
+
+    std::unique_lock<std::mutex> lock(scheduler->_timers_mutex);
+    self.generation = ++scheduler->_io_generation;
+    if (scheduler->_io_waiters.size() <= std::size_t(fd)) {
+        scheduler->_io_waiters.resize(fd + 1, nullptr);
+    }
+    scheduler->_io_waiters[fd] = &self;
+
+    // Descriptor stays registered between waits, oneshot keeps it disarmed while nobody waits
+    struct epoll_event event;
+    event.events = events | EPOLLONESHOT;
+    event.data.u64 = uint64_t(fd) | (uint64_t(self.generation) << 32);
+    if (epoll_ctl(scheduler->_epoll_fd, EPOLL_CTL_MOD, fd, &event) != 0 &&
+        (errno != ENOENT || epoll_ctl(scheduler->_epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0)) {
+        scheduler->_io_waiters[fd] = nullptr;
+        throw std::runtime_error("Failed to add descriptor to epoll: " + std::string(strerror(errno)));
+    }
+
+    return scheduler->Wait(lock, self, timeout.count());
+}
+
+// See Scheduler.h
+void Scheduler::Destroy(task *t) {
+    {
+        std::lock_guard<std::mutex> lock(_stack_mutex);
+        _stack_pool.Release(t->stack, t->stack_capacity);
+    }
+    delete t;
+}
+
+// See Scheduler.h
+void Scheduler::Trampoline() {
+    task *t = CurrentWorker()->current;
+    try {
+        t->body();
+    } catch (abi::__forced_unwind &) {
+        // Thread cancellation must not be stopped
+        throw;
+    } catch (...) {
+        // Exceptions must not cross routine stack boundary, there is nobody to catch it. Terminate handler
+        // reports the exception being handled
+        std::terminate();
+    }
+    t->body = nullptr;
+    t->state = task::State::kDone;
+
+    // Routine could migrate during execution, so worker must be read again. Done routine is never resumed
+    SwitchContext(t->environment, CurrentWorker()->environment);
+    std::abort();
+}
+
+// See Scheduler.h
+__attribute__((noinline)) Scheduler::worker *Scheduler::CurrentWorker() {
+    void *volatile w = t_worker;
+    return static_cast<worker *>(w);
+}
+
+} // namespace Coroutine
+} // namespace Afina
@@ -0,0 +1,152 @@
+#include <afina/coroutine/StackPool.h>
+
+#include <atomic>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Coroutine {
+
+namespace {
+
+// Smallest buffer pool gives out, must be power of two
+const std::size_t kMinBufferSize = 4096;
+
+// Counters shared by all pools, updated relaxed as nobody orders anything by them
+std::atomic<uint64_t> g_allocated(0);
+std::atomic<uint64_t> g_reused(0);
+std::atomic<uint64_t> g_released(0);
+std::atomic<uint64_t> g_failed(0);
+std::atomic<uint64_t> g_in_use_bytes(0);
+std::atomic<uint64_t> g_cached_bytes(0);
+
+// Lets kernel take pages back whenever it wants, but keeps mapping alive
+void _DropPages(char *buffer, std::size_t size) {
+#ifdef MADV_FREE
+    if (madvise(buffer, size, MADV_FREE) == 0) {
+        return;
+    }
+#endif
+    // Kernels older than 4.5 have no MADV_FREE
+    madvise(buffer, size, MADV_DONTNEED);
+}
+
+} // namespace
+
+// See StackPool.h
+StackPool::StackPool(std::size_t max_bytes, std::size_t max_cached_bytes)
+    : _max_bytes(max_bytes), _max_cached_bytes(max_cached_bytes), _in_use_bytes(0), _cached_bytes(0) {}
+
+// See StackPool.h
+StackPool::~StackPool() {
+    for (std::size_t cls = 0; cls < _cache.size(); cls++) {
+        std::size_t size = kMinBufferSize << cls;
+        for (char *buffer : _cache[cls]) {
+            munmap(buffer, size);
+            g_released.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    g_cached_bytes.fetch_sub(_cached_bytes, std::memory_order_relaxed);
+    g_in_use_bytes.fetch_sub(_in_use_bytes, std::memory_order_relaxed);
+}
+
+// See StackPool.h
+char *StackPool::Acquire(std::size_t size, uint32_t &capacity) {
+    std::size_t cls = _SizeClass(size);
+    std::size_t cls_size = kMinBufferSize << cls;
+
+    // Fast path: take buffer from the cache, pages might be still there
+    if (cls < _cache.size() && !_cache[cls].empty()) {
+        char *buffer = _cache[cls].back();
+        _cache[cls].pop_back();
+
+        _cached_bytes -= cls_size;
+        _in_use_bytes += cls_size;
+        g_cached_bytes.fetch_sub(cls_size, std::memory_order_relaxed);
+        g_in_use_bytes.fetch_add(cls_size, std::memory_order_relaxed);
+        g_reused.fetch_add(1, std::memory_order_relaxed);
+
+        capacity = cls_size;
+        return buffer;
+    }
+
+    // Slow path: map new buffer, drop cached ones from other classes if that is the only way to fit limit
+    for (std::size_t i = 0; i < _cache.size() && _in_use_bytes + _cached_bytes + cls_size > _max_bytes; i++) {
+        std::size_t drop_size = kMinBufferSize << i;
+        while (!_cache[i].empty() && _in_use_bytes + _cached_bytes + cls_size > _max_bytes) {
+            munmap(_cache[i].back(), drop_size);
+            _cache[i].pop_back();
+            _cached_bytes -= drop_size;
+            g_cached_bytes.fetch_sub(drop_size, std::memory_order_relaxed);
+            g_released.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    if (_in_use_bytes + _cached_bytes + cls_size > _max_bytes || cls_size > UINT32_MAX) {
+        g_failed.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    void *buffer = mmap(nullptr, cls_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (buffer == MAP_FAILED) {
+        g_failed.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    _in_use_bytes += cls_size;
+    g_in_use_bytes.fetch_add(cls_size, std::memory_order_relaxed);
+    g_allocated.fetch_add(1, std::memory_order_relaxed);
+
+    capacity = cls_size;
+    return static_cast<char *>(buffer);
+}
+
+// See StackPool.h
+void StackPool::Release(char *buffer, uint32_t capacity) {
+    if (buffer == nullptr) {
+        return;
+    }
+
+    std::size_t cls = _SizeClass(capacity);
+    _in_use_bytes -= capacity;
+    g_in_use_bytes.fetch_sub(capacity, std::memory_order_relaxed);
+
+    if (_cached_bytes + capacity > _max_cached_bytes) {
+        munmap(buffer, capacity);
+        g_released.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    _DropPages(buffer, capacity);
+    if (_cache.size() <= cls) {
+        _cache.resize(cls + 1);
+    }
+    _cache[cls].push_back(buffer);
+    _cached_bytes += capacity;
+    g_cached_bytes.fetch_add(capacity, std::memory_order_relaxed);
+}
+
+// See StackPool.h
+StackPool::Stats StackPool::GlobalStats() {
+    Stats result;
+    result.allocated = g_allocated.load(std::memory_order_relaxed);
+    result.reused = g_reused.load(std::memory_order_relaxed);
+    result.released = g_released.load(std::memory_order_relaxed);
+    result.failed = g_failed.load(std::memory_order_relaxed);
+    result.in_use_bytes = g_in_use_bytes.load(std::memory_order_relaxed);
+    result.cached_bytes = g_cached_bytes.load(std::memory_order_relaxed);
+    return result;
+}
+
+// See StackPool.h
+std::size_t StackPool::_SizeClass(std::size_t size) {
+    std::size_t cls = 0;
+    while ((kMinBufferSize << cls) < size) {
+        cls++;
+    }
+    return cls;
+}
+
+} // namespace Coroutine
+} // namespace Afina
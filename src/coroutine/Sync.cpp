@@ -0,0 +1,162 @@
+#include <afina/coroutine/Sync.h>
+
+#include <cassert>
+#include <stdexcept>
+
+#include <afina/coroutine/Scheduler.h>
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * Single suspended routine or thread
+ */
+struct WaitQueue::waiter {
+    // Routine to wake, nullptr for ordinary thread
+    void *routine = nullptr;
+
+    // Variable thread sleeps on, nullptr for routine
+    std::condition_variable *condition = nullptr;
+
+    // Set by notify, protects from spurious wakeups
+    bool notified = false;
+
+    waiter *next = nullptr;
+};
+
+// See Sync.h
+void WaitQueue::wait(std::unique_lock<std::mutex> &lock) {
+    waiter self;
+    self.routine = Scheduler::current();
+
+    if (_tail == nullptr) {
+        _head = _tail = &self;
+    } else {
+        _tail->next = &self;
+        _tail = &self;
+    }
+
+    if (self.routine != nullptr) {
+        while (!self.notified) {
+            Scheduler::park(lock);
+        }
+        return;
+    }
+
+    std::condition_variable condition;
+    self.condition = &condition;
+    while (!self.notified) {
+        condition.wait(lock);
+    }
+}
+
+// See Sync.h
+bool WaitQueue::notify_one() {
+    waiter *w = _head;
+    if (w == nullptr) {
+        return false;
+    }
+
+    _head = w->next;
+    if (_head == nullptr) {
+        _tail = nullptr;
+    }
+
+    // Once notified flag is set waiter could return and destroy itself, so read everything first
+    void *routine = w->routine;
+    std::condition_variable *condition = w->condition;
+    w->notified = true;
+
+    if (routine != nullptr) {
+        Scheduler::wake(routine);
+    } else {
+        condition->notify_one();
+    }
+    return true;
+}
+
+// See Sync.h
+void WaitQueue::notify_all() {
+    while (notify_one()) {
+    }
+}
+
+// See Sync.h
+void Mutex::lock() {
+    std::unique_lock<std::mutex> guard(_guard);
+    while (_locked) {
+        _waiters.wait(guard);
+    }
+    _locked = true;
+}
+
+// See Sync.h
+bool Mutex::try_lock() {
+    std::lock_guard<std::mutex> guard(_guard);
+    if (_locked) {
+        return false;
+    }
+    _locked = true;
+    return true;
+}
+
+// See Sync.h
+void Mutex::unlock() {
+    std::lock_guard<std::mutex> guard(_guard);
+    assert(_locked);
+    _locked = false;
+    _waiters.notify_one();
+}
+
+// See Sync.h
+void ConditionVariable::wait(std::unique_lock<Mutex> &lock) {
+    std::unique_lock<std::mutex> guard(_guard);
+
+    // Notify must take guard first, so nothing could be lost between unlock and wait
+    lock.unlock();
+    _waiters.wait(guard);
+    guard.unlock();
+
+    lock.lock();
+}
+
+// See Sync.h
+void ConditionVariable::notify_one() {
+    std::lock_guard<std::mutex> guard(_guard);
+    _waiters.notify_one();
+}
+
+// See Sync.h
+void ConditionVariable::notify_all() {
+    std::lock_guard<std::mutex> guard(_guard);
+    _waiters.notify_all();
+}
+
+// See Sync.h
+void WaitGroup::add(std::size_t n) {
+    std::lock_guard<std::mutex> guard(_guard);
+    _counter += n;
+}
+
+// See Sync.h
+void WaitGroup::done() {
+    std::lock_guard<std::mutex> guard(_guard);
+    if (_counter == 0) {
+        throw std::runtime_error("WaitGroup counter is negative");
+    }
+
+    if (--_counter == 0) {
+        _waiters.notify_all();
+    }
+}
+
+// See Sync.h
+void WaitGroup::wait() {
+    std::unique_lock<std::mutex> guard(_guard);
+    while (_counter > 0) {
+        _waiters.wait(guard);
+    }
+}
+
+} // namespace Coroutine
+} // namespace Afina
@@ -0,0 +1,103 @@
+#include <afina/coroutine/TimerWheel.h>
+
+namespace Afina {
+namespace Coroutine {
+
+// See TimerWheel.h
+TimerWheel::TimerWheel(uint64_t now) : _now(now), _size(0) {
+    for (unsigned level = 0; level < kLevels; level++) {
+        for (uint64_t slot = 0; slot < kSlots; slot++) {
+            _slots[level][slot].prev = _slots[level][slot].next = &_slots[level][slot];
+        }
+    }
+}
+
+// See TimerWheel.h
+void TimerWheel::Add(timer *t, uint64_t expires) {
+    if (t->active()) {
+        Cancel(t);
+    }
+
+    // Current slot is processed already
+    if (expires <= _now) {
+        expires = _now + 1;
+    }
+
+    // Clamp to the wheel span
+    const uint64_t span = uint64_t(1) << (kBits * kLevels);
+    if (expires - _now >= span) {
+        expires = _now + span - 1;
+    }
+    t->expires = expires;
+    _Insert(t);
+}
+
+// See TimerWheel.h
+void TimerWheel::_Insert(timer *t) {
+    uint64_t delta = t->expires - _now;
+    unsigned level = 0;
+    while (delta >= (uint64_t(1) << (kBits * (level + 1)))) {
+        level++;
+    }
+
+    timer &head = _slots[level][(t->expires >> (kBits * level)) & kMask];
+    t->prev = head.prev;
+    t->next = &head;
+    head.prev->next = t;
+    head.prev = t;
+    _size++;
+}
+
+// See TimerWheel.h
+void TimerWheel::Cancel(timer *t) {
+    if (t->active()) {
+        _Unlink(t);
+    }
+}
+
+// See TimerWheel.h
+uint64_t TimerWheel::NextExpiration(uint64_t limit) const {
+    if (_size == 0) {
+        return limit;
+    }
+
+    // Nearest non empty slot of the lowest level before cascade
+    uint64_t boundary = kSlots - (_now & kMask);
+    for (uint64_t i = 1; i < boundary && i < limit; i++) {
+        const timer &head = _slots[0][(_now + i) & kMask];
+        if (head.next != &head) {
+            return i;
+        }
+    }
+
+    // Upper levels timers expire not earlier than cascade
+    return boundary < limit ? boundary : limit;
+}
+
+// See TimerWheel.h
+void TimerWheel::_Cascade() {
+    for (unsigned level = 1; level < kLevels; level++) {
+        // Time crossed slot boundary of this level?
+        if ((_now & ((uint64_t(1) << (kBits * level)) - 1)) != 0) {
+            break;
+        }
+
+        timer &head = _slots[level][(_now >> (kBits * level)) & kMask];
+        while (head.next != &head) {
+            timer *t = head.next;
+            _Unlink(t);
+            _Insert(t);
+        }
+    }
+}
+
+// See TimerWheel.h
+void TimerWheel::_Unlink(timer *t) {
+    t->prev->next = t->next;
+    t->next->prev = t->prev;
+    t->prev = t->next = nullptr;
+    _size--;
+}
+
+} // namespace Coroutine
+} // namespace Afina
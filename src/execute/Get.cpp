@@ -1,10 +1,6 @@
 #include <afina/Storage.h>
 #include <afina/execute/Get.h>
 
-#include <iostream>
-#include <iterator>
-#include <sstream>
-
 namespace Afina {
 namespace Execute {
 
@@ -21,23 +17,68 @@ to indicate the end of response.
 
 */
 
-void Get::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::stringstream keyStream;
-    copy(_keys.begin(), _keys.end(), std::ostream_iterator<std::string>(keyStream, " "));
-    std::cout << "Get(" << keyStream.str() << ")" << std::endl;
-
-    std::stringstream outStream;
+namespace {
 
+// Storage talks std::string, these keep their capacity between requests
+struct buffers {
+    std::string key;
     std::string value;
-    for (auto &key : _keys) {
-        if (!storage.Get(key, value))
+};
+
+thread_local buffers t_buffers;
+
+// Routine could be resumed on other thread while it waits for storage lock, so buffers are moved out of the
+// thread's slot for the time of request rather than used in place, and slot is looked up again after
+__attribute__((noinline)) buffers &ThreadBuffers() { return t_buffers; }
+
+} // namespace
+
+// See Get.h
+Get::Get(const std::vector<std::string> &keys)
+    : _own_arena(new Allocator::Arena(256)), _keys(arena_allocator<key>(*_own_arena)) {
+    _Assign(keys);
+}
+
+// See Get.h
+Get::Get(const std::vector<std::string> &keys, Allocator::Arena &arena) : _keys(arena_allocator<key>(arena)) {
+    _Assign(keys);
+}
+
+// See Get.h
+std::vector<std::string> Get::keys() const {
+    std::vector<std::string> result;
+    for (auto &k : _keys) {
+        result.emplace_back(k.data(), k.size());
+    }
+    return result;
+}
+
+// See Get.h
+void Get::_Assign(const std::vector<std::string> &keys) {
+    _keys.reserve(keys.size());
+    for (auto &k : keys) {
+        _keys.emplace_back(k.data(), k.size(), _keys.get_allocator());
+    }
+}
+
+// See Get.h
+void Get::Execute(Storage &storage, const std::string &args, std::string &out) {
+    buffers local;
+    std::swap(local, ThreadBuffers());
+
+    for (auto &k : _keys) {
+        local.key.assign(k.data(), k.size());
+        if (!storage.Get(local.key, local.value)) {
             continue;
-        outStream << "VALUE " << key << " 0 " << value.size() << "\r\n";
-        outStream << value << "\r\n";
+        }
+
+        out.append("VALUE ").append(k.data(), k.size()).append(" 0 ");
+        out.append(std::to_string(local.value.size())).append("\r\n");
+        out.append(local.value).append("\r\n");
     }
-    outStream << "END"; // networking layer should add the last \r\n
+    out.append("END"); // networking layer should add the last \r\n
 
-    out = outStream.str();
+    std::swap(local, ThreadBuffers());
 }
 
 } // namespace Execute
@@ -0,0 +1,88 @@
+#include <afina/execute/SlowLog.h>
+
+#include <algorithm>
+#include <ctime>
+#include <thread>
+
+namespace Afina {
+namespace Execute {
+
+namespace {
+
+// Measures clock rate against steady clock
+double Calibrate() {
+    using namespace std::chrono;
+
+#if defined(__x86_64__) || defined(__i386__)
+    const auto start = steady_clock::now();
+    const uint64_t start_ticks = TscClock::now();
+    std::this_thread::sleep_for(milliseconds(10));
+    const uint64_t ticks = TscClock::now() - start_ticks;
+    const auto ns = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    return ns > 0 && ticks > 0 ? double(ticks) / ns : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+} // namespace
+
+// See SlowLog.h
+double TscClock::ticks_per_ns() {
+    static const double rate = Calibrate();
+    return rate;
+}
+
+// See SlowLog.h
+SlowLog::SlowLog(std::size_t capacity, uint64_t threshold_us)
+    : _entries(std::max<std::size_t>(capacity, 1)), _next_id(0) {
+    SetThreshold(threshold_us);
+}
+
+// See SlowLog.h
+void SlowLog::SetThreshold(uint64_t threshold_us) {
+    _threshold_us.store(threshold_us, std::memory_order_relaxed);
+    _threshold_ticks.store(TscClock::from_ns(threshold_us * 1000), std::memory_order_relaxed);
+}
+
+// See SlowLog.h
+void SlowLog::Add(const std::string &command, std::size_t keys, std::size_t bytes_in, std::size_t bytes_out,
+                  const char *client, uint64_t ticks) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Entry &e = _entries[_next_id % _entries.size()];
+    e.id = _next_id++;
+    e.timestamp = std::time(nullptr);
+    e.elapsed_us = TscClock::to_ns(ticks) / 1000;
+    e.command = command;
+    e.keys = keys;
+    e.bytes_in = bytes_in;
+    e.bytes_out = bytes_out;
+    e.client = client;
+}
+
+// See SlowLog.h
+std::vector<SlowLog::Entry> SlowLog::Entries() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::vector<Entry> result;
+    const uint64_t count = std::min<uint64_t>(_next_id, _entries.size());
+    for (uint64_t i = 1; i <= count; i++) {
+        result.push_back(_entries[(_next_id - i) % _entries.size()]);
+    }
+    return result;
+}
+
+// See SlowLog.h
+uint64_t SlowLog::Total() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _next_id;
+}
+
+// See SlowLog.h
+SlowLog &SlowLog::Global() {
+    static SlowLog log;
+    return log;
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -0,0 +1,20 @@
+#include <afina/execute/Snapshot.h>
+#include <afina/storage/Snapshot.h>
+
+namespace Afina {
+namespace Execute {
+
+// See Snapshot.h
+void Snapshot::Execute(Storage &storage, const std::string &args, std::string &out) {
+    Backend::Snapshot *snapshot = Backend::Snapshot::Current();
+    if (snapshot == nullptr) {
+        out = "SERVER_ERROR snapshots are disabled";
+    } else if (!snapshot->Trigger()) {
+        out = "SERVER_ERROR snapshot is in progress";
+    } else {
+        out = "OK";
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
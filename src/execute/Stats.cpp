@@ -1,14 +1,78 @@
 #include <afina/Storage.h>
+#include <afina/coroutine/StackPool.h>
+#include <afina/execute/SlowLog.h>
 #include <afina/execute/Stats.h>
+#include <afina/storage/Snapshot.h>
 
 #include <iostream>
 #include <iterator>
 #include <sstream>
+#include <stdexcept>
 
 namespace Afina {
 namespace Execute {
 
-void Stats::Execute(Storage &storage, const std::string &args, std::string &out) { out.assign("END"); }
+/* memcached protocol:
+
+Each statistic item sent by the server looks like this:
+
+STAT <name> <value>\r\n
+
+After all the items have been transmitted, the server sends the string
+"END\r\n"
+to indicate the end of response.
+
+*/
+
+void Stats::Execute(Storage &storage, const std::string &args, std::string &out) {
+    std::stringstream outStream;
+
+    if (!_args.empty()) {
+        if (_args[0] != "slowlog" || _args.size() > 1) {
+            throw std::runtime_error("Unknown stats group");
+        }
+
+        for (const SlowLog::Entry &e : SlowLog::Global().Entries()) {
+            outStream << "STAT " << e.id << " time=" << e.timestamp << " elapsed_us=" << e.elapsed_us
+                      << " cmd=" << e.command << " keys=" << e.keys << " bytes_in=" << e.bytes_in
+                      << " bytes_out=" << e.bytes_out << " client=" << e.client << "\r\n";
+        }
+        outStream << "END";
+
+        out = outStream.str();
+        return;
+    }
+
+    Coroutine::StackPool::Stats stack_pool = Coroutine::StackPool::GlobalStats();
+    outStream << "STAT coroutine_stacks_allocated " << stack_pool.allocated << "\r\n";
+    outStream << "STAT coroutine_stacks_reused " << stack_pool.reused << "\r\n";
+    outStream << "STAT coroutine_stacks_released " << stack_pool.released << "\r\n";
+    outStream << "STAT coroutine_stacks_failed " << stack_pool.failed << "\r\n";
+    outStream << "STAT coroutine_stack_bytes_in_use " << stack_pool.in_use_bytes << "\r\n";
+    outStream << "STAT coroutine_stack_bytes_cached " << stack_pool.cached_bytes << "\r\n";
+
+    const SlowLog &slow_log = SlowLog::Global();
+    outStream << "STAT slowlog_threshold_us " << slow_log.Threshold() << "\r\n";
+    outStream << "STAT slowlog_total " << slow_log.Total() << "\r\n";
+
+    if (Backend::Snapshot *snapshot = Backend::Snapshot::Current()) {
+        Backend::Snapshot::Status status = snapshot->GetStatus();
+        outStream << "STAT snapshot_in_progress " << status.in_progress << "\r\n";
+        outStream << "STAT snapshot_last_time " << status.last_time << "\r\n";
+        outStream << "STAT snapshot_last_ok " << status.last_ok << "\r\n";
+        outStream << "STAT snapshot_last_duration_ms " << status.last_duration_ms << "\r\n";
+        outStream << "STAT snapshot_last_bytes " << status.last_bytes << "\r\n";
+    }
+
+    std::vector<std::pair<std::string, std::string>> storage_stats;
+    storage.Stats(storage_stats);
+    for (auto &stat : storage_stats) {
+        outStream << "STAT " << stat.first << " " << stat.second << "\r\n";
+    }
+    outStream << "END"; // networking layer should add the last \r\n
+
+    out = outStream.str();
+}
 
 } // namespace Execute
 } // namespace Afina
@@ -0,0 +1,147 @@
+#include <afina/logging/Context.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace Afina {
+namespace Logging {
+
+namespace {
+
+// Tags of the thread, innermost last
+struct context {
+    const ContextTag *tags[ContextTag::kMaxTags];
+    std::size_t size = 0;
+};
+
+thread_local context current;
+
+// Appends string to the buffer as much as fits
+char *Append(char *out, char *end, const char *str, std::size_t len) {
+    len = std::min<std::size_t>(len, end - out);
+    std::memcpy(out, str, len);
+    return out + len;
+}
+
+} // namespace
+
+// See Context.h
+PeerAddress::PeerAddress(int socket) {
+    struct sockaddr_storage addr;
+    socklen_t addr_len = sizeof(addr);
+    char host[INET6_ADDRSTRLEN];
+    int port = 0;
+
+    const char *result = nullptr;
+    if (socket >= 0 && getpeername(socket, reinterpret_cast<struct sockaddr *>(&addr), &addr_len) == 0) {
+        if (addr.ss_family == AF_INET) {
+            auto *in = reinterpret_cast<struct sockaddr_in *>(&addr);
+            result = inet_ntop(AF_INET, &in->sin_addr, host, sizeof(host));
+            port = ntohs(in->sin_port);
+        } else if (addr.ss_family == AF_INET6) {
+            auto *in6 = reinterpret_cast<struct sockaddr_in6 *>(&addr);
+            result = inet_ntop(AF_INET6, &in6->sin6_addr, host, sizeof(host));
+            port = ntohs(in6->sin6_port);
+        }
+    }
+
+    if (result == nullptr) {
+        std::strcpy(_text, "?");
+    } else {
+        std::snprintf(_text, sizeof(_text), "%s:%d", host, port);
+    }
+}
+
+const std::size_t ContextTag::kMaxTags;
+
+// See Context.h
+ContextTag::ContextTag(const char *key, const char *value) : _key(key), _kind(Kind::CString), _cstring(value) {
+    _Push();
+}
+
+// See Context.h
+ContextTag::ContextTag(const char *key, const std::string &value) : _key(key), _kind(Kind::String), _string(&value) {
+    _Push();
+}
+
+// See Context.h
+ContextTag::ContextTag(const char *key, int64_t value) : _key(key), _kind(Kind::Integer), _integer(value) {
+    _Push();
+}
+
+// See Context.h
+ContextTag::ContextTag(const char *key, const PeerAddress &value)
+    : _key(key), _kind(Kind::CString), _cstring(value.c_str()) {
+    _Push();
+}
+
+// See Context.h
+ContextTag::~ContextTag() {
+    if (_pushed) {
+        current.size--;
+    }
+}
+
+// See Context.h
+void ContextTag::_Push() {
+    _pushed = current.size < kMaxTags;
+    if (_pushed) {
+        current.tags[current.size++] = this;
+    }
+}
+
+// See Context.h
+std::size_t ContextTag::Render(char *buffer, std::size_t size) {
+    if (current.size == 0) {
+        return 0;
+    }
+
+    char *out = buffer;
+    char *end = buffer + size;
+    bool first = true;
+    for (std::size_t i = 0; i < current.size; i++) {
+        const ContextTag *tag = current.tags[i];
+        if ((tag->_kind == Kind::CString && (tag->_cstring == nullptr || *tag->_cstring == '\0')) ||
+            (tag->_kind == Kind::String && tag->_string->empty())) {
+            continue;
+        }
+
+        out = first ? Append(out, end, " {", 2) : Append(out, end, ", ", 2);
+        out = tag->_Render(out, end);
+        first = false;
+    }
+
+    if (!first) {
+        out = Append(out, end, "}", 1);
+    }
+    return out - buffer;
+}
+
+// See Context.h
+char *ContextTag::_Render(char *out, char *end) const {
+    out = Append(out, end, _key, std::strlen(_key));
+    out = Append(out, end, "=", 1);
+
+    switch (_kind) {
+    case Kind::CString:
+        return Append(out, end, _cstring, std::strlen(_cstring));
+
+    case Kind::String:
+        return Append(out, end, _string->data(), _string->size());
+
+    case Kind::Integer: {
+        char buf[24];
+        int len = std::snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(_integer));
+        return Append(out, end, buf, len);
+    }
+    }
+    return out;
+}
+
+} // namespace Logging
+} // namespace Afina
@@ -0,0 +1,43 @@
+#ifndef AFINA_LOGGING_CONTEXT_LOGGER_H
+#define AFINA_LOGGING_CONTEXT_LOGGER_H
+
+#include <string>
+
+#include <spdlog/logger.h>
+
+#include <afina/logging/Context.h>
+
+namespace Afina {
+namespace Logging {
+
+/**
+ * # Logger attaching thread context
+ * Renders tags of the calling thread, see Context.h, into the message of every record emitted. Records filtered
+ * out by level never get here, so tags cost nothing for them
+ */
+class ContextLogger : public spdlog::logger {
+public:
+    template <typename It>
+    ContextLogger(const std::string &name, const It &begin, const It &end) : spdlog::logger(name, begin, end) {}
+
+    ContextLogger(const std::string &name, spdlog::sink_ptr sink) : spdlog::logger(name, sink) {}
+
+protected:
+    void _sink_it(spdlog::details::log_msg &msg) override {
+        _AppendContext(msg);
+        spdlog::logger::_sink_it(msg);
+    }
+
+    static void _AppendContext(spdlog::details::log_msg &msg) {
+        char buffer[512];
+        std::size_t size = ContextTag::Render(buffer, sizeof(buffer));
+        if (size > 0) {
+            msg.raw << fmt::StringRef(buffer, size);
+        }
+    }
+};
+
+} // namespace Logging
+} // namespace Afina
+
+#endif // AFINA_LOGGING_CONTEXT_LOGGER_H
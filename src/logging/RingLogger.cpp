@@ -0,0 +1,419 @@
+#include "RingLogger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <set>
+
+#include <limits.h>
+
+namespace Afina {
+namespace Logging {
+
+namespace {
+
+// How long logging thread sleeps once there is nothing to write
+const std::chrono::milliseconds kIdleWait(10);
+
+// Smallest ring size
+const std::size_t kMinRing = 4096;
+
+// Writers alive, protected by the mutex
+std::mutex writers_mutex;
+std::set<uint64_t> writers;
+std::atomic<uint64_t> next_writer_id(1);
+
+} // namespace
+
+// See RingLogger.h
+RingBuffer::RingBuffer(std::size_t capacity) : _head(0), _tail(0), _head_cache(0) {
+    std::size_t size = kMinRing;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    _data.reset(new char[size]);
+    _mask = size - 1;
+}
+
+// See RingLogger.h
+bool RingBuffer::push(const void *logger, uint32_t level, int64_t time, std::size_t thread_id, const char *text,
+                      std::size_t text_size) {
+    const std::size_t capacity = _mask + 1;
+    text_size = std::min(text_size, capacity / 4);
+    const std::size_t need = (sizeof(record) + text_size + 7) & ~std::size_t(7);
+
+    // Record must be contiguous, so skip the tail of the array if it doesn't fit there
+    uint64_t tail = _tail.load(std::memory_order_relaxed);
+    std::size_t offset = tail & _mask;
+    const std::size_t contiguous = capacity - offset;
+    const std::size_t total = need <= contiguous ? need : contiguous + need;
+    if (tail + total - _head_cache > capacity) {
+        _head_cache = _head.load(std::memory_order_acquire);
+        if (tail + total - _head_cache > capacity) {
+            return false;
+        }
+    }
+
+    if (need > contiguous) {
+        if (contiguous >= sizeof(record)) {
+            record *padding = reinterpret_cast<record *>(&_data[offset]);
+            padding->size = static_cast<uint32_t>(contiguous);
+            padding->logger = nullptr;
+        }
+        tail += contiguous;
+        offset = 0;
+    }
+
+    record *r = reinterpret_cast<record *>(&_data[offset]);
+    r->size = static_cast<uint32_t>(need);
+    r->level = level;
+    r->logger = logger;
+    r->time = time;
+    r->thread_id = thread_id;
+    r->text_size = text_size;
+    std::memcpy(r + 1, text, text_size);
+
+    _tail.store(tail + need, std::memory_order_release);
+    return true;
+}
+
+/**
+ * Rings of the thread in all writers it used
+ */
+struct RingWriter::thread_rings {
+    struct entry {
+        uint64_t id;
+        ring *r;
+    };
+
+    std::vector<entry> entries;
+
+    ~thread_rings() {
+        std::lock_guard<std::mutex> lock(writers_mutex);
+        for (entry &e : entries) {
+            if (writers.count(e.id) != 0) {
+                e.r->abandoned.store(true, std::memory_order_release);
+            }
+        }
+    }
+};
+
+// See RingLogger.h
+RingWriter::RingWriter(std::size_t ring_size, Overflow overflow)
+    : _id(next_writer_id++), _ring_size(ring_size), _overflow(overflow), _dropped(0), _running(false), _passes(0),
+      _syncing(0), _formatted_used(0), _reported_drops(0) {
+    std::lock_guard<std::mutex> lock(writers_mutex);
+    writers.insert(_id);
+}
+
+// See RingLogger.h
+RingWriter::~RingWriter() {
+    Stop();
+
+    std::lock_guard<std::mutex> lock(writers_mutex);
+    writers.erase(_id);
+}
+
+// See RingLogger.h
+void RingWriter::Start() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_running.exchange(true)) {
+        return;
+    }
+    _thread = std::thread(&RingWriter::_OnRun, this);
+}
+
+// See RingLogger.h
+void RingWriter::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running.store(false);
+        _wakeup.notify_one();
+    }
+
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+// See RingLogger.h
+void RingWriter::Push(const RingLogger *logger, const spdlog::details::log_msg &msg) {
+    if (!_running.load(std::memory_order_relaxed)) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    RingBuffer &buffer = _Ring()->buffer;
+    const int64_t time = msg.time.time_since_epoch().count();
+    while (!buffer.push(logger, msg.level, time, msg.thread_id, msg.raw.data(), msg.raw.size())) {
+        if (_overflow == Overflow::Drop || !_running.load(std::memory_order_relaxed)) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        Wake();
+        std::this_thread::yield();
+    }
+}
+
+// See RingLogger.h
+void RingWriter::Wake() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _wakeup.notify_one();
+}
+
+// See RingLogger.h
+void RingWriter::Post(std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_running.load()) {
+        return;
+    }
+
+    _tasks.push_back(std::move(task));
+    _wakeup.notify_one();
+}
+
+// See RingLogger.h
+void RingWriter::Sync() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (!_running.load() || std::this_thread::get_id() == _thread.get_id()) {
+        return;
+    }
+
+    // Pass in progress could have missed records pushed just now, so wait for the next one to complete
+    const uint64_t target = _passes + 2;
+    _syncing++;
+    _wakeup.notify_one();
+    _synced.wait(lock, [this, target] { return _passes >= target || !_running.load(); });
+    _syncing--;
+}
+
+// See RingLogger.h
+void *RingWriter::ring::operator new(std::size_t size) {
+    void *p = nullptr;
+    if (posix_memalign(&p, alignof(ring), size) != 0) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+// See RingLogger.h
+void RingWriter::ring::operator delete(void *p) { std::free(p); }
+
+// See RingLogger.h
+RingWriter::ring *RingWriter::_Ring() {
+    static thread_local thread_rings rings;
+    for (thread_rings::entry &e : rings.entries) {
+        if (e.id == _id) {
+            return e.r;
+        }
+    }
+
+    std::unique_ptr<ring> r(new ring(_ring_size));
+
+    thread_rings::entry e;
+    e.id = _id;
+    e.r = r.get();
+    rings.entries.push_back(e);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _rings.push_back(std::move(r));
+    return e.r;
+}
+
+// See RingLogger.h
+void RingWriter::_OnRun() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_running.load()) {
+        lock.unlock();
+        std::size_t written = _Drain();
+        lock.lock();
+
+        _RunTasks(lock);
+
+        _passes++;
+        _synced.notify_all();
+        if (written == 0 && _syncing == 0 && _tasks.empty() && _running.load()) {
+            _wakeup.wait_for(lock, kIdleWait);
+        }
+    }
+    lock.unlock();
+
+    // Records pushed before stop
+    _Drain();
+
+    lock.lock();
+    _RunTasks(lock);
+    _passes++;
+    _synced.notify_all();
+}
+
+// See RingLogger.h
+void RingWriter::_RunTasks(std::unique_lock<std::mutex> &lock) {
+    while (!_tasks.empty()) {
+        std::vector<std::function<void()>> tasks;
+        tasks.swap(_tasks);
+
+        lock.unlock();
+        for (auto &task : tasks) {
+            try {
+                task();
+            } catch (const std::exception &ex) {
+                std::fprintf(stderr, "Logging task failed: %s\n", ex.what());
+            }
+        }
+        lock.lock();
+    }
+}
+
+// See RingLogger.h
+std::size_t RingWriter::_Drain() {
+    _drained.clear();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto &r : _rings) {
+            _drained.push_back(r.get());
+        }
+    }
+
+    std::size_t written = 0;
+    for (ring *r : _drained) {
+        written += r->buffer.pop([this](const RingBuffer::record &rec) { _Write(rec); });
+    }
+    _Flush();
+
+    // Forget rings of exited threads once they are empty
+    std::lock_guard<std::mutex> lock(_mutex);
+    _rings.erase(std::remove_if(_rings.begin(), _rings.end(),
+                                [](const std::unique_ptr<ring> &r) {
+                                    return r->abandoned.load(std::memory_order_acquire) && r->buffer.empty();
+                                }),
+                 _rings.end());
+    return written;
+}
+
+// See RingLogger.h
+void RingWriter::_Write(const RingBuffer::record &r) {
+    const RingLogger *logger = static_cast<const RingLogger *>(r.logger);
+
+    // Report records lost since the last report through the same logger
+    const uint64_t dropped = _dropped.load(std::memory_order_relaxed);
+    if (dropped != _reported_drops) {
+        spdlog::details::log_msg msg(&logger->name(), spdlog::level::warn);
+        msg.raw.write("Dropped {} log records", dropped - _reported_drops);
+        _reported_drops = dropped;
+        _Dispatch(logger, msg);
+    }
+
+    spdlog::details::log_msg msg;
+    msg.logger_name = &logger->name();
+    msg.level = static_cast<spdlog::level::level_enum>(r.level);
+    msg.time = spdlog::log_clock::time_point(spdlog::log_clock::duration(r.time));
+    msg.thread_id = r.thread_id;
+    msg.raw << fmt::StringRef(r.text(), r.text_size);
+    _Dispatch(logger, msg);
+}
+
+// See RingLogger.h
+void RingWriter::_Dispatch(const RingLogger *logger, spdlog::details::log_msg &msg) {
+    try {
+        logger->format(msg);
+        for (const spdlog::sink_ptr &sink : logger->sinks()) {
+            _DispatchTo(sink.get(), msg);
+        }
+    } catch (const std::exception &ex) {
+        std::fprintf(stderr, "Failed to write log record: %s\n", ex.what());
+    }
+}
+
+// See RingLogger.h
+void RingWriter::_DispatchTo(spdlog::sinks::sink *sink, const spdlog::details::log_msg &msg) {
+    if (!sink->should_log(msg.level)) {
+        return;
+    }
+
+    composite_sink *cs = dynamic_cast<composite_sink *>(sink);
+    if (cs != nullptr) {
+        for (const spdlog::sink_ptr &inner : cs->sinks()) {
+            _DispatchTo(inner.get(), msg);
+        }
+        return;
+    }
+
+    batch_sink *bs = dynamic_cast<batch_sink *>(sink);
+    if (bs == nullptr) {
+        sink->log(msg);
+        if (std::find(_touched.begin(), _touched.end(), sink) == _touched.end()) {
+            _touched.push_back(sink);
+        }
+        return;
+    }
+
+    auto it = std::find_if(_batches.begin(), _batches.end(), [bs](const batch &b) { return b.sink == bs; });
+    if (it == _batches.end()) {
+        _batches.push_back(batch{bs, {}});
+        it = _batches.end() - 1;
+    } else if (it->iov.size() + batch_sink::kMaxRecordIov > IOV_MAX) {
+        bs->write_batch(it->iov.data(), static_cast<int>(it->iov.size()));
+        it->iov.clear();
+    }
+
+    // Deque never moves its elements, so iovecs stay valid until the batch is written
+    if (_formatted_used == _formatted.size()) {
+        _formatted.emplace_back();
+    }
+    std::string &text = _formatted[_formatted_used++];
+    text.assign(msg.formatted.data(), msg.formatted.size());
+    bs->add(it->iov, msg.level, text);
+}
+
+// See RingLogger.h
+void RingWriter::_Flush() {
+    for (batch &b : _batches) {
+        try {
+            if (!b.iov.empty()) {
+                b.sink->write_batch(b.iov.data(), static_cast<int>(b.iov.size()));
+            }
+        } catch (const std::exception &ex) {
+            std::fprintf(stderr, "Failed to write log records: %s\n", ex.what());
+        }
+    }
+    _batches.clear();
+    _formatted_used = 0;
+
+    for (spdlog::sinks::sink *sink : _touched) {
+        try {
+            sink->flush();
+        } catch (const std::exception &ex) {
+            std::fprintf(stderr, "Failed to flush log: %s\n", ex.what());
+        }
+    }
+    _touched.clear();
+}
+
+// See RingLogger.h
+RingLogger::~RingLogger() { _writer->Sync(); }
+
+// See RingLogger.h
+void RingLogger::flush() {
+    _writer->Sync();
+    for (const spdlog::sink_ptr &sink : _sinks) {
+        sink->flush();
+    }
+}
+
+// See RingLogger.h
+void RingLogger::_sink_it(spdlog::details::log_msg &msg) {
+    _AppendContext(msg);
+    _writer->Push(this, msg);
+    if (should_flush(msg.level)) {
+        _writer->Wake();
+    }
+}
+
+} // namespace Logging
+} // namespace Afina
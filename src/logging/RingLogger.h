@@ -0,0 +1,317 @@
+#ifndef AFINA_LOGGING_RING_LOGGER_H
+#define AFINA_LOGGING_RING_LOGGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/uio.h>
+
+#include <spdlog/logger.h>
+#include <spdlog/sinks/sink.h>
+
+#include "ContextLogger.h"
+
+namespace Afina {
+namespace Logging {
+
+/**
+ * Interface of sinks able to write many formatted records at once, used by the logging thread to write whole
+ * drained batch with a single system call
+ */
+class batch_sink {
+public:
+    // Max number of iovecs add() puts per record
+    static const int kMaxRecordIov = 3;
+
+    virtual ~batch_sink() {}
+
+    /**
+     * Appends formatted record to the batch being collected. Text stays valid until the batch is written, sink
+     * could put its own memory around it, such as color escapes. Default puts the text as is
+     */
+    virtual void add(std::vector<struct iovec> &batch, spdlog::level::level_enum level, const std::string &text) {
+        struct iovec iov;
+        iov.iov_base = const_cast<char *>(text.data());
+        iov.iov_len = text.size();
+        batch.push_back(iov);
+    }
+
+    /**
+     * Writes all records, array could be modified on partial writes
+     */
+    virtual void write_batch(struct iovec *iov, int count) = 0;
+};
+
+/**
+ * Interface of sinks which only pass records to other ones, such as distribution sink. Logging thread gives
+ * records to the sinks inside, so that they could be batched
+ */
+class composite_sink {
+public:
+    virtual ~composite_sink() {}
+
+    virtual const std::vector<spdlog::sink_ptr> &sinks() const = 0;
+};
+
+/**
+ * # Single producer single consumer ring of records
+ * Records are written contiguously into the byte array, the one that doesn't fit before the end of array is
+ * preceded by the padding record. Producer keeps cached copy of the consumer position, so push touches consumer
+ * cache line only when the ring looks full
+ */
+class RingBuffer {
+public:
+    /**
+     * Record header, text follows
+     */
+    struct record {
+        // Bytes occupied by the record including padding, logger is nullptr for the padding record
+        uint32_t size;
+        uint32_t level;
+        const void *logger;
+        int64_t time;
+        std::size_t thread_id;
+        std::size_t text_size;
+
+        const char *text() const { return reinterpret_cast<const char *>(this + 1); }
+    };
+
+    /**
+     * @param capacity size of the ring in bytes, rounded up to the power of two
+     */
+    explicit RingBuffer(std::size_t capacity);
+    RingBuffer(const RingBuffer &) = delete;
+
+    /**
+     * Copies record into the ring, returns false if there is no space for it. Text longer than quarter of the
+     * ring gets truncated. Called by the producer thread only
+     */
+    bool push(const void *logger, uint32_t level, int64_t time, std::size_t thread_id, const char *text,
+              std::size_t text_size);
+
+    /**
+     * Passes all available records to the callback and frees their space, returns number of records. Called by
+     * the consumer thread only
+     */
+    template <typename F> std::size_t pop(F &&callback) {
+        uint64_t head = _head.load(std::memory_order_relaxed);
+        uint64_t tail = _tail.load(std::memory_order_acquire);
+
+        std::size_t count = 0;
+        while (head != tail) {
+            // Tail of the array too short for the padding record is skipped implicitly
+            const std::size_t offset = head & _mask;
+            if (_mask + 1 - offset < sizeof(record)) {
+                head += _mask + 1 - offset;
+                continue;
+            }
+
+            const record *r = reinterpret_cast<const record *>(&_data[offset]);
+            if (r->logger != nullptr) {
+                callback(*r);
+                count++;
+            }
+            head += r->size;
+        }
+
+        _head.store(head, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * Returns true if there are no records in the ring, could be called by consumer only
+     */
+    bool empty() const { return _head.load(std::memory_order_relaxed) == _tail.load(std::memory_order_acquire); }
+
+private:
+    std::unique_ptr<char[]> _data;
+    std::size_t _mask;
+
+    // Consumer position
+    alignas(64) std::atomic<uint64_t> _head;
+
+    // Producer position
+    alignas(64) std::atomic<uint64_t> _tail;
+    uint64_t _head_cache;
+};
+
+class RingLogger;
+
+/**
+ * # Logging thread
+ * Every thread logging through the writer gets its own ring buffer, so producers never contend with each other.
+ * Background thread drains rings, formats records according to the pattern of the logger and gives them to the
+ * logger sinks; records for batch sinks are collected and written by the single writev per pass.
+ *
+ * Once the ring is full the record is either dropped, dropped records are counted and reported by the next
+ * record written, or producer waits until logging thread frees some space
+ */
+class RingWriter {
+public:
+    enum class Overflow { Drop, Block };
+
+    RingWriter(std::size_t ring_size, Overflow overflow);
+    RingWriter(const RingWriter &) = delete;
+    ~RingWriter();
+
+    /**
+     * Starts logging thread
+     */
+    void Start();
+
+    /**
+     * Writes all pending records and stops logging thread. Records pushed afterwards are dropped
+     */
+    void Stop();
+
+    /**
+     * Puts record into the ring of the calling thread
+     */
+    void Push(const RingLogger *logger, const spdlog::details::log_msg &msg);
+
+    /**
+     * Wakes logging thread up
+     */
+    void Wake();
+
+    /**
+     * Runs task on the logging thread once records pending are written. Tasks posted after stop never run
+     */
+    void Post(std::function<void()> task);
+
+    /**
+     * Waits until all records pushed before the call are written
+     */
+    void Sync();
+
+    /**
+     * Returns number of records dropped so far
+     */
+    uint64_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    // Ring of the single thread, abandoned once thread exits
+    struct ring {
+        explicit ring(std::size_t size) : buffer(size), abandoned(false) {}
+
+        // Buffer positions are aligned to cache lines, plain new ignores such alignment before C++17
+        static void *operator new(std::size_t size);
+        static void operator delete(void *p);
+
+        RingBuffer buffer;
+        std::atomic<bool> abandoned;
+    };
+
+    // Rings of the thread in all writers, abandoned on thread exit
+    struct thread_rings;
+
+    // Records pending for the batch sink
+    struct batch {
+        batch_sink *sink;
+        std::vector<struct iovec> iov;
+    };
+
+    // Returns ring of the calling thread, creates new one if needed
+    ring *_Ring();
+
+    // Logging thread body
+    void _OnRun();
+
+    // Drains all rings once, returns number of records written
+    std::size_t _Drain();
+
+    // Runs tasks posted so far, must be called with the lock held
+    void _RunTasks(std::unique_lock<std::mutex> &lock);
+
+    // Rebuilds message out of the record and writes it
+    void _Write(const RingBuffer::record &r);
+
+    // Formats message and gives it to the sinks of the logger
+    void _Dispatch(const RingLogger *logger, spdlog::details::log_msg &msg);
+
+    // Gives formatted message to the sink, or to the sinks inside of the composite one
+    void _DispatchTo(spdlog::sinks::sink *sink, const spdlog::details::log_msg &msg);
+
+    // Writes collected batches and flushes the rest of sinks touched
+    void _Flush();
+
+    // Writer identifier, never reused
+    const uint64_t _id;
+    const std::size_t _ring_size;
+    const Overflow _overflow;
+
+    std::atomic<uint64_t> _dropped;
+
+    // Protects list of rings, tasks, passes counter and number of threads waiting for sync
+    std::mutex _mutex;
+    std::condition_variable _wakeup;
+    std::condition_variable _synced;
+    std::vector<std::unique_ptr<ring>> _rings;
+    std::vector<std::function<void()>> _tasks;
+    std::atomic<bool> _running;
+    uint64_t _passes;
+    std::size_t _syncing;
+    std::thread _thread;
+
+    // Logging thread state: snapshot of rings, formatted records kept alive until batches are written, batches
+    // and other sinks touched during the pass
+    std::vector<ring *> _drained;
+    std::deque<std::string> _formatted;
+    std::size_t _formatted_used;
+    std::vector<batch> _batches;
+    std::vector<spdlog::sinks::sink *> _touched;
+    uint64_t _reported_drops;
+};
+
+/**
+ * # Logger writing through the rings
+ * Only raw message and thread context are rendered by the calling thread, pattern is applied by the logging thread
+ */
+class RingLogger : public ContextLogger {
+public:
+    template <typename It>
+    RingLogger(const std::string &name, const It &begin, const It &end, std::shared_ptr<RingWriter> writer)
+        : ContextLogger(name, begin, end), _writer(std::move(writer)) {}
+
+    RingLogger(const std::string &name, spdlog::sink_ptr sink, std::shared_ptr<RingWriter> writer)
+        : ContextLogger(name, sink), _writer(std::move(writer)) {}
+
+    ~RingLogger() override;
+
+    /**
+     * Waits until pending records are written and flushes sinks
+     */
+    void flush() override;
+
+    /**
+     * Applies logger pattern to the message, called by the logging thread
+     */
+    void format(spdlog::details::log_msg &msg) const { _formatter->format(msg); }
+
+    /**
+     * Returns true if sinks should be flushed after the record of the given level
+     */
+    bool should_flush(spdlog::level::level_enum level) const {
+        return level >= _flush_level.load(std::memory_order_relaxed);
+    }
+
+protected:
+    void _sink_it(spdlog::details::log_msg &msg) override;
+
+private:
+    std::shared_ptr<RingWriter> _writer;
+};
+
+} // namespace Logging
+} // namespace Afina
+
+#endif // AFINA_LOGGING_RING_LOGGER_H
@@ -1,9 +1,16 @@
 #include "ServiceImpl.h"
 
+#include <cstdio>
 #include <regex>
 #include <sstream>
+#include <string>
 #include <unordered_set>
 #include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
 #include <spdlog/sinks/dist_sink.h>
 #include <spdlog/sinks/file_sinks.h>
@@ -13,35 +20,166 @@
 #include <afina/logging/Config.h>
 #include <afina/logging/Service.h>
 
+#include "ContextLogger.h"
+#include "RingLogger.h"
+
 namespace Afina {
 namespace Logging {
 
+namespace {
+
+// Escapes put around records of each level by colored console, same as spdlog's ansicolor_sink uses
+const std::string kColors[] = {
+    "\033[36m",          // trace: cyan
+    "\033[36m",          // debug: cyan
+    "\033[1m",           // info: bold
+    "\033[33m\033[1m",   // warn: yellow bold
+    "\033[31m\033[1m",   // err: red bold
+    "\033[1m\033[41m",   // critical: bold on red
+    "\033[00m",          // off: reset
+};
+const std::string kColorReset = "\033[00m";
+
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////////////////////
+// Sink writing to the file descriptor, batches of records are written by the single writev. Console colors are
+// added around records by the sink itself, so colored output is batched as well
+///////////////////////////////////////////////////////////////////////////////////////////
+template <class Mutex> class ext_fd_sink : public spdlog::sinks::base_sink<Mutex>, public batch_sink {
+public:
+    explicit ext_fd_sink(int fd, bool color = false) : _fd(fd), _color(color) {}
+    void flush() override {}
+    void add(std::vector<struct iovec> &batch, spdlog::level::level_enum level, const std::string &text) override {
+        struct iovec iov[kMaxRecordIov];
+        batch.insert(batch.end(), iov, iov + _fill(iov, level, text.data(), text.size()));
+    }
+    void write_batch(struct iovec *iov, int count) override {
+        std::lock_guard<Mutex> lock(spdlog::sinks::base_sink<Mutex>::_mutex);
+        _write(iov, count);
+    }
+
+protected:
+    void _sink_it(const spdlog::details::log_msg &msg) override {
+        struct iovec iov[kMaxRecordIov];
+        _write(iov, _fill(iov, msg.level, msg.formatted.data(), msg.formatted.size()));
+    }
+
+    // Describes record text and colors around it, returns number of iovecs used
+    int _fill(struct iovec *iov, spdlog::level::level_enum level, const char *text, std::size_t size) const {
+        int count = 0;
+        if (_color) {
+            iov[count].iov_base = const_cast<char *>(kColors[level].data());
+            iov[count++].iov_len = kColors[level].size();
+        }
+        iov[count].iov_base = const_cast<char *>(text);
+        iov[count++].iov_len = size;
+        if (_color) {
+            iov[count].iov_base = const_cast<char *>(kColorReset.data());
+            iov[count++].iov_len = kColorReset.size();
+        }
+        return count;
+    }
+
+    void _write(struct iovec *iov, int count) {
+        while (count > 0) {
+            ssize_t written = writev(_fd, iov, count);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw spdlog::spdlog_ex("Failed to write log", errno);
+            }
+
+            // Skip records written completely and continue from the middle of the last one
+            std::size_t left = written;
+            while (count > 0 && left >= iov->iov_len) {
+                left -= iov->iov_len;
+                iov++;
+                count--;
+            }
+            if (count > 0) {
+                iov->iov_base = static_cast<char *>(iov->iov_base) + left;
+                iov->iov_len -= left;
+            }
+        }
+    }
+
+    int _fd;
+    const bool _color;
+};
+using ext_fd_sink_mt = ext_fd_sink<std::mutex>;
+
 ///////////////////////////////////////////////////////////////////////////////////////////
-// File sync that could be reopened at any time
+// File sync that could be reopened at any time. Records written one by one, that is without logging thread, are
+// buffered until flush like spdlog's file_helper does, batches go to the file right away
 ///////////////////////////////////////////////////////////////////////////////////////////
-template <class Mutex> class ext_rotate_file_sink : public spdlog::sinks::base_sink<Mutex> {
+template <class Mutex> class ext_rotate_file_sink : public ext_fd_sink<Mutex> {
 public:
-    explicit ext_rotate_file_sink(const spdlog::filename_t &filename, bool truncate = false) : _force_flush(false) {
-        _file_helper.open(filename, truncate);
+    explicit ext_rotate_file_sink(const spdlog::filename_t &filename, bool truncate = false)
+        : ext_fd_sink<Mutex>(-1), _filename(filename) {
+        this->_fd = _open(truncate);
+    }
+    ~ext_rotate_file_sink() {
+        _write_buffer();
+        close(this->_fd);
+    }
+    void flush() override {
+        std::lock_guard<Mutex> lock(spdlog::sinks::base_sink<Mutex>::_mutex);
+        _write_buffer();
+    }
+    void write_batch(struct iovec *iov, int count) override {
+        std::lock_guard<Mutex> lock(spdlog::sinks::base_sink<Mutex>::_mutex);
+        _write_buffer();
+        this->_write(iov, count);
     }
-    void flush() override { _file_helper.flush(); }
-    void set_force_flush(bool force_flush) { _force_flush = force_flush; }
     void reopen() {
-        SPDLOG_DEBUG("Reopen: " + _file_helper.filename());
+        SPDLOG_DEBUG("Reopen: " + _filename);
+
+        // File is opened outside of the lock, writers wait for dup2 only
+        int fd = _open(false);
         std::lock_guard<Mutex> lock(spdlog::sinks::base_sink<Mutex>::_mutex);
-        _file_helper.reopen(false);
+        _write_buffer();
+        dup2(fd, this->_fd);
+        close(fd);
     }
 
 protected:
     void _sink_it(const spdlog::details::log_msg &msg) override {
-        _file_helper.write(msg);
-        if (_force_flush)
-            _file_helper.flush();
+        _buffer.append(msg.formatted.data(), msg.formatted.size());
+        if (_buffer.size() >= kBufferSize) {
+            _write_buffer();
+        }
     }
 
 private:
-    spdlog::details::file_helper _file_helper;
-    bool _force_flush;
+    // Same as stdio buffer of file_helper
+    static const std::size_t kBufferSize = BUFSIZ;
+
+    int _open(bool truncate) {
+        int flags = O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (truncate ? O_TRUNC : 0);
+        int fd = open(_filename.c_str(), flags, 0644);
+        if (fd < 0) {
+            throw spdlog::spdlog_ex("Failed opening file " + _filename + " for writing", errno);
+        }
+        return fd;
+    }
+
+    // Writes records buffered so far, must be called with the lock held
+    void _write_buffer() {
+        if (_buffer.empty()) {
+            return;
+        }
+
+        struct iovec iov;
+        iov.iov_base = &_buffer[0];
+        iov.iov_len = _buffer.size();
+        this->_write(&iov, 1);
+        _buffer.clear();
+    }
+
+    spdlog::filename_t _filename;
+    std::string _buffer;
 };
 using ext_rotate_file_sink_mt = ext_rotate_file_sink<std::mutex>;
 using ext_rotate_file_sink_st = ext_rotate_file_sink<spdlog::details::null_mutex>;
@@ -49,9 +187,9 @@ using ext_rotate_file_sink_st = ext_rotate_file_sink<spdlog::details::null_mutex
 ///////////////////////////////////////////////////////////////////////////////////////////
 // Extension of spdlog's distribution sink which allows to get access to all internal sinks
 ///////////////////////////////////////////////////////////////////////////////////////////
-template <class Mutex> class dist_sink : public spdlog::sinks::dist_sink<Mutex> {
+template <class Mutex> class dist_sink : public spdlog::sinks::dist_sink<Mutex>, public composite_sink {
 public:
-    const std::vector<spdlog::sink_ptr> &sinks() const { return spdlog::sinks::dist_sink<Mutex>::_sinks; }
+    const std::vector<spdlog::sink_ptr> &sinks() const override { return spdlog::sinks::dist_sink<Mutex>::_sinks; }
 };
 using dist_sink_mt = dist_sink<std::mutex>; // TODO: may be use it?
 using dist_sink_st = dist_sink<spdlog::details::null_mutex>;
@@ -60,12 +198,19 @@ using dist_sink_st = dist_sink<spdlog::details::null_mutex>;
 ServiceImpl::ServiceImpl(std::shared_ptr<Config> cfg) : _cfg(std::move(cfg)), _root() {}
 
 // See ServiceImpl.h
-ServiceImpl::~ServiceImpl() = default;
+ServiceImpl::~ServiceImpl() { Stop(); }
 
 // See ServiceImpl.h
 void ServiceImpl::Start() {
-    // Setup spdlog
-    spdlog::set_async_mode(512, spdlog::async_overflow_policy::block_retry, nullptr, std::chrono::seconds(2));
+    // Setup spdlog, records either go through per thread rings or through spdlog queue
+    if (_cfg->ring_size > 0) {
+        auto overflow = _cfg->ring_overflow == Config::Overflow::BLOCK ? RingWriter::Overflow::Block
+                                                                       : RingWriter::Overflow::Drop;
+        _writer = std::make_shared<RingWriter>(_cfg->ring_size, overflow);
+        _writer->Start();
+    } else {
+        spdlog::set_async_mode(512, spdlog::async_overflow_policy::block_retry, nullptr, std::chrono::seconds(2));
+    }
 
     // First build appenders
     std::map<std::string, spdlog::sink_ptr> results;
@@ -78,18 +223,12 @@ void ServiceImpl::Start() {
         spdlog::sink_ptr ptr = nullptr;
         switch (pAppender.type) {
         case Appender::Type::STDOUT: {
-            ptr = spdlog::sinks::stdout_sink_mt::instance();
-            if (pAppender.color) {
-                ptr = std::make_shared<spdlog::sinks::ansicolor_sink>(ptr);
-            }
+            ptr = std::make_shared<ext_fd_sink_mt>(STDOUT_FILENO, pAppender.color);
             break;
         }
 
         case Appender::Type::STDERR: {
-            ptr = spdlog::sinks::stderr_sink_mt::instance();
-            if (pAppender.color) {
-                ptr = std::make_shared<spdlog::sinks::ansicolor_sink>(ptr);
-            }
+            ptr = std::make_shared<ext_fd_sink_mt>(STDERR_FILENO, pAppender.color);
             break;
         }
 
@@ -165,7 +304,12 @@ void ServiceImpl::Start() {
         }
 
         // Create logger
-        std::shared_ptr<spdlog::logger> logger = std::make_shared<spdlog::logger>(name, ptr);
+        std::shared_ptr<spdlog::logger> logger;
+        if (_writer) {
+            logger = std::make_shared<RingLogger>(name, ptr, _writer);
+        } else {
+            logger = std::make_shared<ContextLogger>(name, ptr);
+        }
         logger->set_level(lvl);
         logger->set_pattern(pLogger.format);
         logger->flush_on(spdlog::level::err);
@@ -180,7 +324,11 @@ void ServiceImpl::Start() {
 }
 
 // See ServiceImpl.h
-void ServiceImpl::Stop() {}
+void ServiceImpl::Stop() {
+    if (_writer) {
+        _writer->Stop();
+    }
+}
 
 // See ServiceImpl.h
 std::shared_ptr<spdlog::logger> ServiceImpl::select(const std::string &name) noexcept {
@@ -252,7 +400,12 @@ std::unique_ptr<spdlog::logger> ServiceImpl::create(const std::string &name,
     }
 
     // Done, create formatter
-    auto result = std::unique_ptr<spdlog::logger>(new spdlog::logger(base->name(), sinks.begin(), sinks.end()));
+    std::unique_ptr<spdlog::logger> result;
+    if (_writer) {
+        result.reset(new RingLogger(base->name(), sinks.begin(), sinks.end(), _writer));
+    } else {
+        result.reset(new ContextLogger(base->name(), sinks.begin(), sinks.end()));
+    }
     result->set_level(base->level());
     result->set_pattern(ss.str());
     result->flush_on(spdlog::level::err);
@@ -261,6 +414,16 @@ std::unique_ptr<spdlog::logger> ServiceImpl::create(const std::string &name,
 
 // See ServiceImpl.h
 void ServiceImpl::reopen_all() {
+    // Only logging thread touches sinks, so let it reopen files between records
+    if (_writer) {
+        _writer->Post([this]() { _Reopen(); });
+    } else {
+        _Reopen();
+    }
+}
+
+// See ServiceImpl.h
+void ServiceImpl::_Reopen() {
     // Collect all sinks
     std::deque<spdlog::sink_ptr> sinks;
     auto collect_sinks = [&sinks](std::shared_ptr<spdlog::logger> log) {
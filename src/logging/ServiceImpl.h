@@ -7,6 +7,8 @@
 namespace Afina {
 namespace Logging {
 
+class RingWriter;
+
 /**
  * # Provides loggers for rest of the system
  *
@@ -33,10 +35,16 @@ public:
     void reopen_all() override;
 
 private:
+    // Reopens all file sinks right away
+    void _Reopen();
+
     std::shared_ptr<Config> _cfg;
 
     // TODO: bug: if service not started all select return _root, which is nullptr
     std::shared_ptr<spdlog::logger> _root;
+
+    // Logging thread, if records go through per thread rings
+    std::shared_ptr<RingWriter> _writer;
 };
 
 } // namespace Logging
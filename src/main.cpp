@@ -1,29 +1,64 @@
+#include <cerrno>
 #include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <memory>
+#include <string>
 
 #include <atomic>
 #include <semaphore.h>
 #include <signal.h>
 #include <thread>
+#include <unistd.h>
 
 #include <cxxopts.hpp>
 
 #include <afina/Storage.h>
 #include <afina/Version.h>
+#include <afina/execute/SlowLog.h>
 #include <afina/logging/Service.h>
 #include <afina/network/Server.h>
+#include <afina/storage/Journal.h>
+#include <afina/storage/Snapshot.h>
 
 #include "logging/ServiceImpl.h"
+#include "network/Handoff.h"
 #include "network/mt_blocking/ServerImpl.h"
 #include "network/nonblocking/ServerImpl.h"
 #include "network/st_blocking/ServerImpl.h"
 
+#include "storage/ReadMostlyLRU.h"
+#include "storage/SharedLRU.h"
 #include "storage/SimpleLRU.h"
+#include "storage/SlabLRU.h"
 #include "storage/ThreadSafeSimpleLRU.h"
 
 using namespace Afina;
 
+// Parses --journal-sync value: always, never or positive number of milliseconds, returns false if it is neither
+bool ParseJournalSync(const std::string &policy, Backend::Journal::Sync &sync, std::chrono::milliseconds &interval) {
+    if (policy == "always") {
+        sync = Backend::Journal::Sync::Always;
+        return true;
+    }
+    if (policy == "never") {
+        sync = Backend::Journal::Sync::Never;
+        return true;
+    }
+    if (policy.empty() || policy.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+
+    errno = 0;
+    const unsigned long long ms = std::strtoull(policy.c_str(), nullptr, 10);
+    if (errno != 0 || ms == 0 || ms > static_cast<unsigned long long>(std::chrono::milliseconds::max().count())) {
+        return false;
+    }
+    sync = Backend::Journal::Sync::Periodic;
+    interval = std::chrono::milliseconds(ms);
+    return true;
+}
+
 /**
  * Whole application class
  */
@@ -49,14 +84,69 @@ public:
             storage_type = options["storage"].as<std::string>();
         }
 
+        // Slab storages could be backed by huge pages, others use general purpose heap
+        const bool huge_pages = options.count("hugepages") > 0;
         if (storage_type == "st_lru") {
             storage = std::make_shared<Afina::Backend::SimpleLRU>();
         } else if (storage_type == "mt_lru") {
             storage = std::make_shared<Afina::Backend::ThreadSafeSimplLRU>();
+        } else if (storage_type == "st_slab") {
+            storage = std::make_shared<Afina::Backend::SlabLRU>(64 << 20, 1 << 20, huge_pages);
+        } else if (storage_type == "mt_slab") {
+            storage = std::make_shared<Afina::Backend::ThreadSafeSlabLRU>(64 << 20, 1 << 20, huge_pages);
+        } else if (storage_type == "st_clock") {
+            storage = std::make_shared<Afina::Backend::ClockLRU>();
+        } else if (storage_type == "mt_clock") {
+            storage = std::make_shared<Afina::Backend::ThreadSafeClockLRU>();
+        } else if (storage_type == "rw_lru") {
+            storage = std::make_shared<Afina::Backend::ReadMostlyLRU>();
+        } else if (storage_type == "shm") {
+            // Cache is kept in the named segment, the next process picks it up
+            std::string name = "/afina";
+            if (options.count("shm-name") > 0) {
+                name = options["shm-name"].as<std::string>();
+            }
+            storage = std::make_shared<Afina::Backend::SharedLRU>(name, 64 << 20);
         } else {
             throw std::runtime_error("Unknown storage type");
         }
 
+        // Changes are logged to be replayed on start, on top of the snapshot if there is one
+        std::shared_ptr<Afina::Backend::Journal> journal;
+        if (options.count("journal") > 0) {
+            auto sync = Afina::Backend::Journal::Sync::Periodic;
+            std::chrono::milliseconds sync_interval(1000);
+            if (options.count("journal-sync") > 0) {
+                // Value is validated by main()
+                ParseJournalSync(options["journal-sync"].as<std::string>(), sync, sync_interval);
+            }
+
+            journal = std::make_shared<Afina::Backend::Journal>(storage, options["journal"].as<std::string>(), sync,
+                                                                sync_interval);
+            storage = journal;
+        }
+
+        // Storage content survives restarts if there is a snapshot file
+        if (options.count("snapshot") > 0) {
+            std::chrono::seconds interval(0);
+            if (options.count("snapshot-interval") > 0) {
+                interval = std::chrono::seconds(options["snapshot-interval"].as<uint32_t>());
+            }
+            snapshot.reset(new Afina::Backend::Snapshot(storage, options["snapshot"].as<std::string>(), interval));
+
+            // Journal segments covered by the saved snapshot aren't needed anymore
+            if (journal) {
+                snapshot->OnFinish([journal](bool ok) { journal->Compact(ok); });
+            }
+        }
+
+        // Commands slower than threshold are kept for "stats slowlog". Clock gets calibrated here rather than by
+        // the first request, that takes few milliseconds
+        Afina::Execute::TscClock::ticks_per_ns();
+        if (options.count("slowlog-us") > 0) {
+            Afina::Execute::SlowLog::Global().SetThreshold(options["slowlog-us"].as<uint64_t>());
+        }
+
         // Step 2: Configure network
         std::string network_type = "st_block";
         if (options.count("network") > 0) {
@@ -72,6 +162,11 @@ public:
         } else {
             throw std::runtime_error("Unknown network type");
         }
+
+        // Restarted server takes listening socket over from the running one, so no connection is refused
+        if (options.count("handoff") > 0) {
+            handoff.reset(new Afina::Network::Handoff(options["handoff"].as<std::string>(), logService));
+        }
     }
 
     // Start services in correct order
@@ -80,22 +175,70 @@ public:
         auto log = logService->select("root");
         log->warn("Start afina server {}", Afina::get_version());
 
+        // Snapshot goes first, journal replays changes made after it when storage starts
+        if (snapshot) {
+            log->warn("Load snapshot");
+            log->warn("Loaded {} items", snapshot->Load());
+        }
+
         log->warn("Start storage");
         storage->Start();
+        if (snapshot) {
+            snapshot->Start();
+        }
 
         // TODO: configure network service
         const uint16_t port = 8080;
+        if (handoff) {
+            int socket = handoff->Request();
+            if (socket != -1) {
+                log->warn("Took listening socket over from the previous process");
+                server->UseListenSocket(socket);
+            }
+        }
+
         log->warn("Start network on {}", port);
         server->Start(port, 2, 2);
+
+        // Previous process stops once this one accepts connections, then this one waits for the next process.
+        // Being taken over stops it the same way as SIGTERM does
+        if (handoff) {
+            handoff->Confirm();
+            handoff->Start(server->ListenSocket(), []() { kill(getpid(), SIGTERM); });
+        }
+    }
+
+    // Reopen log files, they could be rotated
+    void ReopenLogs() {
+        logService->select("root")->warn("Reopen log files");
+        logService->reopen_all();
     }
 
     // Stop services in correct order
     void Stop() {
         auto log = logService->select("root");
         log->warn("Stop application");
+        if (handoff) {
+            handoff->Stop();
+        }
         server->Stop();
         server->Join();
 
+        // Nothing changes storage anymore, save it for the next start
+        if (snapshot) {
+            log->warn("Save snapshot");
+            try {
+                snapshot->Wait();
+                snapshot->Trigger();
+                if (!snapshot->Wait()) {
+                    log->error("Failed to save snapshot");
+                }
+            } catch (std::exception &e) {
+                log->error("Failed to save snapshot: {}", e.what());
+            }
+            snapshot->Stop();
+        }
+
         storage->Stop();
         logService->Stop();
     }
@@ -105,19 +248,30 @@ private:
     std::shared_ptr<Afina::Logging::Service> logService;
 
     std::shared_ptr<Afina::Storage> storage;
+    std::unique_ptr<Afina::Backend::Snapshot> snapshot;
     std::shared_ptr<Afina::Network::Server> server;
+    std::unique_ptr<Afina::Network::Handoff> handoff;
 };
 
 // Signal set that to notify application about time to stop
 sem_t stop_semaphore;
 volatile sig_atomic_t stop_reason = 0;
 
+// Signal set that to ask application to reopen log files
+volatile sig_atomic_t reopen_logs = 0;
+
 // Catch user desire to stop the server
 void on_term(int signum, siginfo_t *siginfo, void *data) {
     stop_reason = signum;
     sem_post(&stop_semaphore);
 }
 
+// Catch request to reopen logs, actual work is done by the main thread
+void on_hup(int signum, siginfo_t *siginfo, void *data) {
+    reopen_logs = 1;
+    sem_post(&stop_semaphore);
+}
+
 int main(int argc, char **argv) {
     // Command line arguments parsing
     cxxopts::Options options("afina", "Simple memory caching server");
@@ -126,6 +280,25 @@ int main(int argc, char **argv) {
         // and simplify validation below
         options.add_options()("s,storage", "Type of storage service to use", cxxopts::value<std::string>());
         options.add_options()("n,network", "Type of network service to use", cxxopts::value<std::string>());
+        options.add_options()("hugepages", "Back slab storage by 2MB pages if possible");
+        options.add_options()("shm-name", "Shared memory segment of shm storage (default /afina)",
+                              cxxopts::value<std::string>());
+        options.add_options()("slowlog-us", "Record commands running longer, microseconds (default 10000)",
+                              cxxopts::value<uint64_t>());
+        options.add_options()("snapshot", "Load storage from the file on start, save it there on stop or by command",
+                              cxxopts::value<std::string>());
+        options.add_options()("snapshot-interval", "Also save snapshot that often, seconds",
+                              cxxopts::value<uint32_t>());
+        options.add_options()("journal", "Log storage changes to files with the prefix, replay them on start",
+                              cxxopts::value<std::string>());
+        options.add_options()("journal-sync", "Sync journal: always, never or every N milliseconds (default 1000)",
+                              cxxopts::value<std::string>());
+        options.add_options()("handoff", "Take listening socket over from the process serving the unix socket, "
+                                         "then serve it for the next one. Can't be used with snapshot or journal: "
+                                         "both processes serve for a while, changes made by the previous one "
+                                         "would be lost and its stop would overwrite files of the next one. Use "
+                                         "shm storage to keep the cache",
+                              cxxopts::value<std::string>());
         options.add_options()("h,help", "Print usage info");
         options.parse(argc, argv);
 
@@ -133,6 +306,21 @@ int main(int argc, char **argv) {
             std::cerr << options.help() << std::endl;
             return 0;
         }
+
+        if (options.count("handoff") > 0 && (options.count("snapshot") > 0 || options.count("journal") > 0)) {
+            std::cerr << "Error: --handoff can't be used with --snapshot or --journal" << std::endl;
+            return 1;
+        }
+
+        if (options.count("journal-sync") > 0) {
+            auto sync = Backend::Journal::Sync::Periodic;
+            std::chrono::milliseconds interval(0);
+            if (!ParseJournalSync(options["journal-sync"].as<std::string>(), sync, interval)) {
+                std::cerr << "Error: --journal-sync must be always, never or positive number of milliseconds"
+                          << std::endl;
+                return 1;
+            }
+        }
     } catch (cxxopts::OptionParseException &ex) {
         std::cerr << "Error: " << ex.what() << std::endl;
         return 1;
@@ -158,6 +346,9 @@ int main(int argc, char **argv) {
 
         sigaction(SIGINT, &act, NULL);
         sigaction(SIGTERM, &act, NULL);
+
+        act.sa_sigaction = on_hup;
+        sigaction(SIGHUP, &act, NULL);
     }
 
     // Run app
@@ -165,9 +356,16 @@ int main(int argc, char **argv) {
         // Start services
         app.Start();
 
-        // Freeze main thread until one of signals arrive
-        while (stop_reason == 0 && ((sem_wait(&stop_semaphore) == -1) && (errno == EINTR))) {
-            continue;
+        // Freeze main thread until one of signals arrive, reopen logs on the way if asked to
+        while (stop_reason == 0) {
+            if (sem_wait(&stop_semaphore) == -1 && errno != EINTR) {
+                break;
+            }
+
+            if (reopen_logs != 0) {
+                reopen_logs = 0;
+                app.ReopenLogs();
+            }
         }
 
         // Stop services
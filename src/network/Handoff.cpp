@@ -0,0 +1,249 @@
+#include "Handoff.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/logging/Service.h>
+
+namespace Afina {
+namespace Network {
+
+namespace {
+
+// How long each side waits for the other one
+const int kTimeoutSeconds = 10;
+
+void SetTimeouts(int socket) {
+    struct timeval tv;
+    tv.tv_sec = kTimeoutSeconds;
+    tv.tv_usec = 0;
+    setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+struct sockaddr_un Address(const std::string &path) {
+    struct sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Handoff path is too long: " + path);
+    }
+    std::memcpy(addr.sun_path, path.data(), path.size());
+    return addr;
+}
+
+} // namespace
+
+// See Handoff.h
+Handoff::Handoff(const std::string &path, std::shared_ptr<Logging::Service> pl)
+    : _path(path), _logging(pl), _peer(-1), _socket(-1), _listen_socket(-1), _event_fd(-1), _taken_over(false) {}
+
+// See Handoff.h
+Handoff::~Handoff() {
+    Stop();
+    if (_peer != -1) {
+        close(_peer);
+    }
+}
+
+// See Handoff.h
+int Handoff::Request() {
+    struct sockaddr_un addr = Address(_path);
+    int peer = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (peer == -1) {
+        throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
+    }
+
+    // Nobody serves the path, or process serving it is gone
+    if (connect(peer, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        const int error = errno;
+        close(peer);
+        if (error == ENOENT || error == ECONNREFUSED) {
+            return -1;
+        }
+        throw std::runtime_error("Failed to connect to " + _path + ": " + strerror(error));
+    }
+    SetTimeouts(peer);
+
+    char byte;
+    struct iovec iov;
+    iov.iov_base = &byte;
+    iov.iov_len = 1;
+
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    ssize_t n = recvmsg(peer, &msg, MSG_CMSG_CLOEXEC);
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (n != 1 || cmsg == nullptr || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS ||
+        cmsg->cmsg_len != CMSG_LEN(sizeof(int))) {
+        close(peer);
+        throw std::runtime_error("Process serving " + _path + " didn't hand listening socket off");
+    }
+
+    int listen_socket;
+    std::memcpy(&listen_socket, CMSG_DATA(cmsg), sizeof(int));
+    _peer = peer;
+    return listen_socket;
+}
+
+// See Handoff.h
+void Handoff::Confirm() {
+    if (_peer == -1) {
+        return;
+    }
+
+    // Previous process doesn't stop if confirmation is lost, both keep serving then
+    const char byte = 1;
+    if (send(_peer, &byte, 1, MSG_NOSIGNAL) != 1) {
+        close(_peer);
+        _peer = -1;
+        throw std::runtime_error("Failed to confirm handoff: " + std::string(strerror(errno)));
+    }
+    close(_peer);
+    _peer = -1;
+}
+
+// See Handoff.h
+void Handoff::Start(int listen_socket, std::function<void()> on_takeover) {
+    _logger = _logging->select("network");
+    _listen_socket = listen_socket;
+    _on_takeover = std::move(on_takeover);
+
+    // Path left by the previous process or the one which crashed
+    struct sockaddr_un addr = Address(_path);
+    unlink(_path.c_str());
+
+    _socket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (_socket == -1) {
+        throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
+    }
+
+    if (bind(_socket, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(_socket, 1) == -1) {
+        const int error = errno;
+        close(_socket);
+        _socket = -1;
+        throw std::runtime_error("Failed to listen on " + _path + ": " + strerror(error));
+    }
+
+    _event_fd = eventfd(0, EFD_CLOEXEC);
+    if (_event_fd == -1) {
+        close(_socket);
+        _socket = -1;
+        throw std::runtime_error("Failed to create eventfd");
+    }
+
+    _thread = std::thread(&Handoff::OnRun, this);
+}
+
+// See Handoff.h
+void Handoff::Stop() {
+    if (_socket == -1) {
+        return;
+    }
+
+    eventfd_write(_event_fd, 1);
+    _thread.join();
+    close(_event_fd);
+    close(_socket);
+    _socket = -1;
+
+    // Path belongs to the next process already
+    if (!_taken_over.load()) {
+        unlink(_path.c_str());
+    }
+}
+
+// See Handoff.h
+void Handoff::OnRun() {
+    while (!_taken_over.load()) {
+        struct pollfd fds[2] = {{_socket, POLLIN, 0}, {_event_fd, POLLIN, 0}};
+        if (poll(fds, 2, -1) == -1 && errno != EINTR) {
+            _logger->error("Handoff poll() failed: {}", strerror(errno));
+            break;
+        }
+        if (fds[1].revents != 0) {
+            break;
+        }
+        if (fds[0].revents == 0) {
+            continue;
+        }
+
+        int client = accept4(_socket, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client == -1) {
+            continue;
+        }
+
+        _logger->warn("Next process requested listening socket");
+        if (_Serve(client)) {
+            _logger->warn("Listening socket is taken over by the next process");
+            _taken_over.store(true);
+            _on_takeover();
+        } else {
+            _logger->error("Next process failed to take listening socket over, keep serving");
+        }
+        close(client);
+    }
+}
+
+// See Handoff.h
+bool Handoff::_Serve(int client) {
+    SetTimeouts(client);
+
+    char byte = 1;
+    struct iovec iov;
+    iov.iov_base = &byte;
+    iov.iov_len = 1;
+
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    std::memset(&control, 0, sizeof(control));
+
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(cmsg), &_listen_socket, sizeof(int));
+
+    if (sendmsg(client, &msg, MSG_NOSIGNAL) != 1) {
+        return false;
+    }
+
+    // Next process confirms once it accepts connections, nothing comes if it dies or times out. Stop() doesn't
+    // wait for it
+    struct pollfd fds[2] = {{client, POLLIN, 0}, {_event_fd, POLLIN, 0}};
+    if (poll(fds, 2, kTimeoutSeconds * 1000) <= 0 || fds[1].revents != 0) {
+        return false;
+    }
+    return recv(client, &byte, 1, MSG_DONTWAIT) == 1;
+}
+
+} // namespace Network
+} // namespace Afina
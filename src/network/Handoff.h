@@ -0,0 +1,86 @@
+#ifndef AFINA_NETWORK_HANDOFF_H
+#define AFINA_NETWORK_HANDOFF_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+namespace Logging {
+class Service;
+}
+namespace Network {
+
+/**
+ * # Listening socket handoff between processes
+ * Running process serves the unix domain socket at the given path. New process connects there, receives the
+ * listening socket by SCM_RIGHTS and starts accepting on it, so the port is never closed and connections queued
+ * in the backlog are served by either of processes. Once the new one confirms it accepts connections, the old one
+ * is told to stop and drains its connections as Server::Stop() says. If the new process fails before that, the
+ * old one keeps serving.
+ *
+ * Live connections stay with the old process until they are drained, their protocol state can't be moved.
+ */
+class Handoff {
+public:
+    Handoff(const std::string &path, std::shared_ptr<Logging::Service> pl);
+    ~Handoff();
+
+    /**
+     * Asks the process serving the path for its listening socket. Returns -1 if there is no such process. Throws
+     * std::runtime_error if the process is there but handoff failed
+     */
+    int Request();
+
+    /**
+     * Tells the previous process that this one accepts connections now, so it could stop. Does nothing if
+     * Request() got no socket
+     */
+    void Confirm();
+
+    /**
+     * Serves the path for the next process: hands listening socket off and calls on_takeover from the handoff
+     * thread once the next process confirmed. Throws std::runtime_error if path can't be bound
+     */
+    void Start(int listen_socket, std::function<void()> on_takeover);
+
+    /**
+     * Stops serving the path, removes it unless the next process took it over
+     */
+    void Stop();
+
+private:
+    void OnRun();
+
+    // Hands listening socket off to the connected process, returns true if it confirmed
+    bool _Serve(int client);
+
+    std::string _path;
+    std::shared_ptr<Logging::Service> _logging;
+    std::shared_ptr<spdlog::logger> _logger;
+
+    // Connection to the previous process between Request() and Confirm()
+    int _peer;
+
+    // Socket served for the next process and the listening one to hand off
+    int _socket;
+    int _listen_socket;
+
+    // Event to wake handoff thread up on stop
+    int _event_fd;
+
+    std::function<void()> _on_takeover;
+    std::atomic<bool> _taken_over;
+    std::thread _thread;
+};
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_HANDOFF_H
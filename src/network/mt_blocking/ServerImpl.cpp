@@ -7,10 +7,13 @@
 #include <stdexcept>
 
 #include <arpa/inet.h>
+#include <fcntl.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <pthread.h>
+#include <poll.h>
 #include <signal.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -18,7 +21,11 @@
 #include <spdlog/logger.h>
 
 #include <afina/Storage.h>
+#include <afina/allocator/Arena.h>
 #include <afina/execute/Command.h>
+#include <afina/execute/SlowLog.h>
+#include <afina/logging/Context.h>
+#include <afina/logging/Log.h>
 #include <afina/logging/Service.h>
 
 #include "protocol/Parser.h"
@@ -40,31 +47,41 @@ void ServerImpl::_StartWorker(int client_socket, int index) {
     // - command_to_execute: last command parsed out of stream
     // - arg_remains: how many bytes to read from stream to get command argument
     // - argument_for_command: buffer stores argument
+    // - result: buffer stores response
+    // - arena: request scoped memory, command lives there and everything gets released after response is sent
     std::size_t arg_remains;
     Protocol::Parser parser;
     std::string argument_for_command;
-    std::unique_ptr<Execute::Command> command_to_execute;
+    std::string result;
+    Allocator::Arena arena;
+    Execute::CommandPtr command_to_execute;
+
+    // Records logged while serving the connection are tagged with it, command name is empty between commands
+    const Logging::PeerAddress client(client_socket);
+    Logging::ContextTag conn_tag("conn", client_socket);
+    Logging::ContextTag client_tag("client", client);
+    Logging::ContextTag command_tag("cmd", parser.Name());
 
     try {
         int readed_bytes = -1;
         char client_buffer[4096];
         while ((readed_bytes = read(client_socket, client_buffer, sizeof(client_buffer))) > 0) {
-            _logger->debug("Got {} bytes from socket", readed_bytes);
+            AFINA_DEBUG(_logger, "Got {} bytes from socket", readed_bytes);
 
             // Single block of data readed from the socket could trigger inside actions a multiple times,
             // for example:
             // - read#0: [<command1 start>]
             // - read#1: [<command1 end> <argument> <command2> <argument for command 2> <command3> ... ]
             while (readed_bytes > 0) {
-                _logger->debug("Process {} bytes", readed_bytes);
+                AFINA_DEBUG(_logger, "Process {} bytes", readed_bytes);
                 // There is no command yet
                 if (!command_to_execute) {
                     std::size_t parsed = 0;
                     if (parser.Parse(client_buffer, readed_bytes, parsed)) {
                         // There is no command to be launched, continue to parse input stream
                         // Here we are, current chunk finished some command, process it
-                        _logger->debug("Found new command: {} in {} bytes", parser.Name(), parsed);
-                        command_to_execute = parser.Build(arg_remains);
+                        AFINA_DEBUG(_logger, "Found new command: {} in {} bytes", parser.Name(), parsed);
+                        command_to_execute = parser.Build(arg_remains, arena);
                         if (arg_remains > 0) {
                             arg_remains += 2;
                         }
@@ -82,7 +99,7 @@ void ServerImpl::_StartWorker(int client_socket, int index) {
 
                 // There is command, but we still wait for argument to arrive...
                 if (command_to_execute && arg_remains > 0) {
-                    _logger->debug("Fill argument: {} bytes of {}", readed_bytes, arg_remains);
+                    AFINA_DEBUG(_logger, "Fill argument: {} bytes of {}", readed_bytes, arg_remains);
                     // There is some parsed command, and now we are reading argument
                     std::size_t to_read = std::min(arg_remains, std::size_t(readed_bytes));
                     argument_for_command.append(client_buffer, to_read);
@@ -94,12 +111,20 @@ void ServerImpl::_StartWorker(int client_socket, int index) {
 
                 // Thre is command & argument - RUN!
                 if (command_to_execute && arg_remains == 0) {
-                    _logger->debug("Start command execution");
+                    AFINA_DEBUG(_logger, "Start command execution");
 
-                    std::string result;
+                    result.resize(0);
+                    const uint64_t started = Execute::TscClock::now();
                     command_to_execute->Execute(*pStorage, argument_for_command, result);
 
-                    // Send response
+                    const uint64_t elapsed = Execute::TscClock::now() - started;
+                    if (Execute::SlowLog::Global().IsSlow(elapsed)) {
+                        Execute::SlowLog::Global().Add(parser.Name(), parser.Keys().size(), argument_for_command.size(),
+                                                       result.size(), client.c_str(), elapsed);
+                    }
+
+                    // Send response, commands leave the last \r\n to the network layer
+                    result += "\r\n";
                     if (send(client_socket, result.data(), result.size(), 0) <= 0) {
                         throw std::runtime_error("Failed to send response");
                     }
@@ -107,13 +132,14 @@ void ServerImpl::_StartWorker(int client_socket, int index) {
                     // Prepare for the next command
                     command_to_execute.reset();
                     argument_for_command.resize(0);
+                    arena.reset();
                     parser.Reset();
                 }
             } // while (readed_bytes)
         }
 
         if (readed_bytes == 0) {
-            _logger->debug("Connection closed");
+            AFINA_DEBUG(_logger, "Connection closed");
         } else {
             throw std::runtime_error(std::string(strerror(errno)));
         }
@@ -125,6 +151,7 @@ void ServerImpl::_StartWorker(int client_socket, int index) {
 
     command_to_execute.reset();
     argument_for_command.resize(0);
+    arena.reset();
     parser.Reset();
     // std::cout<<"Start"<<std::endl; //debug
     {
@@ -150,31 +177,47 @@ void ServerImpl::Start(uint16_t port, uint32_t n_accept, uint32_t n_workers) {
         throw std::runtime_error("Unable to mask SIGPIPE");
     }
 
-    struct sockaddr_in server_addr;
-    std::memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;         // IPv4
-    server_addr.sin_port = htons(port);       // TCP port number
-    server_addr.sin_addr.s_addr = INADDR_ANY; // Bind to any address
-
-    _server_socket = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+    // Socket could be received from the previous process already bound and listening
+    _server_socket = inheritedSocket;
     if (_server_socket == -1) {
-        throw std::runtime_error("Failed to open socket");
-    }
+        struct sockaddr_in server_addr;
+        std::memset(&server_addr, 0, sizeof(server_addr));
+        server_addr.sin_family = AF_INET;         // IPv4
+        server_addr.sin_port = htons(port);       // TCP port number
+        server_addr.sin_addr.s_addr = INADDR_ANY; // Bind to any address
+
+        _server_socket = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (_server_socket == -1) {
+            throw std::runtime_error("Failed to open socket");
+        }
 
-    int opts = 1;
-    if (setsockopt(_server_socket, SOL_SOCKET, SO_REUSEADDR, &opts, sizeof(opts)) == -1) {
-        close(_server_socket);
-        throw std::runtime_error("Socket setsockopt() failed");
+        int opts = 1;
+        if (setsockopt(_server_socket, SOL_SOCKET, SO_REUSEADDR, &opts, sizeof(opts)) == -1) {
+            close(_server_socket);
+            throw std::runtime_error("Socket setsockopt() failed");
+        }
+
+        if (bind(_server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
+            close(_server_socket);
+            throw std::runtime_error("Socket bind() failed");
+        }
+
+        if (listen(_server_socket, SOMAXCONN) == -1) {
+            close(_server_socket);
+            throw std::runtime_error("Socket listen() failed");
+        }
     }
 
-    if (bind(_server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
+    // Acceptor waits for connection together with the stop event, see st_blocking
+    if (fcntl(_server_socket, F_SETFL, fcntl(_server_socket, F_GETFL, 0) | O_NONBLOCK) == -1) {
         close(_server_socket);
-        throw std::runtime_error("Socket bind() failed");
+        throw std::runtime_error("Socket fcntl() failed");
     }
 
-    if (listen(_server_socket, 5) == -1) {
+    _event_fd = eventfd(0, EFD_CLOEXEC);
+    if (_event_fd == -1) {
         close(_server_socket);
-        throw std::runtime_error("Socket listen() failed");
+        throw std::runtime_error("Failed to create eventfd");
     }
 
     // initial pointers(memory) for workers
@@ -193,7 +236,7 @@ void ServerImpl::Start(uint16_t port, uint32_t n_accept, uint32_t n_workers) {
 // See Server.h
 void ServerImpl::Stop() {
     running.store(false);
-    shutdown(_server_socket, SHUT_RDWR);
+    eventfd_write(_event_fd, 1);
 }
 
 // See Server.h
@@ -216,6 +259,7 @@ void ServerImpl::Join() {
 
     assert(_thread.joinable());
     _thread.join();
+    close(_event_fd);
     close(_server_socket);
 }
 
@@ -223,9 +267,14 @@ void ServerImpl::Join() {
 void ServerImpl::OnRun() {
 
     while (running.load()) {
-        _logger->debug("waiting for connection...");
+        AFINA_DEBUG(_logger, "waiting for connection...");
+
+        // The call to poll() blocks until the incoming connection arrives or server stops
+        struct pollfd fds[2] = {{_server_socket, POLLIN, 0}, {_event_fd, POLLIN, 0}};
+        if (poll(fds, 2, -1) == -1 || fds[1].revents != 0) {
+            continue;
+        }
 
-        // The call to accept() blocks until the incoming connection arrives
         int client_socket;
         struct sockaddr client_addr;
         socklen_t client_addr_len = sizeof(client_addr);
@@ -234,7 +283,7 @@ void ServerImpl::OnRun() {
         }
 
         // Got new connection
-        if (_logger->should_log(spdlog::level::debug)) {
+        if (AFINA_LOG_ENABLED(_logger, DEBUG)) {
             std::string host = "unknown", port = "-1";
 
             char hbuf[NI_MAXHOST], sbuf[NI_MAXSERV];
@@ -38,6 +38,9 @@ public:
     // See Server.h
     void Join() override;
 
+    // See Server.h
+    int ListenSocket() const override { return _server_socket; }
+
     void _StartWorker(int client_socket, int index);
 
 protected:
@@ -64,6 +67,9 @@ private:
 
     // Server socket to accept connections on
     int _server_socket;
+
+    // Event to wake acceptor up on stop
+    int _event_fd;
     // cond variable for wake up on join
     std::condition_variable _ready_join;
 
@@ -5,13 +5,15 @@
 
 #include <sys/epoll.h>
 
+#include <afina/logging/Context.h>
+
 namespace Afina {
 namespace Network {
 namespace NonBlocking {
 
 class Connection {
 public:
-    Connection(int s) : _socket(s) { std::memset(&_event, 0, sizeof(struct epoll_event)); }
+    Connection(int s) : _socket(s), _peer(s) { std::memset(&_event, 0, sizeof(struct epoll_event)); }
 
     inline bool isAlive() const { return true; }
 
@@ -29,6 +31,9 @@ private:
 
     int _socket;
     struct epoll_event _event;
+
+    // Captured on accept, records are tagged with it
+    Logging::PeerAddress _peer;
 };
 
 } // namespace NonBlocking
@@ -35,6 +35,9 @@ public:
     // See Server.h
     void Join() override;
 
+    // See Server.h
+    int ListenSocket() const override { return _server_socket; }
+
 protected:
     void OnRun();
     void OnNewConnection();
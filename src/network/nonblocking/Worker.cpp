@@ -11,6 +11,8 @@
 
 #include <spdlog/logger.h>
 
+#include <afina/logging/Context.h>
+#include <afina/logging/Log.h>
 #include <afina/logging/Service.h>
 
 #include "Connection.h"
@@ -68,7 +70,7 @@ void Worker::Join() {
 // See Worker.h
 void Worker::OnRun() {
     assert(_epoll_fd >= 0);
-    _logger->trace("OnRun");
+    AFINA_TRACE(_logger, "OnRun");
 
     // Process connection events
     //
@@ -78,7 +80,7 @@ void Worker::OnRun() {
     std::array<struct epoll_event, 64> mod_list;
     while (isRunning) {
         int nmod = epoll_wait(_epoll_fd, &mod_list[0], mod_list.size(), timeout);
-        _logger->debug("Worker wokeup: {} events", nmod);
+        AFINA_DEBUG(_logger, "Worker wokeup: {} events", nmod);
 
         for (int i = 0; i < nmod; i++) {
             struct epoll_event &current_event = mod_list[i];
@@ -90,8 +92,10 @@ void Worker::OnRun() {
                 continue;
             }
 
-            // Some connection gets new data
+            // Some connection gets new data, records logged meanwhile are tagged with it
             Connection *pconn = static_cast<Connection *>(current_event.data.ptr);
+            Logging::ContextTag conn_tag("conn", pconn->_socket);
+            Logging::ContextTag client_tag("client", pconn->_peer);
             if ((current_event.events & EPOLLERR) || (current_event.events & EPOLLHUP)) {
                 pconn->OnError();
             } else if (current_event.events & EPOLLRDHUP) {
@@ -7,10 +7,13 @@
 #include <stdexcept>
 
 #include <arpa/inet.h>
+#include <fcntl.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <pthread.h>
+#include <poll.h>
 #include <signal.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -18,7 +21,11 @@
 #include <spdlog/logger.h>
 
 #include <afina/Storage.h>
+#include <afina/allocator/Arena.h>
 #include <afina/execute/Command.h>
+#include <afina/execute/SlowLog.h>
+#include <afina/logging/Context.h>
+#include <afina/logging/Log.h>
 #include <afina/logging/Service.h>
 
 #include "protocol/Parser.h"
@@ -48,57 +55,75 @@ void ServerImpl::Start(uint16_t port, uint32_t n_accept, uint32_t n_workers) {
         throw std::runtime_error("Unable to mask SIGPIPE");
     }
 
-    // For IPv4 we use struct sockaddr_in:
-    // struct sockaddr_in {
-    //     short int          sin_family;  // Address family, AF_INET
-    //     unsigned short int sin_port;    // Port number
-    //     struct in_addr     sin_addr;    // Internet address
-    //     unsigned char      sin_zero[8]; // Same size as struct sockaddr
-    // };
-    //
-    // Note we need to convert the port to network order
-    struct sockaddr_in server_addr;
-    std::memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;         // IPv4
-    server_addr.sin_port = htons(port);       // TCP port number
-    server_addr.sin_addr.s_addr = INADDR_ANY; // Bind to any address
-
-    // Arguments are:
-    // - Family: IPv4
-    // - Type: Full-duplex stream (reliable)
-    // - Protocol: TCP
-    _server_socket = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+    // Socket could be received from the previous process already bound and listening
+    _server_socket = inheritedSocket;
     if (_server_socket == -1) {
-        throw std::runtime_error("Failed to open socket");
-    }
+        // For IPv4 we use struct sockaddr_in:
+        // struct sockaddr_in {
+        //     short int          sin_family;  // Address family, AF_INET
+        //     unsigned short int sin_port;    // Port number
+        //     struct in_addr     sin_addr;    // Internet address
+        //     unsigned char      sin_zero[8]; // Same size as struct sockaddr
+        // };
+        //
+        // Note we need to convert the port to network order
+        struct sockaddr_in server_addr;
+        std::memset(&server_addr, 0, sizeof(server_addr));
+        server_addr.sin_family = AF_INET;         // IPv4
+        server_addr.sin_port = htons(port);       // TCP port number
+        server_addr.sin_addr.s_addr = INADDR_ANY; // Bind to any address
+
+        // Arguments are:
+        // - Family: IPv4
+        // - Type: Full-duplex stream (reliable)
+        // - Protocol: TCP
+        _server_socket = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (_server_socket == -1) {
+            throw std::runtime_error("Failed to open socket");
+        }
 
-    // when the server closes the socket,the connection must stay in the TIME_WAIT state to
-    // make sure the client received the acknowledgement that the connection has been terminated.
-    // During this time, this port is unavailable to other processes, unless we specify this option
-    //
-    // This option let kernel knows that we are OK that multiple threads/processes are listen on the
-    // same port. In a such case kernel will balance input traffic between all listeners (except those who
-    // are closed already)
-    int opts = 1;
-    if (setsockopt(_server_socket, SOL_SOCKET, SO_REUSEADDR, &opts, sizeof(opts)) == -1) {
-        close(_server_socket);
-        throw std::runtime_error("Socket setsockopt() failed");
+        // when the server closes the socket,the connection must stay in the TIME_WAIT state to
+        // make sure the client received the acknowledgement that the connection has been terminated.
+        // During this time, this port is unavailable to other processes, unless we specify this option
+        //
+        // This option let kernel knows that we are OK that multiple threads/processes are listen on the
+        // same port. In a such case kernel will balance input traffic between all listeners (except those who
+        // are closed already)
+        int opts = 1;
+        if (setsockopt(_server_socket, SOL_SOCKET, SO_REUSEADDR, &opts, sizeof(opts)) == -1) {
+            close(_server_socket);
+            throw std::runtime_error("Socket setsockopt() failed");
+        }
+
+        // Bind the socket to the address. In other words let kernel know data for what address we'd
+        // like to see in the socket
+        if (bind(_server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
+            close(_server_socket);
+            throw std::runtime_error("Socket bind() failed");
+        }
+
+        // Start listening. The second parameter is the "backlog", or the maximum number of
+        // connections that we'll allow to queue up. Note that listen() doesn't block until
+        // incoming connections arrive. It just makesthe OS aware that this process is willing
+        // to accept connections on this socket (which is bound to a specific IP and port)
+        if (listen(_server_socket, SOMAXCONN) == -1) {
+            close(_server_socket);
+            throw std::runtime_error("Socket listen() failed");
+        }
     }
 
-    // Bind the socket to the address. In other words let kernel know data for what address we'd
-    // like to see in the socket
-    if (bind(_server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
+    // Socket is non blocking, so accept() doesn't hang once other thread or process took the connection. Acceptor
+    // waits for it together with the stop event, shutdown() can't be used to wake it up because socket could be
+    // shared with the next process
+    if (fcntl(_server_socket, F_SETFL, fcntl(_server_socket, F_GETFL, 0) | O_NONBLOCK) == -1) {
         close(_server_socket);
-        throw std::runtime_error("Socket bind() failed");
+        throw std::runtime_error("Socket fcntl() failed");
     }
 
-    // Start listening. The second parameter is the "backlog", or the maximum number of
-    // connections that we'll allow to queue up. Note that listen() doesn't block until
-    // incoming connections arrive. It just makesthe OS aware that this process is willing
-    // to accept connections on this socket (which is bound to a specific IP and port)
-    if (listen(_server_socket, 5) == -1) {
+    _event_fd = eventfd(0, EFD_CLOEXEC);
+    if (_event_fd == -1) {
         close(_server_socket);
-        throw std::runtime_error("Socket listen() failed");
+        throw std::runtime_error("Failed to create eventfd");
     }
 
     running.store(true);
@@ -108,13 +133,14 @@ void ServerImpl::Start(uint16_t port, uint32_t n_accept, uint32_t n_workers) {
 // See Server.h
 void ServerImpl::Stop() {
     running.store(false);
-    shutdown(_server_socket, SHUT_RDWR);
+    eventfd_write(_event_fd, 1);
 }
 
 // See Server.h
 void ServerImpl::Join() {
     assert(_thread.joinable());
     _thread.join();
+    close(_event_fd);
     close(_server_socket);
 }
 
@@ -125,14 +151,23 @@ void ServerImpl::OnRun() {
     // - command_to_execute: last command parsed out of stream
     // - arg_remains: how many bytes to read from stream to get command argument
     // - argument_for_command: buffer stores argument
+    // - result: buffer stores response
+    // - arena: request scoped memory, command lives there and everything gets released after response is sent
     std::size_t arg_remains;
     Protocol::Parser parser;
     std::string argument_for_command;
-    std::unique_ptr<Execute::Command> command_to_execute;
+    std::string result;
+    Allocator::Arena arena;
+    Execute::CommandPtr command_to_execute;
     while (running.load()) {
-        _logger->debug("waiting for connection...");
+        AFINA_DEBUG(_logger, "waiting for connection...");
+
+        // The call to poll() blocks until the incoming connection arrives or server stops
+        struct pollfd fds[2] = {{_server_socket, POLLIN, 0}, {_event_fd, POLLIN, 0}};
+        if (poll(fds, 2, -1) == -1 || fds[1].revents != 0) {
+            continue;
+        }
 
-        // The call to accept() blocks until the incoming connection arrives
         int client_socket;
         struct sockaddr client_addr;
         socklen_t client_addr_len = sizeof(client_addr);
@@ -141,7 +176,7 @@ void ServerImpl::OnRun() {
         }
 
         // Got new connection
-        if (_logger->should_log(spdlog::level::debug)) {
+        if (AFINA_LOG_ENABLED(_logger, DEBUG)) {
             std::string host = "unknown", port = "-1";
 
             char hbuf[NI_MAXHOST], sbuf[NI_MAXSERV];
@@ -161,6 +196,12 @@ void ServerImpl::OnRun() {
             setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, (const char *)&tv, sizeof tv);
         }
 
+        // Records logged while serving the connection are tagged with it, command name is empty between commands
+        const Logging::PeerAddress client(client_socket);
+        Logging::ContextTag conn_tag("conn", client_socket);
+        Logging::ContextTag client_tag("client", client);
+        Logging::ContextTag command_tag("cmd", parser.Name());
+
         // Process new connection:
         // - read commands until socket alive
         // - execute each command
@@ -169,22 +210,22 @@ void ServerImpl::OnRun() {
             int readed_bytes = -1;
             char client_buffer[4096];
             while ((readed_bytes = read(client_socket, client_buffer, sizeof(client_buffer))) > 0) {
-                _logger->debug("Got {} bytes from socket", readed_bytes);
+                AFINA_DEBUG(_logger, "Got {} bytes from socket", readed_bytes);
 
                 // Single block of data readed from the socket could trigger inside actions a multiple times,
                 // for example:
                 // - read#0: [<command1 start>]
                 // - read#1: [<command1 end> <argument> <command2> <argument for command 2> <command3> ... ]
                 while (readed_bytes > 0) {
-                    _logger->debug("Process {} bytes", readed_bytes);
+                    AFINA_DEBUG(_logger, "Process {} bytes", readed_bytes);
                     // There is no command yet
                     if (!command_to_execute) {
                         std::size_t parsed = 0;
                         if (parser.Parse(client_buffer, readed_bytes, parsed)) {
                             // There is no command to be launched, continue to parse input stream
                             // Here we are, current chunk finished some command, process it
-                            _logger->debug("Found new command: {} in {} bytes", parser.Name(), parsed);
-                            command_to_execute = parser.Build(arg_remains);
+                            AFINA_DEBUG(_logger, "Found new command: {} in {} bytes", parser.Name(), parsed);
+                            command_to_execute = parser.Build(arg_remains, arena);
                             if (arg_remains > 0) {
                                 arg_remains += 2;
                             }
@@ -202,7 +243,7 @@ void ServerImpl::OnRun() {
 
                     // There is command, but we still wait for argument to arrive...
                     if (command_to_execute && arg_remains > 0) {
-                        _logger->debug("Fill argument: {} bytes of {}", readed_bytes, arg_remains);
+                        AFINA_DEBUG(_logger, "Fill argument: {} bytes of {}", readed_bytes, arg_remains);
                         // There is some parsed command, and now we are reading argument
                         std::size_t to_read = std::min(arg_remains, std::size_t(readed_bytes));
                         argument_for_command.append(client_buffer, to_read);
@@ -214,12 +255,21 @@ void ServerImpl::OnRun() {
 
                     // Thre is command & argument - RUN!
                     if (command_to_execute && arg_remains == 0) {
-                        _logger->debug("Start command execution");
+                        AFINA_DEBUG(_logger, "Start command execution");
 
-                        std::string result;
+                        result.resize(0);
+                        const uint64_t started = Execute::TscClock::now();
                         command_to_execute->Execute(*pStorage, argument_for_command, result);
 
-                        // Send response
+                        const uint64_t elapsed = Execute::TscClock::now() - started;
+                        if (Execute::SlowLog::Global().IsSlow(elapsed)) {
+                            Execute::SlowLog::Global().Add(parser.Name(), parser.Keys().size(),
+                                                           argument_for_command.size(), result.size(), client.c_str(),
+                                                           elapsed);
+                        }
+
+                        // Send response, commands leave the last \r\n to the network layer
+                        result += "\r\n";
                         if (send(client_socket, result.data(), result.size(), 0) <= 0) {
                             throw std::runtime_error("Failed to send response");
                         }
@@ -227,13 +277,14 @@ void ServerImpl::OnRun() {
                         // Prepare for the next command
                         command_to_execute.reset();
                         argument_for_command.resize(0);
+                        arena.reset();
                         parser.Reset();
                     }
                 } // while (readed_bytes)
             }
 
             if (readed_bytes == 0) {
-                _logger->debug("Connection closed");
+                AFINA_DEBUG(_logger, "Connection closed");
             } else {
                 throw std::runtime_error(std::string(strerror(errno)));
             }
@@ -247,6 +298,7 @@ void ServerImpl::OnRun() {
         // Prepare for the next command: just in case if connection was closed in the middle of executing something
         command_to_execute.reset();
         argument_for_command.resize(0);
+        arena.reset();
         parser.Reset();
     }
 
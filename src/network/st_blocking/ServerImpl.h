@@ -32,6 +32,9 @@ public:
     // See Server.h
     void Join() override;
 
+    // See Server.h
+    int ListenSocket() const override { return _server_socket; }
+
 protected:
     /**
      * Method is running in the connection acceptor thread
@@ -50,6 +53,9 @@ private:
     // Server socket to accept connections on
     int _server_socket;
 
+    // Event to wake acceptor up on stop
+    int _event_fd;
+
     // Thread to run network on
     std::thread _thread;
 };
@@ -3,13 +3,16 @@
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <utility>
 
+#include <afina/allocator/Arena.h>
 #include <afina/execute/Add.h>
 #include <afina/execute/Append.h>
 #include <afina/execute/Command.h>
 #include <afina/execute/Delete.h>
 #include <afina/execute/Get.h>
 #include <afina/execute/Set.h>
+#include <afina/execute/Snapshot.h>
 #include <afina/execute/Stats.h>
 
 namespace Afina {
@@ -32,7 +35,9 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
                     state = State::spKey;
                 } else if (name == "get" || name == "gets") {
                     state = State::sgKey;
-                } else if (name == "stats") {
+                } else if (name == "stats" && c == ' ') {
+                    state = State::sgKey;
+                } else if (name == "stats" || name == "snapshot") {
                     state = State::sLF;
                     continue;
                 } else {
@@ -161,23 +166,51 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
     return parse_complete;
 }
 
+namespace {
+
+// Creates command on heap or in the arena
+template <typename T, typename... Args> Execute::CommandPtr Make(Allocator::Arena *arena, Args &&... args) {
+    if (arena == nullptr) {
+        return Execute::CommandPtr(new T(std::forward<Args>(args)...));
+    }
+    return Execute::CommandPtr(arena->make<T>(std::forward<Args>(args)...), Execute::CommandDeleter(true));
+}
+
+} // namespace
+
 // See Parse.h
 std::unique_ptr<Execute::Command> Parser::Build(size_t &body_size) const {
+    return std::unique_ptr<Execute::Command>(_Build(body_size, nullptr).release());
+}
+
+// See Parse.h
+Execute::CommandPtr Parser::Build(size_t &body_size, Allocator::Arena &arena) const {
+    return _Build(body_size, &arena);
+}
+
+// See Parse.h
+Execute::CommandPtr Parser::_Build(size_t &body_size, Allocator::Arena *arena) const {
     if (state != State::sLF) {
-        return std::unique_ptr<Execute::Command>(nullptr);
+        return Execute::CommandPtr(nullptr);
     }
 
     body_size = bytes;
     if (name == "set") {
-        return std::unique_ptr<Execute::Command>(new Execute::Set(keys[0], flags, exprtime));
+        return Make<Execute::Set>(arena, keys[0], flags, exprtime);
     } else if (name == "add") {
-        return std::unique_ptr<Execute::Command>(new Execute::Add(keys[0], flags, exprtime));
+        return Make<Execute::Add>(arena, keys[0], flags, exprtime);
     } else if (name == "append") {
-        return std::unique_ptr<Execute::Command>(new Execute::Append(keys[0], flags, exprtime));
+        return Make<Execute::Append>(arena, keys[0], flags, exprtime);
     } else if (name == "get") {
-        return std::unique_ptr<Execute::Command>(new Execute::Get(keys));
+        // Keys go to the same arena as the command
+        if (arena != nullptr) {
+            return Make<Execute::Get>(arena, keys, *arena);
+        }
+        return Make<Execute::Get>(arena, keys);
     } else if (name == "stats") {
-        return std::unique_ptr<Execute::Command>(new Execute::Stats());
+        return Make<Execute::Stats>(arena, keys);
+    } else if (name == "snapshot") {
+        return Make<Execute::Snapshot>(arena);
     } else {
         throw std::runtime_error("Unsupported command");
     }
@@ -8,10 +8,12 @@
 #include <cstddef>
 #include <cstdint>
 
+#include <afina/execute/Command.h>
+
 namespace Afina {
-namespace Execute {
-class Command;
-} // namespace Execute
+namespace Allocator {
+class Arena;
+} // namespace Allocator
 namespace Protocol {
 
 /**
@@ -48,14 +50,24 @@ public:
      */
     std::unique_ptr<Execute::Command> Build(size_t &body_size) const;
 
+    /**
+     * Same as above, but command is placed into the given arena, so building it doesn't touch heap
+     * once arena is warmed up. Command must be destroyed before the arena gets reset
+     */
+    Execute::CommandPtr Build(size_t &body_size, Allocator::Arena &arena) const;
+
     /**
      * Reset parse so that it could be used to parse out new command
      */
     void Reset();
 
     inline const std::string &Name() const { return name; }
+    inline const std::vector<std::string> &Keys() const { return keys; }
 
 private:
+    // Creates command of the parsed type on heap or in the arena, if one is given
+    Execute::CommandPtr _Build(size_t &body_size, Allocator::Arena *arena) const;
+
     /**
      * State of the command parser. Prefixes are:
      * - s: state for PUT and GET commands
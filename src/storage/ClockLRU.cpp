@@ -0,0 +1,165 @@
+#include "ClockLRU.h"
+
+namespace Afina {
+namespace Backend {
+
+// See ClockLRU.h
+ClockLRU::ClockLRU(std::size_t max_size) : _max_size(max_size), _free_size(max_size), _hand(0), _evictions(0) {}
+
+// See ClockLRU.h
+bool ClockLRU::Put(const std::string &key, const std::string &value) {
+    if (key.size() + value.size() > _max_size) {
+        return false;
+    }
+
+    auto it = _index.find(key);
+    if (it == _index.end()) {
+        _Insert(key, value);
+    } else {
+        _Update(it, value);
+    }
+    return true;
+}
+
+// See ClockLRU.h
+bool ClockLRU::PutIfAbsent(const std::string &key, const std::string &value) {
+    if (key.size() + value.size() > _max_size || _index.find(key) != _index.end()) {
+        return false;
+    }
+    _Insert(key, value);
+    return true;
+}
+
+// See ClockLRU.h
+bool ClockLRU::Set(const std::string &key, const std::string &value) {
+    if (key.size() + value.size() > _max_size) {
+        return false;
+    }
+
+    auto it = _index.find(key);
+    if (it == _index.end()) {
+        return false;
+    }
+    _Update(it, value);
+    return true;
+}
+
+// See ClockLRU.h
+bool ClockLRU::Delete(const std::string &key) {
+    auto it = _index.find(key);
+    if (it == _index.end()) {
+        return false;
+    }
+    _Remove(it);
+    return true;
+}
+
+// See ClockLRU.h
+bool ClockLRU::Get(const std::string &key, std::string &value) {
+    auto it = _index.find(key);
+    if (it == _index.end()) {
+        return false;
+    }
+
+    slot &s = _slots[it->second];
+    s.referenced = true;
+    value = s.value;
+    return true;
+}
+
+// See ClockLRU.h
+void ClockLRU::Stats(std::vector<std::pair<std::string, std::string>> &stats) {
+    stats.emplace_back("storage_items", std::to_string(_index.size()));
+    stats.emplace_back("storage_evictions", std::to_string(_evictions));
+    stats.emplace_back("storage_used_bytes", std::to_string(_max_size - _free_size));
+    stats.emplace_back("clock_slots", std::to_string(_slots.size()));
+}
+
+// See ClockLRU.h
+void ClockLRU::ForEach(const std::function<void(const std::string &key, const std::string &value)> &visitor) {
+    for (std::size_t i = 0; i < _slots.size(); i++) {
+        const slot &s = _slots[(_hand + i) % _slots.size()];
+        if (s.key != nullptr) {
+            visitor(*s.key, s.value);
+        }
+    }
+}
+
+// See ClockLRU.h
+void ClockLRU::_Insert(const std::string &key, const std::string &value) {
+    const std::size_t size = key.size() + value.size();
+    while (size > _free_size) {
+        _Evict();
+    }
+
+    uint32_t n;
+    if (!_free_slots.empty()) {
+        n = _free_slots.back();
+        _free_slots.pop_back();
+    } else {
+        n = _slots.size();
+        _slots.push_back(slot{nullptr, std::string(), false});
+    }
+
+    auto it = _index.emplace(key, n).first;
+    slot &s = _slots[n];
+    s.key = &it->first;
+    s.value = value;
+    s.referenced = false;
+    _free_size -= size;
+}
+
+// See ClockLRU.h
+void ClockLRU::_Update(index::iterator it, const std::string &value) {
+    // Value fits, it is replaced in place
+    slot &s = _slots[it->second];
+    if (value.size() <= s.value.size() + _free_size) {
+        _free_size = _free_size + s.value.size() - value.size();
+        s.value = value;
+        s.referenced = true;
+        return;
+    }
+
+    // Otherwise other items are evicted, but not this one
+    const std::string key = it->first;
+    _Remove(it);
+    _Insert(key, value);
+}
+
+// See ClockLRU.h
+void ClockLRU::_Remove(index::iterator it) {
+    slot &s = _slots[it->second];
+    _free_size += it->first.size() + s.value.size();
+    _free_slots.push_back(it->second);
+
+    s.key = nullptr;
+    s.value.clear();
+    s.value.shrink_to_fit();
+    s.referenced = false;
+    _index.erase(it);
+}
+
+// See ClockLRU.h
+void ClockLRU::_Evict() {
+    // Every slot passed loses its bit, so the hand stops within two rounds
+    for (;;) {
+        slot &s = _slots[_hand];
+        _hand = (_hand + 1) % _slots.size();
+
+        if (s.key == nullptr) {
+            continue;
+        }
+        if (s.referenced) {
+            s.referenced = false;
+            continue;
+        }
+
+        // Inserted item takes the slot right behind the hand
+        _Remove(_index.find(*s.key));
+        _evictions++;
+        return;
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,92 @@
+#ifndef AFINA_STORAGE_CLOCK_LRU_H
+#define AFINA_STORAGE_CLOCK_LRU_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # CLOCK approximation of LRU
+ * Items live in the circular array of slots, each one has a reference bit. Hit only sets the bit, there is no
+ * list to reorder. To make space the hand goes around the array: referenced item gets its bit cleared and stays,
+ * the first one which isn't referenced is evicted. Slot of the evicted item is reused by the item being inserted,
+ * so it has the whole round to get referenced.
+ *
+ * Item costs a slot and an index entry, key is kept in the index only. Same byte budget as SimpleLRU: sum of key
+ * and value sizes of all items doesn't exceed max_size. That is NOT thread safe implementation.
+ */
+class ClockLRU : public Afina::Storage {
+public:
+    ClockLRU(std::size_t max_size = 1024);
+    ~ClockLRU() {}
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override;
+
+    // Implements Afina::Storage interface
+    void Stats(std::vector<std::pair<std::string, std::string>> &stats) override;
+
+    // Implements Afina::Storage interface, items are visited in the order hand reaches them
+    void ForEach(const std::function<void(const std::string &key, const std::string &value)> &visitor) override;
+
+private:
+    struct slot {
+        // Key in the index, nullptr if slot is free
+        const std::string *key;
+        std::string value;
+        bool referenced;
+    };
+
+    using index = std::unordered_map<std::string, uint32_t>;
+
+    // Places new item, evicts others if needed
+    void _Insert(const std::string &key, const std::string &value);
+
+    // Replaces value of the existing item, evicts others if needed
+    void _Update(index::iterator it, const std::string &value);
+
+    // Removes item and frees its slot
+    void _Remove(index::iterator it);
+
+    // Moves the hand until unreferenced item is found and evicts it
+    void _Evict();
+
+    std::size_t _max_size;
+    std::size_t _free_size;
+
+    index _index;
+    std::vector<slot> _slots;
+
+    // Free slots, the last one is reused first
+    std::vector<uint32_t> _free_slots;
+
+    // Slot to be checked next by eviction
+    uint32_t _hand;
+
+    uint64_t _evictions;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_CLOCK_LRU_H
@@ -0,0 +1,18 @@
+#ifndef AFINA_STORAGE_CRC32_H
+#define AFINA_STORAGE_CRC32_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * Continues CRC32 (IEEE) of the data, start with zero
+ */
+uint32_t Crc32(uint32_t crc, const char *data, std::size_t size);
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_CRC32_H
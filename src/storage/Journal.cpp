@@ -0,0 +1,538 @@
+#include <afina/storage/Journal.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <unistd.h>
+
+#include "Crc32.h"
+
+namespace Afina {
+namespace Backend {
+
+namespace {
+
+const char kPut = 1;
+const char kDelete = 2;
+
+// Record header: type, key size, value size
+const std::size_t kHeaderSize = 9;
+
+// Batch is written once it grows that large even if queue isn't drained yet
+const std::size_t kMaxBatch = 1 << 20;
+
+// Writer wakes up that often even if nobody asks it to
+const std::chrono::milliseconds kIdleInterval(100);
+
+void AppendInt(std::string &out, uint64_t value, std::size_t bytes) {
+    for (std::size_t i = 0; i < bytes; i++) {
+        out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+uint64_t ParseInt(const char *data, std::size_t bytes) {
+    uint64_t value = 0;
+    for (std::size_t i = 0; i < bytes; i++) {
+        value |= uint64_t(static_cast<uint8_t>(data[i])) << (8 * i);
+    }
+    return value;
+}
+
+// Syncs directory entry of the file, so created file survives crash
+void SyncDirectory(const std::string &file) {
+    std::string path = file;
+    int dir = open(dirname(&path[0]), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir >= 0) {
+        fsync(dir);
+        close(dir);
+    }
+}
+
+} // namespace
+
+// See Journal.h
+Journal::Journal(std::shared_ptr<Afina::Storage> storage, const std::string &path, Sync sync,
+                 std::chrono::milliseconds sync_interval)
+    : _storage(storage), _path(path), _sync(sync), _sync_interval(sync_interval), _stripes(new std::mutex[kStripes]),
+      _logging(false), _head(&_stub), _tail(&_stub), _running(false), _sleeping(false), _segment(0), _fd(-1),
+      _dirty(false), _replayed(0), _records(0), _bytes(0), _batches(0), _syncs(0), _errors(0) {}
+
+// See Journal.h
+Journal::~Journal() {
+    Stop();
+    while (node *n = _Pop()) {
+        if (!n->wait) {
+            delete n;
+        }
+    }
+}
+
+// See Journal.h
+void Journal::Start() {
+    _storage->Start();
+    if (_running) {
+        return;
+    }
+
+    const std::vector<uint64_t> segments = _Segments();
+    _replayed = 0;
+    for (uint64_t segment : segments) {
+        _replayed += _Replay(_SegmentPath(segment));
+    }
+
+    // Segments are never appended after restart, the torn tail could be there
+    _segment = segments.empty() ? 1 : segments.back() + 1;
+    _Open(_segment);
+    if (_fd < 0) {
+        throw std::runtime_error("Failed to create " + _SegmentPath(_segment) + ": " + strerror(errno));
+    }
+
+    _logging = true;
+    _running = true;
+    _thread = std::thread(&Journal::_OnRun, this);
+}
+
+// See Journal.h
+void Journal::Stop() {
+    if (_running.exchange(false)) {
+        {
+            std::lock_guard<std::mutex> lock(_wakeup_mutex);
+            _wakeup.notify_all();
+        }
+        _thread.join();
+
+        _logging = false;
+        close(_fd);
+        _fd = -1;
+
+        // Wrapped storage is stopped once, destructor stops the journal again
+        _storage->Stop();
+    }
+}
+
+// See Journal.h
+bool Journal::Put(const std::string &key, const std::string &value) {
+    node record;
+    {
+        std::lock_guard<std::mutex> lock(_Stripe(key));
+        if (!_storage->Put(key, value)) {
+            return false;
+        }
+        _Log(record, kPut, key, value);
+    }
+    _Wait(record);
+    return true;
+}
+
+// See Journal.h
+bool Journal::PutIfAbsent(const std::string &key, const std::string &value) {
+    node record;
+    {
+        std::lock_guard<std::mutex> lock(_Stripe(key));
+        if (!_storage->PutIfAbsent(key, value)) {
+            return false;
+        }
+        _Log(record, kPut, key, value);
+    }
+    _Wait(record);
+    return true;
+}
+
+// See Journal.h
+bool Journal::Set(const std::string &key, const std::string &value) {
+    node record;
+    {
+        std::lock_guard<std::mutex> lock(_Stripe(key));
+        if (!_storage->Set(key, value)) {
+            return false;
+        }
+        _Log(record, kPut, key, value);
+    }
+    _Wait(record);
+    return true;
+}
+
+// See Journal.h
+bool Journal::Delete(const std::string &key) {
+    node record;
+    {
+        std::lock_guard<std::mutex> lock(_Stripe(key));
+        if (!_storage->Delete(key)) {
+            return false;
+        }
+        _Log(record, kDelete, key, std::string());
+    }
+    _Wait(record);
+    return true;
+}
+
+// See Journal.h
+bool Journal::Get(const std::string &key, std::string &value) { return _storage->Get(key, value); }
+
+// See Journal.h
+void Journal::Stats(std::vector<std::pair<std::string, std::string>> &stats) {
+    _storage->Stats(stats);
+    stats.emplace_back("journal_sync", SyncName(_sync));
+    stats.emplace_back("journal_segment", std::to_string(_segment.load()));
+    stats.emplace_back("journal_replayed", std::to_string(_replayed));
+    stats.emplace_back("journal_records", std::to_string(_records.load()));
+    stats.emplace_back("journal_bytes", std::to_string(_bytes.load()));
+    stats.emplace_back("journal_batches", std::to_string(_batches.load()));
+    stats.emplace_back("journal_syncs", std::to_string(_syncs.load()));
+    stats.emplace_back("journal_errors", std::to_string(_errors.load()));
+}
+
+// See Journal.h
+void Journal::ForEach(const std::function<void(const std::string &key, const std::string &value)> &visitor) {
+    _storage->ForEach(visitor);
+}
+
+// See Journal.h
+void Journal::ForEachUnlocked(const std::function<void(const std::string &key, const std::string &value)> &visitor) {
+    _storage->ForEachUnlocked(visitor);
+}
+
+// See Journal.h
+void Journal::Exclusive(const std::function<void()> &fn) {
+    _storage->Exclusive([this, &fn] {
+        // Records pushed before this point have been applied, so anything fn sees is covered by previous segments
+        uint64_t checkpoint = 0;
+        if (_logging) {
+            checkpoint = ++_segment;
+            node *n = new node;
+            n->segment = checkpoint;
+            _Push(n);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_compact_mutex);
+            _checkpoints.push_back(checkpoint);
+        }
+        fn();
+    });
+}
+
+// See Journal.h
+void Journal::Compact(bool saved) {
+    uint64_t checkpoint;
+    {
+        std::lock_guard<std::mutex> lock(_compact_mutex);
+        if (_checkpoints.empty()) {
+            return;
+        }
+        checkpoint = _checkpoints.front();
+        _checkpoints.pop_front();
+    }
+
+    if (saved && checkpoint > 0) {
+        for (uint64_t segment : _Segments()) {
+            if (segment < checkpoint) {
+                unlink(_SegmentPath(segment).c_str());
+            }
+        }
+    }
+}
+
+// See Journal.h
+const char *Journal::SyncName(Sync sync) {
+    switch (sync) {
+    case Sync::Always:
+        return "always";
+    case Sync::Periodic:
+        return "periodic";
+    default:
+        return "never";
+    }
+}
+
+// See Journal.h
+void Journal::_Encode(node &n, char type, const std::string &key, const std::string &value) {
+    n.data.reserve(kHeaderSize + key.size() + value.size() + 4);
+    n.data.push_back(type);
+    AppendInt(n.data, key.size(), 4);
+    AppendInt(n.data, value.size(), 4);
+    n.data.append(key);
+    n.data.append(value);
+    AppendInt(n.data, Crc32(0, n.data.data(), n.data.size()), 4);
+}
+
+// See Journal.h
+void Journal::_Push(node *n) {
+    n->next.store(nullptr, std::memory_order_relaxed);
+    node *prev = _head.exchange(n, std::memory_order_acq_rel);
+    prev->next.store(n, std::memory_order_release);
+
+    // Pairs with the fence in _OnRun: either writer sees the node or we see it sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_sleeping.load(std::memory_order_relaxed) && _sleeping.exchange(false)) {
+        std::lock_guard<std::mutex> lock(_wakeup_mutex);
+        _wakeup.notify_one();
+    }
+}
+
+// See Journal.h
+Journal::node *Journal::_Pop() {
+    node *tail = _tail;
+    node *next = tail->next.load(std::memory_order_acquire);
+    if (tail == &_stub) {
+        if (next == nullptr) {
+            return nullptr;
+        }
+        _tail = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next != nullptr) {
+        _tail = next;
+        return tail;
+    }
+
+    // Producer has taken the head, but hasn't linked it yet
+    if (tail != _head.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+
+    // The last node could be popped only when there is one after it
+    _Push(&_stub);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next != nullptr) {
+        _tail = next;
+        return tail;
+    }
+    return nullptr;
+}
+
+// See Journal.h
+void Journal::_Log(node &record, char type, const std::string &key, const std::string &value) {
+    if (!_logging) {
+        return;
+    }
+
+    if (_sync == Sync::Always) {
+        record.wait = true;
+        _Encode(record, type, key, value);
+        _Push(&record);
+    } else {
+        node *n = new node;
+        _Encode(*n, type, key, value);
+        _Push(n);
+    }
+}
+
+// See Journal.h
+void Journal::_Wait(node &record) {
+    if (record.wait) {
+        std::unique_lock<std::mutex> lock(_synced_mutex);
+        _synced.wait(lock, [&record] { return record.done; });
+    }
+}
+
+// See Journal.h
+std::mutex &Journal::_Stripe(const std::string &key) { return _stripes[std::hash<std::string>()(key) % kStripes]; }
+
+// See Journal.h
+std::size_t Journal::_Replay(const std::string &file) {
+    std::ifstream in(file, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return 0;
+    }
+    uint64_t remains = in.tellg();
+    in.seekg(0);
+
+    std::size_t records = 0;
+    std::string record;
+    char header[kHeaderSize];
+    while (remains >= kHeaderSize + 4 && in.read(header, kHeaderSize)) {
+        const uint64_t key_size = ParseInt(header + 1, 4);
+        const uint64_t value_size = ParseInt(header + 5, 4);
+        const uint64_t size = kHeaderSize + key_size + value_size + 4;
+        if (size > remains || (header[0] != kPut && header[0] != kDelete)) {
+            break;
+        }
+
+        record.assign(header, kHeaderSize);
+        record.resize(size);
+        if (!in.read(&record[kHeaderSize], size - kHeaderSize) ||
+            Crc32(0, record.data(), size - 4) != ParseInt(&record[size - 4], 4)) {
+            break;
+        }
+        remains -= size;
+
+        const std::string key = record.substr(kHeaderSize, key_size);
+        if (header[0] == kPut) {
+            _storage->Put(key, record.substr(kHeaderSize + key_size, value_size));
+        } else {
+            _storage->Delete(key);
+        }
+        records++;
+    }
+    return records;
+}
+
+// See Journal.h
+std::vector<uint64_t> Journal::_Segments() const {
+    std::string dir_path = _path, base_path = _path;
+    const std::string dir_name = dirname(&dir_path[0]);
+    const std::string prefix = std::string(basename(&base_path[0])) + ".";
+
+    std::vector<uint64_t> segments;
+    DIR *dir = opendir(dir_name.c_str());
+    if (dir == nullptr) {
+        return segments;
+    }
+    while (struct dirent *entry = readdir(dir)) {
+        const std::string name = entry->d_name;
+        if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0 &&
+            std::all_of(name.begin() + prefix.size(), name.end(), [](char c) { return std::isdigit(c); })) {
+            segments.push_back(std::stoull(name.substr(prefix.size())));
+        }
+    }
+    closedir(dir);
+
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+// See Journal.h
+std::string Journal::_SegmentPath(uint64_t segment) const { return _path + "." + std::to_string(segment); }
+
+// See Journal.h
+void Journal::_Open(uint64_t segment) {
+    if (_fd >= 0) {
+        close(_fd);
+    }
+
+    const std::string path = _SegmentPath(segment);
+    _fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (_fd < 0) {
+        _errors++;
+        return;
+    }
+    SyncDirectory(path);
+}
+
+// See Journal.h
+void Journal::_Write(const std::string &batch) {
+    std::size_t written = 0;
+    while (_fd >= 0 && written < batch.size()) {
+        ssize_t n = write(_fd, batch.data() + written, batch.size() - written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n <= 0) {
+            _errors++;
+            break;
+        }
+        written += n;
+    }
+
+    if (_fd < 0 && !batch.empty()) {
+        _errors++;
+    }
+    _bytes += written;
+    _dirty = _dirty || written > 0;
+}
+
+// See Journal.h
+void Journal::_Sync() {
+    if (!_dirty || _sync == Sync::Never) {
+        return;
+    }
+    if (fdatasync(_fd) != 0) {
+        _errors++;
+    }
+    _syncs++;
+    _dirty = false;
+}
+
+// See Journal.h
+void Journal::_OnRun() {
+    std::string batch;
+    std::vector<node *> waiters;
+    auto last_sync = std::chrono::steady_clock::now();
+
+    while (true) {
+        // Everything pushed before Stop() is written before exit
+        const bool running = _running.load();
+
+        std::size_t records = 0;
+        while (node *n = _Pop()) {
+            if (n->segment != 0) {
+                // Queued records belong to the current segment
+                _Write(batch);
+                batch.clear();
+                _Sync();
+                _Open(n->segment);
+                delete n;
+                continue;
+            }
+
+            batch += n->data;
+            records++;
+            if (n->wait) {
+                waiters.push_back(n);
+            } else {
+                delete n;
+            }
+
+            if (batch.size() >= kMaxBatch) {
+                _Write(batch);
+                batch.clear();
+            }
+        }
+
+        if (!batch.empty()) {
+            _Write(batch);
+            batch.clear();
+        }
+        if (records > 0) {
+            _records += records;
+            _batches++;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (!waiters.empty() || (_sync == Sync::Periodic && _dirty && now - last_sync >= _sync_interval)) {
+            _Sync();
+            last_sync = now;
+        }
+        if (!waiters.empty()) {
+            std::lock_guard<std::mutex> lock(_synced_mutex);
+            for (node *n : waiters) {
+                n->done = true;
+            }
+            waiters.clear();
+            _synced.notify_all();
+        }
+
+        if (!running) {
+            break;
+        }
+
+        // Sleep until producer pushes something, or it is time to sync
+        _sleeping.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_head.load() != _tail || _tail->next.load() != nullptr) {
+            _sleeping.store(false);
+            continue;
+        }
+
+        std::chrono::steady_clock::duration timeout = kIdleInterval;
+        if (_sync == Sync::Periodic && _dirty) {
+            timeout = std::min<std::chrono::steady_clock::duration>(timeout, last_sync + _sync_interval - now);
+        }
+        std::unique_lock<std::mutex> lock(_wakeup_mutex);
+        _wakeup.wait_for(lock, timeout, [this] { return !_sleeping.load() || !_running.load(); });
+        _sleeping.store(false);
+    }
+
+    _Sync();
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,218 @@
+#include "ReadMostlyLRU.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace Afina {
+namespace Backend {
+
+// See ReadMostlyLRU.h
+ReadMostlyLRU::guard::guard(pthread_rwlock_t &lock, bool exclusive) : _lock(lock) {
+    const int rc = exclusive ? pthread_rwlock_wrlock(&_lock) : pthread_rwlock_rdlock(&_lock);
+    if (rc != 0) {
+        throw std::runtime_error("Failed to lock storage: " + std::string(strerror(rc)));
+    }
+}
+
+// See ReadMostlyLRU.h
+ReadMostlyLRU::guard::~guard() { pthread_rwlock_unlock(&_lock); }
+
+// See ReadMostlyLRU.h
+ReadMostlyLRU::ReadMostlyLRU(std::size_t max_size)
+    : _max_size(max_size), _free_size(max_size), _head(nullptr), _tail(nullptr), _evictions(0),
+      _second_chances(0) {
+    // Default glibc lock prefers readers, constant stream of Get would starve writers
+    pthread_rwlockattr_t attr;
+    pthread_rwlockattr_init(&attr);
+    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+    const int rc = pthread_rwlock_init(&_lock, &attr);
+    pthread_rwlockattr_destroy(&attr);
+    if (rc != 0) {
+        throw std::runtime_error("Failed to create storage lock: " + std::string(strerror(rc)));
+    }
+}
+
+// See ReadMostlyLRU.h
+ReadMostlyLRU::~ReadMostlyLRU() { pthread_rwlock_destroy(&_lock); }
+
+// See ReadMostlyLRU.h
+bool ReadMostlyLRU::Put(const std::string &key, const std::string &value) {
+    if (key.size() + value.size() > _max_size) {
+        return false;
+    }
+
+    guard lock(_lock, true);
+    auto it = _index.find(key);
+    if (it != _index.end()) {
+        _Remove(it->second.get());
+    }
+    _Insert(key, value);
+    return true;
+}
+
+// See ReadMostlyLRU.h
+bool ReadMostlyLRU::PutIfAbsent(const std::string &key, const std::string &value) {
+    if (key.size() + value.size() > _max_size) {
+        return false;
+    }
+
+    guard lock(_lock, true);
+    if (_index.find(key) != _index.end()) {
+        return false;
+    }
+    _Insert(key, value);
+    return true;
+}
+
+// See ReadMostlyLRU.h
+bool ReadMostlyLRU::Set(const std::string &key, const std::string &value) {
+    if (key.size() + value.size() > _max_size) {
+        return false;
+    }
+
+    guard lock(_lock, true);
+    auto it = _index.find(key);
+    if (it == _index.end()) {
+        return false;
+    }
+
+    // Value fits, item just becomes the most recently used
+    lru_node *node = it->second.get();
+    if (value.size() <= node->value.size() + _free_size) {
+        _free_size = _free_size + node->value.size() - value.size();
+        node->value = value;
+        _Unlink(node);
+        _Link(node);
+        return true;
+    }
+
+    // Otherwise other items are evicted, but not this one
+    _Remove(node);
+    _Insert(key, value);
+    return true;
+}
+
+// See ReadMostlyLRU.h
+bool ReadMostlyLRU::Delete(const std::string &key) {
+    guard lock(_lock, true);
+    auto it = _index.find(key);
+    if (it == _index.end()) {
+        return false;
+    }
+    _Remove(it->second.get());
+    return true;
+}
+
+// See ReadMostlyLRU.h
+bool ReadMostlyLRU::Get(const std::string &key, std::string &value) {
+    guard lock(_lock, false);
+    auto it = _index.find(key);
+    if (it == _index.end()) {
+        return false;
+    }
+
+    // Hot items are referenced already, reading the bit first keeps their cache line shared between cores
+    lru_node *node = it->second.get();
+    if (!node->referenced.load(std::memory_order_relaxed)) {
+        node->referenced.store(true, std::memory_order_relaxed);
+    }
+    value = node->value;
+    return true;
+}
+
+// See ReadMostlyLRU.h
+void ReadMostlyLRU::Stats(std::vector<std::pair<std::string, std::string>> &stats) {
+    guard lock(_lock, false);
+    stats.emplace_back("storage_items", std::to_string(_index.size()));
+    stats.emplace_back("storage_evictions", std::to_string(_evictions));
+    stats.emplace_back("storage_second_chances", std::to_string(_second_chances));
+    stats.emplace_back("storage_used_bytes", std::to_string(_max_size - _free_size));
+}
+
+// See ReadMostlyLRU.h
+void ReadMostlyLRU::ForEach(const std::function<void(const std::string &key, const std::string &value)> &visitor) {
+    guard lock(_lock, false);
+    ForEachUnlocked(visitor);
+}
+
+// See ReadMostlyLRU.h
+void ReadMostlyLRU::ForEachUnlocked(
+    const std::function<void(const std::string &key, const std::string &value)> &visitor) {
+    for (lru_node *node = _tail; node != nullptr; node = node->prev) {
+        visitor(node->key, node->value);
+    }
+}
+
+// See ReadMostlyLRU.h
+void ReadMostlyLRU::Exclusive(const std::function<void()> &fn) {
+    guard lock(_lock, true);
+    fn();
+}
+
+// See ReadMostlyLRU.h
+void ReadMostlyLRU::_Insert(const std::string &key, const std::string &value) {
+    const std::size_t size = key.size() + value.size();
+    while (size > _free_size) {
+        _Evict();
+    }
+
+    std::unique_ptr<lru_node> node(new lru_node(key, value));
+    _Link(node.get());
+    _free_size -= size;
+
+    std::reference_wrapper<const std::string> ref_key(node->key);
+    _index.emplace(ref_key, std::move(node));
+}
+
+// See ReadMostlyLRU.h
+void ReadMostlyLRU::_Remove(lru_node *node) {
+    _Unlink(node);
+    _free_size += node->key.size() + node->value.size();
+    _index.erase(node->key);
+}
+
+// See ReadMostlyLRU.h
+void ReadMostlyLRU::_Evict() {
+    // Every pass clears the bit, so the loop ends after one round at most
+    while (_tail->referenced.load(std::memory_order_relaxed)) {
+        lru_node *node = _tail;
+        node->referenced.store(false, std::memory_order_relaxed);
+        _Unlink(node);
+        _Link(node);
+        _second_chances++;
+    }
+
+    _Remove(_tail);
+    _evictions++;
+}
+
+// See ReadMostlyLRU.h
+void ReadMostlyLRU::_Link(lru_node *node) {
+    node->prev = nullptr;
+    node->next = _head;
+    if (_head != nullptr) {
+        _head->prev = node;
+    } else {
+        _tail = node;
+    }
+    _head = node;
+}
+
+// See ReadMostlyLRU.h
+void ReadMostlyLRU::_Unlink(lru_node *node) {
+    if (node->prev != nullptr) {
+        node->prev->next = node->next;
+    } else {
+        _head = node->next;
+    }
+
+    if (node->next != nullptr) {
+        node->next->prev = node->prev;
+    } else {
+        _tail = node->prev;
+    }
+    node->prev = node->next = nullptr;
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,121 @@
+#ifndef AFINA_STORAGE_READ_MOSTLY_LRU_H
+#define AFINA_STORAGE_READ_MOSTLY_LRU_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <pthread.h>
+
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # LRU with approximate recency for read heavy workloads
+ * Get doesn't move the item in the list, it only sets the item's reference bit by relaxed store, so reads don't
+ * change anything shared and run in parallel under the read lock. Items are moved lazily when eviction reaches
+ * them: referenced item gets its bit cleared and goes to the head of the list instead of being evicted (second
+ * chance). Changes take the write lock, writers are preferred so they aren't starved by the stream of reads.
+ *
+ * Same byte budget as SimpleLRU: sum of key and value sizes of all items doesn't exceed max_size. Thread safe by
+ * itself, doesn't need a wrapper.
+ */
+class ReadMostlyLRU : public Afina::Storage {
+public:
+    ReadMostlyLRU(std::size_t max_size = 1024);
+    ~ReadMostlyLRU();
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override;
+
+    // Implements Afina::Storage interface
+    void Stats(std::vector<std::pair<std::string, std::string>> &stats) override;
+
+    // Implements Afina::Storage interface, order is approximate as recency is
+    void ForEach(const std::function<void(const std::string &key, const std::string &value)> &visitor) override;
+
+    // Implements Afina::Storage interface, child forked inside Exclusive() would block on the read lock
+    void ForEachUnlocked(
+        const std::function<void(const std::string &key, const std::string &value)> &visitor) override;
+
+    // Implements Afina::Storage interface
+    void Exclusive(const std::function<void()> &fn) override;
+
+private:
+    struct lru_node {
+        const std::string key;
+        std::string value;
+
+        // Position in the list, head is the most recently used
+        lru_node *prev;
+        lru_node *next;
+
+        // Set by readers, cleared when eviction passes the item
+        std::atomic<bool> referenced;
+
+        lru_node(const std::string &key, const std::string &value)
+            : key(key), value(value), prev(nullptr), next(nullptr), referenced(false) {}
+    };
+
+    // Holds the lock, shared or exclusive one
+    class guard {
+    public:
+        guard(pthread_rwlock_t &lock, bool exclusive);
+        ~guard();
+
+    private:
+        pthread_rwlock_t &_lock;
+    };
+
+    // Puts the item into the index and at the head of the list, evicts others if needed
+    void _Insert(const std::string &key, const std::string &value);
+
+    // Removes the item from the list and index, frees it
+    void _Remove(lru_node *node);
+
+    // Evicts the least recently used item which wasn't referenced since eviction passed it
+    void _Evict();
+
+    void _Link(lru_node *node);
+    void _Unlink(lru_node *node);
+
+    std::size_t _max_size;
+    std::size_t _free_size;
+
+    // Index owns all nodes
+    std::unordered_map<std::reference_wrapper<const std::string>, std::unique_ptr<lru_node>, std::hash<std::string>,
+                       std::equal_to<std::string>>
+        _index;
+
+    lru_node *_head;
+    lru_node *_tail;
+
+    // Changed under write lock only
+    uint64_t _evictions;
+    uint64_t _second_chances;
+
+    pthread_rwlock_t _lock;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_READ_MOSTLY_LRU_H
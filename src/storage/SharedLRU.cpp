@@ -0,0 +1,436 @@
+#include "SharedLRU.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * Segment header, hash table buckets and then the heap follow it
+ */
+struct SharedLRU::header {
+    uint64_t magic;
+    uint64_t size;
+    uint64_t buckets;
+
+    pthread_mutex_t lock;
+
+    // Lock owner is changing structures, they are broken if it dies
+    uint32_t changing;
+
+    // LRU list, head is the most recently used
+    Handle head;
+    Handle tail;
+
+    uint64_t items;
+    uint64_t evictions;
+    uint64_t defrags;
+
+    // Times the cache was picked up by the new process and cleared after the owner died
+    uint64_t attaches;
+    uint64_t resets;
+};
+
+namespace {
+
+// "AFSHLRU" and layout version, layout depends on pthread_mutex_t too
+const uint64_t kMagic = 0x414653484c525501ull ^ (uint64_t(sizeof(pthread_mutex_t)) << 32);
+
+const std::size_t kAlign = 64;
+
+std::size_t AlignUp(std::size_t n) { return (n + kAlign - 1) & ~(kAlign - 1); }
+
+// One bucket per 256 bytes of the segment, at least 1024
+uint64_t BucketsFor(std::size_t size) {
+    uint64_t buckets = 1024;
+    while (buckets * 256 < size) {
+        buckets <<= 1;
+    }
+    return buckets;
+}
+
+} // namespace
+
+// See SharedLRU.h
+SharedLRU::guard::guard(SharedLRU &storage, bool change) : _storage(storage), _change(change) {
+    header *h = _storage._header;
+    int rc = pthread_mutex_lock(&h->lock);
+    if (rc == EOWNERDEAD) {
+        // Reader dying, for example snapshot child being killed, leaves everything intact
+        if (h->changing != 0) {
+            _storage._Reset();
+        }
+        pthread_mutex_consistent(&h->lock);
+    } else if (rc != 0) {
+        throw std::runtime_error("Failed to lock shared storage: " + std::string(strerror(rc)));
+    }
+    h->changing = _change;
+}
+
+// See SharedLRU.h
+SharedLRU::guard::~guard() {
+    _storage._header->changing = 0;
+    pthread_mutex_unlock(&_storage._header->lock);
+}
+
+// See SharedLRU.h
+SharedLRU::SharedLRU(const std::string &name, std::size_t size)
+    : _name(name), _size(size), _base(nullptr), _header(nullptr), _buckets(nullptr), _heap(nullptr),
+      _attached(false) {
+    const uint64_t buckets = BucketsFor(size);
+    const std::size_t heap_offset = AlignUp(AlignUp(sizeof(header)) + buckets * sizeof(Handle));
+    if (size < heap_offset + (64 << 10)) {
+        throw std::runtime_error("Shared storage is too small");
+    }
+
+    // Existing segment is never truncated or formatted, the previous process may still use it. Segment which
+    // can't be attached is unlinked instead, its mappings stay valid, and the new one is created exclusively
+    for (int attempt = 0; _heap == nullptr; attempt++) {
+        if (attempt == 3) {
+            throw std::runtime_error("Failed to create " + name + ": segment is recreated concurrently");
+        }
+
+        bool created = false;
+        int fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0600);
+        if (fd < 0 && errno == ENOENT) {
+            fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+            if (fd < 0 && errno == EEXIST) {
+                continue;
+            }
+            created = true;
+        }
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open " + name + ": " + strerror(errno));
+        }
+
+        struct stat st;
+        if (created && ftruncate(fd, size) != 0) {
+            const int err = errno;
+            close(fd);
+            shm_unlink(name.c_str());
+            throw std::runtime_error("Failed to resize " + name + ": " + strerror(err));
+        }
+        if (!created && (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) != size)) {
+            close(fd);
+            shm_unlink(name.c_str());
+            continue;
+        }
+
+        void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) {
+            throw std::runtime_error("Failed to map " + name + ": " + strerror(errno));
+        }
+
+        _base = static_cast<char *>(base);
+        _header = reinterpret_cast<header *>(_base);
+        _buckets = reinterpret_cast<Handle *>(_base + AlignUp(sizeof(header)));
+
+        if (created) {
+            _Format();
+            return;
+        }
+        if (_header->magic == kMagic && _header->size == size && _header->buckets == buckets) {
+            _heap = Allocator::Relocatable::Attach(_base + heap_offset, size - heap_offset);
+        }
+        if (_heap == nullptr) {
+            munmap(_base, size);
+            _base = nullptr;
+            shm_unlink(name.c_str());
+        }
+    }
+
+    guard lock(*this, true);
+    _attached = _header->items > 0;
+    _header->attaches++;
+}
+
+// See SharedLRU.h
+SharedLRU::~SharedLRU() { munmap(_base, _size); }
+
+// See SharedLRU.h
+bool SharedLRU::Remove(const std::string &name) { return shm_unlink(name.c_str()) == 0; }
+
+// See SharedLRU.h
+bool SharedLRU::Put(const std::string &key, const std::string &value) {
+    const uint64_t hash = _Hash(key);
+    guard lock(*this, true);
+    if (Handle h = _Find(key, hash)) {
+        return _Update(h, value);
+    }
+    return _Insert(key, hash, value);
+}
+
+// See SharedLRU.h
+bool SharedLRU::PutIfAbsent(const std::string &key, const std::string &value) {
+    const uint64_t hash = _Hash(key);
+    guard lock(*this, true);
+    if (_Find(key, hash) != 0) {
+        return false;
+    }
+    return _Insert(key, hash, value);
+}
+
+// See SharedLRU.h
+bool SharedLRU::Set(const std::string &key, const std::string &value) {
+    const uint64_t hash = _Hash(key);
+    guard lock(*this, true);
+    Handle h = _Find(key, hash);
+    if (h == 0) {
+        return false;
+    }
+    return _Update(h, value);
+}
+
+// See SharedLRU.h
+bool SharedLRU::Delete(const std::string &key) {
+    const uint64_t hash = _Hash(key);
+    guard lock(*this, true);
+    Handle h = _Find(key, hash);
+    if (h == 0) {
+        return false;
+    }
+    _Remove(h);
+    return true;
+}
+
+// See SharedLRU.h
+bool SharedLRU::Get(const std::string &key, std::string &value) {
+    const uint64_t hash = _Hash(key);
+    guard lock(*this, true);
+    Handle h = _Find(key, hash);
+    if (h == 0) {
+        return false;
+    }
+
+    _Touch(h);
+    item *it = _Item(h);
+    value.assign(it->value(), it->value_size);
+    return true;
+}
+
+// See SharedLRU.h
+void SharedLRU::Stats(std::vector<std::pair<std::string, std::string>> &stats) {
+    guard lock(*this, false);
+    stats.emplace_back("storage_items", std::to_string(_header->items));
+    stats.emplace_back("storage_evictions", std::to_string(_header->evictions));
+    stats.emplace_back("storage_index_buckets", std::to_string(_header->buckets));
+    stats.emplace_back("shm_size", std::to_string(_size));
+    stats.emplace_back("shm_attached", std::to_string(_attached));
+    stats.emplace_back("shm_attaches", std::to_string(_header->attaches));
+    stats.emplace_back("shm_resets", std::to_string(_header->resets));
+    stats.emplace_back("shm_defrags", std::to_string(_header->defrags));
+    stats.emplace_back("shm_used_bytes", std::to_string(_heap->used_bytes()));
+    stats.emplace_back("shm_free_bytes", std::to_string(_heap->free_bytes()));
+    stats.emplace_back("shm_unused_bytes", std::to_string(_heap->unused_bytes()));
+}
+
+// See SharedLRU.h
+void SharedLRU::ForEach(const std::function<void(const std::string &key, const std::string &value)> &visitor) {
+    guard lock(*this, false);
+    std::string key, value;
+    for (Handle h = _header->tail; h != 0; h = _Item(h)->prev) {
+        item *it = _Item(h);
+        key.assign(it->key(), it->key_size);
+        value.assign(it->value(), it->value_size);
+        visitor(key, value);
+    }
+}
+
+// See SharedLRU.h
+void SharedLRU::ForEachUnlocked(
+    const std::function<void(const std::string &key, const std::string &value)> &visitor) {
+    ForEach(visitor);
+}
+
+// See SharedLRU.h
+void SharedLRU::Exclusive(const std::function<void()> &fn) {
+    guard lock(*this, false);
+    fn();
+}
+
+// See SharedLRU.h
+uint64_t SharedLRU::_Hash(const std::string &key) {
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : key) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// See SharedLRU.h
+void SharedLRU::_Format() {
+    std::memset(_header, 0, sizeof(header));
+    _header->size = _size;
+    _header->buckets = BucketsFor(_size);
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&_header->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    _Reset();
+    _header->resets = 0;
+
+    // Segment is valid only once everything else is written
+    __atomic_store_n(&_header->magic, kMagic, __ATOMIC_RELEASE);
+}
+
+// See SharedLRU.h
+void SharedLRU::_Reset() {
+    const std::size_t heap_offset = AlignUp(AlignUp(sizeof(header)) + _header->buckets * sizeof(Handle));
+    std::memset(_buckets, 0, _header->buckets * sizeof(Handle));
+    _heap = Allocator::Relocatable::Create(_base + heap_offset, _size - heap_offset);
+
+    _header->head = 0;
+    _header->tail = 0;
+    _header->items = 0;
+    _header->resets++;
+}
+
+// See SharedLRU.h
+SharedLRU::Handle *SharedLRU::_Bucket(uint64_t hash) const { return &_buckets[hash & (_header->buckets - 1)]; }
+
+// See SharedLRU.h
+SharedLRU::Handle SharedLRU::_Find(const std::string &key, uint64_t hash) const {
+    for (Handle h = *_Bucket(hash); h != 0;) {
+        item *it = _Item(h);
+        if (it->hash == hash && it->key_size == key.size() && std::memcmp(it->key(), key.data(), key.size()) == 0) {
+            return h;
+        }
+        h = it->hnext;
+    }
+    return 0;
+}
+
+// See SharedLRU.h
+bool SharedLRU::_Insert(const std::string &key, uint64_t hash, const std::string &value) {
+    Handle h = _Alloc(sizeof(item) + key.size() + value.size());
+    if (h == 0) {
+        return false;
+    }
+
+    item *it = _Item(h);
+    it->hash = hash;
+    it->key_size = static_cast<uint32_t>(key.size());
+    it->value_size = static_cast<uint32_t>(value.size());
+    std::memcpy(it->key(), key.data(), key.size());
+    std::memcpy(it->value(), value.data(), value.size());
+
+    Handle *bucket = _Bucket(hash);
+    it->hnext = *bucket;
+    *bucket = h;
+
+    _LinkLRU(h);
+    _header->items++;
+    return true;
+}
+
+// See SharedLRU.h
+bool SharedLRU::_Update(Handle h, const std::string &value) {
+    item *it = _Item(h);
+    if (sizeof(item) + it->key_size + value.size() <= _heap->size(h)) {
+        it->value_size = static_cast<uint32_t>(value.size());
+        std::memcpy(it->value(), value.data(), value.size());
+        _Touch(h);
+        return true;
+    }
+
+    const std::string key(it->key(), it->key_size);
+    const uint64_t hash = it->hash;
+    _Remove(h);
+    return _Insert(key, hash, value);
+}
+
+// See SharedLRU.h
+void SharedLRU::_Remove(Handle h) {
+    item *it = _Item(h);
+    for (Handle *cur = _Bucket(it->hash); *cur != 0; cur = &_Item(*cur)->hnext) {
+        if (*cur == h) {
+            *cur = it->hnext;
+            break;
+        }
+    }
+
+    _UnlinkLRU(h);
+    _heap->free(h);
+    _header->items--;
+}
+
+// See SharedLRU.h
+SharedLRU::Handle SharedLRU::_Alloc(std::size_t size) {
+    // Items that large would evict everything
+    if (size > _size / 2) {
+        return 0;
+    }
+
+    // Compacting moves the whole heap, so it waits for many evictions to pay off
+    const std::size_t defrag_at = std::max(size + 64, _size / 32);
+    while (true) {
+        if (Handle h = _heap->alloc(size)) {
+            return h;
+        }
+
+        if (_heap->free_bytes() >= defrag_at || (_header->tail == 0 && _heap->free_bytes() > 0)) {
+            _heap->defrag();
+            _header->defrags++;
+        } else if (_header->tail != 0) {
+            _Remove(_header->tail);
+            _header->evictions++;
+        } else {
+            return 0;
+        }
+    }
+}
+
+// See SharedLRU.h
+void SharedLRU::_Touch(Handle h) {
+    if (_header->head != h) {
+        _UnlinkLRU(h);
+        _LinkLRU(h);
+    }
+}
+
+// See SharedLRU.h
+void SharedLRU::_LinkLRU(Handle h) {
+    item *it = _Item(h);
+    it->prev = 0;
+    it->next = _header->head;
+    if (_header->head != 0) {
+        _Item(_header->head)->prev = h;
+    } else {
+        _header->tail = h;
+    }
+    _header->head = h;
+}
+
+// See SharedLRU.h
+void SharedLRU::_UnlinkLRU(Handle h) {
+    item *it = _Item(h);
+    if (it->prev != 0) {
+        _Item(it->prev)->next = it->next;
+    } else {
+        _header->head = it->next;
+    }
+
+    if (it->next != 0) {
+        _Item(it->next)->prev = it->prev;
+    } else {
+        _header->tail = it->prev;
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,163 @@
+#ifndef AFINA_STORAGE_SHARED_LRU_H
+#define AFINA_STORAGE_SHARED_LRU_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <afina/Storage.h>
+#include <afina/allocator/Relocatable.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # LRU cache in the named shared memory segment
+ * Everything, items, hash table index and LRU list, lives in the POSIX shared memory segment which outlives the
+ * process. New process opening segment of the same name and size serves the data right away, so restart doesn't
+ * empty the cache. Structures refer to each other by handles of Allocator::Relocatable, segment could be mapped
+ * at any address.
+ *
+ * Segment has its own robust process shared lock, so storage is thread safe and could be used by two processes
+ * at once, for example while the old one drains connections. If the process dies holding the lock in the middle
+ * of change, structures could be broken, so the next one taking it clears the cache.
+ *
+ * Released blocks are reused by the allocation of the same size, otherwise items are evicted until released
+ * memory is large enough to compact the heap. Memory is shared with forked children too, so snapshot of this
+ * storage is written while it is locked rather than from copy-on-write pages.
+ */
+class SharedLRU : public Afina::Storage {
+public:
+    /**
+     * Opens the segment, creates it if there is none. Segment of different size or layout is never changed in
+     * place: it is unlinked, processes having it mapped keep using it, and the new one is created. Throws
+     * std::runtime_error if segment can't be opened or mapped
+     *
+     * @param name name of the segment, see shm_open(3)
+     * @param size size of the segment
+     */
+    SharedLRU(const std::string &name, std::size_t size = 64 << 20);
+    ~SharedLRU();
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override;
+
+    // Implements Afina::Storage interface
+    void Stats(std::vector<std::pair<std::string, std::string>> &stats) override;
+
+    // Implements Afina::Storage interface
+    void ForEach(const std::function<void(const std::string &key, const std::string &value)> &visitor) override;
+
+    // Implements Afina::Storage interface, segment isn't copied by fork, so the child takes the lock anyway
+    void ForEachUnlocked(const std::function<void(const std::string &key, const std::string &value)> &visitor) override;
+
+    // Implements Afina::Storage interface
+    void Exclusive(const std::function<void()> &fn) override;
+
+    /**
+     * Returns true if items of the previous process were picked up
+     */
+    bool attached() const { return _attached; }
+
+    /**
+     * Removes the segment, processes having it opened keep using it
+     */
+    static bool Remove(const std::string &name);
+
+private:
+    using Handle = Allocator::Relocatable::Handle;
+
+    struct header;
+
+    // Cache item, key and value follow the header in the same block
+    struct item {
+        // Position in the LRU list, head is the most recently used
+        Handle prev;
+        Handle next;
+
+        // Next item in the hash table bucket
+        Handle hnext;
+
+        uint32_t key_size;
+        uint32_t value_size;
+        uint32_t unused;
+        uint64_t hash;
+
+        char *key() { return reinterpret_cast<char *>(this + 1); }
+        char *value() { return key() + key_size; }
+    };
+
+    // Holds the segment lock, clears the cache if the previous owner died changing it
+    class guard {
+    public:
+        guard(SharedLRU &storage, bool change);
+        ~guard();
+
+    private:
+        SharedLRU &_storage;
+        bool _change;
+    };
+
+    // Hash which stays the same across builds, it is stored in the segment
+    static uint64_t _Hash(const std::string &key);
+
+    // Creates empty cache in the segment, including the lock
+    void _Format();
+
+    // Empties the cache, keeps the lock
+    void _Reset();
+
+    item *_Item(Handle h) const { return static_cast<item *>(_heap->get(h)); }
+    Handle *_Bucket(uint64_t hash) const;
+
+    // Returns item for the key, zero if there is no such one
+    Handle _Find(const std::string &key, uint64_t hash) const;
+
+    // Creates new item, evicts old ones if needed
+    bool _Insert(const std::string &key, uint64_t hash, const std::string &value);
+
+    // Replaces value of the existing item, in place if new one fits the same block
+    bool _Update(Handle h, const std::string &value);
+
+    // Removes item from the cache and frees its block
+    void _Remove(Handle h);
+
+    // Allocates block evicting least recently used items and compacting heap if needed, zero if it doesn't fit
+    Handle _Alloc(std::size_t size);
+
+    // Moves item to the head of the LRU list
+    void _Touch(Handle h);
+
+    void _LinkLRU(Handle h);
+    void _UnlinkLRU(Handle h);
+
+    std::string _name;
+    std::size_t _size;
+
+    // Mapped segment and its parts
+    char *_base;
+    header *_header;
+    Handle *_buckets;
+    Allocator::Relocatable *_heap;
+
+    bool _attached;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_SHARED_LRU_H
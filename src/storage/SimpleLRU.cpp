@@ -140,6 +140,13 @@ bool SimpleLRU::Get(const std::string &key, std::string &value) {
     return true;
 }
 
+// See SimpleLRU.h
+void SimpleLRU::ForEach(const std::function<void(const std::string &key, const std::string &value)> &visitor) {
+    for (lru_node *node = _lru_head.get(); node != nullptr; node = node->next.get()) {
+        visitor(node->key, node->value);
+    }
+}
+
 void SimpleLRU::_InsertNode(const std::string &key, const std::string &value) {
     lru_node *buff = new lru_node(key, value);
     if (_lru_tail == nullptr) {
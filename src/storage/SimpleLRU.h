@@ -65,6 +65,9 @@ public:
     // Implements Afina::Storage interface
     bool Get(const std::string &key, std::string &value) override;
 
+    // Implements Afina::Storage interface
+    void ForEach(const std::function<void(const std::string &key, const std::string &value)> &visitor) override;
+
 private:
     // Maximum number of bytes could be stored in this cache.
     // i.e all (keys+values) must be less the _max_size
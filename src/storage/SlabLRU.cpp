@@ -0,0 +1,330 @@
+#include "SlabLRU.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+namespace Afina {
+namespace Backend {
+
+// See SlabLRU.h
+SlabLRU::SlabLRU(size_t max_size, size_t page_size, bool huge_pages)
+    : _max_size(max_size), _slab(max_size, page_size, 48, 1.25, huge_pages), _lru(_slab.classes()),
+      _segments(Allocator::StlAllocator<segment, Allocator::Slab>(_slab)), _buckets(16), _segment_bits(0), _items(0),
+      _grow_at(_buckets) {
+    // Largest power of two number of buckets fitting the page
+    while ((sizeof(item *) << (_segment_bits + 1)) <= _slab.page_size()) {
+        _segment_bits++;
+    }
+
+    _segments.reserve(1);
+    _segments.emplace_back(_buckets, nullptr, _segments.get_allocator());
+}
+
+// See SlabLRU.h
+bool SlabLRU::Put(const std::string &key, const std::string &value) {
+    std::size_t hash = std::hash<std::string>()(key);
+    item *it = _Find(key, hash);
+    if (it != nullptr) {
+        return _Update(it, value);
+    }
+    return _Insert(key, hash, value);
+}
+
+// See SlabLRU.h
+bool SlabLRU::PutIfAbsent(const std::string &key, const std::string &value) {
+    std::size_t hash = std::hash<std::string>()(key);
+    if (_Find(key, hash) != nullptr) {
+        return false;
+    }
+    return _Insert(key, hash, value);
+}
+
+// See SlabLRU.h
+bool SlabLRU::Set(const std::string &key, const std::string &value) {
+    item *it = _Find(key, std::hash<std::string>()(key));
+    if (it == nullptr) {
+        return false;
+    }
+    return _Update(it, value);
+}
+
+// See SlabLRU.h
+bool SlabLRU::Delete(const std::string &key) {
+    item *it = _Find(key, std::hash<std::string>()(key));
+    if (it == nullptr) {
+        return false;
+    }
+    _Remove(it);
+    return true;
+}
+
+// See SlabLRU.h
+bool SlabLRU::Get(const std::string &key, std::string &value) {
+    item *it = _Find(key, std::hash<std::string>()(key));
+    if (it == nullptr) {
+        return false;
+    }
+
+    _Touch(it);
+    value.assign(it->value(), it->value_size);
+    return true;
+}
+
+// See SlabLRU.h
+void SlabLRU::Stats(std::vector<std::pair<std::string, std::string>> &stats) {
+    uint64_t evictions = 0;
+    for (const lru_list &lru : _lru) {
+        evictions += lru.evictions;
+    }
+
+    stats.emplace_back("storage_items", std::to_string(_items));
+    stats.emplace_back("storage_evictions", std::to_string(evictions));
+    stats.emplace_back("storage_index_buckets", std::to_string(_buckets));
+    stats.emplace_back("slab_page_size", std::to_string(_slab.page_size()));
+    stats.emplace_back("slab_memory_page_size", std::to_string(_slab.memory_page_size()));
+    stats.emplace_back("slab_pages_total", std::to_string(_slab.pages()));
+    stats.emplace_back("slab_pages_free", std::to_string(_slab.free_pages()));
+
+    for (unsigned cls = 0; cls < _slab.classes(); cls++) {
+        Allocator::Slab::Stats slab = _slab.stats(cls);
+        if (slab.pages == 0 && slab.allocs == 0) {
+            continue;
+        }
+
+        std::string prefix = "slab_" + std::to_string(cls) + "_";
+        stats.emplace_back(prefix + "chunk_size", std::to_string(slab.chunk_size));
+        stats.emplace_back(prefix + "pages", std::to_string(slab.pages));
+        stats.emplace_back(prefix + "used_chunks", std::to_string(slab.used));
+        stats.emplace_back(prefix + "free_chunks", std::to_string(slab.free));
+        stats.emplace_back(prefix + "allocs", std::to_string(slab.allocs));
+        stats.emplace_back(prefix + "reassigned", std::to_string(slab.reassigned));
+        stats.emplace_back(prefix + "evictions", std::to_string(_lru[cls].evictions));
+    }
+}
+
+// See SlabLRU.h
+void SlabLRU::ForEach(const std::function<void(const std::string &key, const std::string &value)> &visitor) {
+    std::string key, value;
+    for (const lru_list &lru : _lru) {
+        for (item *it = lru.tail; it != nullptr; it = it->prev) {
+            key.assign(it->key(), it->key_size);
+            value.assign(it->value(), it->value_size);
+            visitor(key, value);
+        }
+    }
+}
+
+// See SlabLRU.h
+SlabLRU::item *SlabLRU::_Find(const std::string &key, std::size_t hash) {
+    for (item *it = *_Bucket(hash); it != nullptr; it = it->hnext) {
+        if (it->hash == hash && it->key_size == key.size() && std::memcmp(it->key(), key.data(), key.size()) == 0) {
+            return it;
+        }
+    }
+    return nullptr;
+}
+
+// See SlabLRU.h
+bool SlabLRU::_Insert(const std::string &key, std::size_t hash, const std::string &value) {
+    if (key.size() > std::numeric_limits<uint32_t>::max() || value.size() > std::numeric_limits<uint32_t>::max()) {
+        return false;
+    }
+
+    std::size_t size = sizeof(item) + key.size() + value.size();
+    if (size > _max_size) {
+        return false;
+    }
+
+    item *it = static_cast<item *>(_Alloc(size));
+    if (it == nullptr) {
+        return false;
+    }
+
+    it->hash = hash;
+    it->key_size = static_cast<uint32_t>(key.size());
+    it->value_size = static_cast<uint32_t>(value.size());
+    std::memcpy(it->key(), key.data(), key.size());
+    std::memcpy(it->value(), value.data(), value.size());
+
+    item **bucket = _Bucket(hash);
+    it->hnext = *bucket;
+    *bucket = it;
+    _LinkLRU(it);
+
+    if (++_items > _grow_at) {
+        _Grow();
+    }
+    return true;
+}
+
+// See SlabLRU.h
+bool SlabLRU::_Update(item *it, const std::string &value) {
+    std::size_t size = sizeof(item) + it->key_size + value.size();
+    if (_slab.class_of(size) == _slab.chunk_class(it)) {
+        std::memcpy(it->value(), value.data(), value.size());
+        it->value_size = static_cast<uint32_t>(value.size());
+        _Touch(it);
+        return true;
+    }
+
+    if (value.size() > std::numeric_limits<uint32_t>::max() || size > _max_size) {
+        return false;
+    }
+
+    // Item moves to another class. New chunk is allocated first so the old value stays if there is no memory,
+    // item is out of the LRU list meanwhile to not get evicted for its own sake
+    _UnlinkLRU(it);
+    item *moved = static_cast<item *>(_Alloc(size));
+    if (moved == nullptr) {
+        _LinkLRU(it);
+        return false;
+    }
+
+    moved->hash = it->hash;
+    moved->key_size = it->key_size;
+    moved->value_size = static_cast<uint32_t>(value.size());
+    std::memcpy(moved->key(), it->key(), it->key_size);
+    std::memcpy(moved->value(), value.data(), value.size());
+
+    item **link = _Bucket(it->hash);
+    while (*link != it) {
+        link = &(*link)->hnext;
+    }
+    moved->hnext = it->hnext;
+    *link = moved;
+    _LinkLRU(moved);
+    _slab.free(it);
+    return true;
+}
+
+// See SlabLRU.h
+void SlabLRU::_Remove(item *it) {
+    item **link = _Bucket(it->hash);
+    while (*link != it) {
+        link = &(*link)->hnext;
+    }
+    *link = it->hnext;
+
+    _UnlinkLRU(it);
+    _slab.free(it);
+    _items--;
+}
+
+// See SlabLRU.h
+void *SlabLRU::_Alloc(std::size_t size) {
+    unsigned cls = _slab.class_of(size);
+    if (cls == Allocator::Slab::kNoClass) {
+        return nullptr;
+    }
+
+    void *chunk;
+    while ((chunk = _slab.alloc(size)) == nullptr) {
+        if (_Evict(cls)) {
+            continue;
+        }
+
+        // Class owns no items, free page of the class owning the most of them
+        unsigned victim = Allocator::Slab::kNoClass;
+        std::size_t pages = 0;
+        for (unsigned other = 0; other < _slab.classes(); other++) {
+            if (_lru[other].tail != nullptr && _slab.stats(other).pages > pages) {
+                victim = other;
+                pages = _slab.stats(other).pages;
+            }
+        }
+        if (victim == Allocator::Slab::kNoClass) {
+            return nullptr;
+        }
+        _Evict(victim);
+    }
+    return chunk;
+}
+
+// See SlabLRU.h
+bool SlabLRU::_Evict(unsigned cls) {
+    item *victim = _lru[cls].tail;
+    if (victim == nullptr) {
+        return false;
+    }
+
+    _lru[cls].evictions++;
+    _Remove(victim);
+    return true;
+}
+
+// See SlabLRU.h
+void SlabLRU::_Touch(item *it) {
+    if (_lru[_slab.chunk_class(it)].head == it) {
+        return;
+    }
+    _UnlinkLRU(it);
+    _LinkLRU(it);
+}
+
+// See SlabLRU.h
+void SlabLRU::_LinkLRU(item *it) {
+    lru_list &lru = _lru[_slab.chunk_class(it)];
+    it->prev = nullptr;
+    it->next = lru.head;
+    if (lru.head != nullptr) {
+        lru.head->prev = it;
+    } else {
+        lru.tail = it;
+    }
+    lru.head = it;
+}
+
+// See SlabLRU.h
+void SlabLRU::_UnlinkLRU(item *it) {
+    lru_list &lru = _lru[_slab.chunk_class(it)];
+    if (it->prev != nullptr) {
+        it->prev->next = it->next;
+    } else {
+        lru.head = it->next;
+    }
+    if (it->next != nullptr) {
+        it->next->prev = it->prev;
+    } else {
+        lru.tail = it->prev;
+    }
+    it->prev = it->next = nullptr;
+}
+
+// See SlabLRU.h
+void SlabLRU::_Grow() {
+    std::size_t buckets = _buckets * 2;
+    const std::size_t segment_size = std::min(buckets, std::size_t(1) << _segment_bits);
+
+    segments table(_segments.get_allocator());
+    try {
+        table.reserve(buckets / segment_size);
+        for (std::size_t i = 0; i < buckets / segment_size; i++) {
+            table.emplace_back(segment_size, nullptr, _segments.get_allocator());
+        }
+    } catch (std::bad_alloc &) {
+        // Try again once cache gets twice more items
+        _grow_at *= 2;
+        return;
+    }
+
+    std::swap(table, _segments);
+    std::swap(buckets, _buckets);
+    for (segment &old : table) {
+        for (item *head : old) {
+            while (head != nullptr) {
+                item *it = head;
+                head = it->hnext;
+
+                item **bucket = _Bucket(it->hash);
+                it->hnext = *bucket;
+                *bucket = it;
+            }
+        }
+    }
+    _grow_at = _buckets;
+}
+
+} // namespace Backend
+} // namespace Afina
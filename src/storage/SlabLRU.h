@@ -0,0 +1,137 @@
+#ifndef AFINA_STORAGE_SLAB_LRU_H
+#define AFINA_STORAGE_SLAB_LRU_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <afina/Storage.h>
+#include <afina/allocator/Slab.h>
+#include <afina/allocator/StlAllocator.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Slab based implementation
+ * Items (header, key and value) live in chunks of the slab allocator, so the whole cache occupies at most
+ * _max_size bytes and fragmentation is bounded by the allocator size classes. Each size class has its own
+ * LRU list: once class is out of memory its least recently used item gets evicted, that frees chunk of exactly
+ * the needed size. If the class has no items at all, items of the class owning most pages get evicted until
+ * some page becomes empty and could be reassigned.
+ *
+ * Items are indexed by the intrusive hash table, which lives in the slab as well, so index overhead counts toward
+ * _max_size too. Table is split into segments no larger than page; if there is no memory to grow it, table keeps
+ * its size and chains become longer. That is NOT thread safe implementaiton!!
+ */
+class SlabLRU : public Afina::Storage {
+public:
+    SlabLRU(size_t max_size = 64 << 20, size_t page_size = 1 << 20, bool huge_pages = false);
+    ~SlabLRU() {}
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override;
+
+    // Implements Afina::Storage interface
+    void Stats(std::vector<std::pair<std::string, std::string>> &stats) override;
+
+    // Implements Afina::Storage interface, classes are visited one by one
+    void ForEach(const std::function<void(const std::string &key, const std::string &value)> &visitor) override;
+
+private:
+    // Cache item, key and value follow the header in the same chunk
+    struct item {
+        // Position in the class LRU list, head is the most recently used
+        item *prev;
+        item *next;
+
+        // Next item in the hash table bucket
+        item *hnext;
+
+        std::size_t hash;
+        uint32_t key_size;
+        uint32_t value_size;
+
+        char *key() { return reinterpret_cast<char *>(this + 1); }
+        char *value() { return key() + key_size; }
+    };
+
+    // LRU list of the size class
+    struct lru_list {
+        item *head = nullptr;
+        item *tail = nullptr;
+        uint64_t evictions = 0;
+    };
+
+    // Returns item for the key or nullptr if there is no such one
+    item *_Find(const std::string &key, std::size_t hash);
+
+    // Creates new item, evicts old ones if needed
+    bool _Insert(const std::string &key, std::size_t hash, const std::string &value);
+
+    // Replaces value of the existing item, in place if new one fits the same chunk. Item is kept as it was if
+    // there is no memory for the new value
+    bool _Update(item *it, const std::string &value);
+
+    // Removes item from the cache and frees its chunk
+    void _Remove(item *it);
+
+    // Allocates chunk for the item of the given size evicting least recently used items
+    void *_Alloc(std::size_t size);
+
+    // Evicts least recently used item of the class, returns false if class has no items
+    bool _Evict(unsigned cls);
+
+    // Moves item to the head of its LRU list
+    void _Touch(item *it);
+
+    void _LinkLRU(item *it);
+    void _UnlinkLRU(item *it);
+
+    item **_Bucket(std::size_t hash) {
+        std::size_t bucket = hash & (_buckets - 1);
+        return &_segments[bucket >> _segment_bits][bucket & ((std::size_t(1) << _segment_bits) - 1)];
+    }
+
+    // Doubles hash table, does nothing if there is no memory for that
+    void _Grow();
+
+    // Maximum number of bytes could be stored in this cache, including items headers
+    std::size_t _max_size;
+
+    // Items storage
+    Allocator::Slab _slab;
+
+    // LRU lists, one per size class
+    std::vector<lru_list> _lru;
+
+    using segment = std::vector<item *, Allocator::StlAllocator<item *, Allocator::Slab>>;
+    using segments = std::vector<segment, Allocator::StlAllocator<segment, Allocator::Slab>>;
+
+    // Hash table index, number of buckets is power of two. Full segment has 2^_segment_bits buckets
+    segments _segments;
+    std::size_t _buckets;
+    std::size_t _segment_bits;
+
+    // Number of items in the cache and number to grow table at
+    std::size_t _items;
+    std::size_t _grow_at;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_SLAB_LRU_H
@@ -0,0 +1,404 @@
+#include <afina/storage/Snapshot.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <libgen.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <afina/Storage.h>
+
+#include "Crc32.h"
+
+namespace Afina {
+namespace Backend {
+
+namespace {
+
+const char kMagic[] = "AFSNAP1\n";
+const std::size_t kMagicSize = sizeof(kMagic) - 1;
+
+// Key size marking the end of items
+const uint32_t kEnd = 0xffffffff;
+
+// How often children are checked for completion
+const std::chrono::milliseconds kReapInterval(20);
+
+// Snapshot started last
+std::atomic<Snapshot *> current(nullptr);
+
+// Buffered file writer computing checksum of the data written
+class Writer {
+public:
+    explicit Writer(int fd) : _fd(fd), _crc(0), _failed(false) { _buffer.reserve(kBufferSize); }
+
+    void Append(const char *data, std::size_t size) {
+        _crc = Crc32(_crc, data, size);
+        while (size > 0) {
+            const std::size_t n = std::min(size, kBufferSize - _buffer.size());
+            _buffer.append(data, n);
+            data += n;
+            size -= n;
+            if (_buffer.size() == kBufferSize) {
+                Flush();
+            }
+        }
+    }
+
+    void AppendInt(uint64_t value, std::size_t bytes) {
+        char data[8];
+        for (std::size_t i = 0; i < bytes; i++) {
+            data[i] = static_cast<char>(value >> (8 * i));
+        }
+        Append(data, bytes);
+    }
+
+    void Flush() {
+        std::size_t written = 0;
+        while (!_failed && written < _buffer.size()) {
+            ssize_t n = write(_fd, _buffer.data() + written, _buffer.size() - written);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            _failed = n <= 0;
+            written += n > 0 ? n : 0;
+        }
+        _buffer.clear();
+    }
+
+    uint32_t crc() const { return _crc; }
+    bool failed() const { return _failed; }
+
+private:
+    static const std::size_t kBufferSize = 1 << 20;
+
+    int _fd;
+    std::string _buffer;
+    uint32_t _crc;
+    bool _failed;
+};
+
+// Reader of the snapshot file computing checksum of the data read
+class Reader {
+public:
+    explicit Reader(std::istream &in) : _in(in), _crc(0) {}
+
+    bool Read(char *data, std::size_t size) {
+        if (!_in.read(data, size)) {
+            return false;
+        }
+        _crc = Crc32(_crc, data, size);
+        return true;
+    }
+
+    bool ReadInt(uint64_t &value, std::size_t bytes) {
+        char data[8];
+        if (!Read(data, bytes)) {
+            return false;
+        }
+        value = 0;
+        for (std::size_t i = 0; i < bytes; i++) {
+            value |= uint64_t(static_cast<uint8_t>(data[i])) << (8 * i);
+        }
+        return true;
+    }
+
+    // Reads data into the string, or just checksums it if there is no string
+    bool ReadString(std::string *out, std::size_t size) {
+        if (out != nullptr) {
+            out->resize(size);
+            return size == 0 || Read(&(*out)[0], size);
+        }
+
+        char buffer[4096];
+        while (size > 0) {
+            const std::size_t n = std::min(size, sizeof(buffer));
+            if (!Read(buffer, n)) {
+                return false;
+            }
+            size -= n;
+        }
+        return true;
+    }
+
+    uint32_t crc() const { return _crc; }
+
+private:
+    std::istream &_in;
+    uint32_t _crc;
+};
+
+/**
+ * Reads snapshot file, puts items into the storage if it is given. Throws std::runtime_error if file is corrupted,
+ * returns number of items put
+ */
+std::size_t Scan(std::istream &in, Storage *storage) {
+    Reader reader(in);
+
+    char magic[kMagicSize];
+    if (!reader.Read(magic, kMagicSize) || std::string(magic, kMagicSize) != kMagic) {
+        throw std::runtime_error("Not a snapshot file");
+    }
+
+    uint64_t items = 0;
+    std::size_t loaded = 0;
+    std::string key, value;
+    while (true) {
+        uint64_t key_size, value_size;
+        if (!reader.ReadInt(key_size, 4)) {
+            throw std::runtime_error("Snapshot is truncated");
+        } else if (key_size == kEnd) {
+            break;
+        }
+
+        if (!reader.ReadInt(value_size, 4) || !reader.ReadString(storage ? &key : nullptr, key_size) ||
+            !reader.ReadString(storage ? &value : nullptr, value_size)) {
+            throw std::runtime_error("Snapshot is truncated");
+        }
+        items++;
+
+        if (storage != nullptr && storage->Put(key, value)) {
+            loaded++;
+        }
+    }
+
+    uint64_t count, crc;
+    if (!reader.ReadInt(count, 8)) {
+        throw std::runtime_error("Snapshot is truncated");
+    }
+
+    // Checksum covers everything before itself
+    const uint32_t expected = reader.crc();
+    if (!reader.ReadInt(crc, 4) || in.peek() != std::char_traits<char>::eof()) {
+        throw std::runtime_error("Snapshot is truncated");
+    }
+    if (crc != expected || count != items) {
+        throw std::runtime_error("Snapshot checksum mismatch");
+    }
+    return loaded;
+}
+
+} // namespace
+
+// See Snapshot.h
+Snapshot::Snapshot(std::shared_ptr<Storage> storage, const std::string &path, std::chrono::seconds interval)
+    : _storage(storage), _path(path), _interval(interval), _running(false), _child(-1) {}
+
+// See Snapshot.h
+Snapshot::~Snapshot() { Stop(); }
+
+// See Snapshot.h
+void Snapshot::Start() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_running) {
+        _running = true;
+        _thread = std::thread(&Snapshot::_OnRun, this);
+    }
+    current.store(this);
+}
+
+// See Snapshot.h
+void Snapshot::Stop() {
+    Snapshot *self = this;
+    current.compare_exchange_strong(self, nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+        _changed.notify_all();
+    }
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    Wait();
+}
+
+// See Snapshot.h
+bool Snapshot::Trigger() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _Reap();
+    if (_child > 0) {
+        return false;
+    }
+
+    // Nobody changes the storage while it is being copied. Child never leaves Exclusive(), lock it inherited is
+    // held by the parent's thread, so it must not be released there, see Storage.h
+    pid_t pid = -1;
+    _storage->Exclusive([this, &pid] {
+        pid = fork();
+        if (pid == 0) {
+            _exit(_Write());
+        }
+    });
+    if (pid < 0) {
+        if (_on_finish) {
+            _on_finish(false);
+        }
+        throw std::runtime_error("Failed to fork: " + std::string(strerror(errno)));
+    }
+
+    _child = pid;
+    _started = std::chrono::steady_clock::now();
+    _status.in_progress = true;
+    _changed.notify_all();
+    return true;
+}
+
+// See Snapshot.h
+bool Snapshot::Wait() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _Reap();
+        if (_child <= 0) {
+            return _status.last_ok;
+        }
+        _changed.wait_for(lock, kReapInterval);
+    }
+}
+
+// See Snapshot.h
+std::size_t Snapshot::Load() {
+    std::ifstream in(_path, std::ios::binary);
+    if (!in) {
+        if (errno == ENOENT) {
+            return 0;
+        }
+        throw std::runtime_error("Failed to open " + _path + ": " + strerror(errno));
+    }
+
+    // Verify everything first, so the corrupted file doesn't get partially loaded
+    Scan(in, nullptr);
+
+    in.clear();
+    in.seekg(0);
+    return Scan(in, _storage.get());
+}
+
+// See Snapshot.h
+Snapshot::Status Snapshot::GetStatus() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _status;
+}
+
+// See Snapshot.h
+void Snapshot::OnFinish(std::function<void(bool ok)> callback) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _on_finish = std::move(callback);
+}
+
+// See Snapshot.h
+Snapshot *Snapshot::Current() { return current.load(); }
+
+// See Snapshot.h
+int Snapshot::_Write() {
+    const std::string tmp = _path + ".tmp";
+    int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return 1;
+    }
+
+    Writer writer(fd);
+    writer.Append(kMagic, kMagicSize);
+    uint64_t items = 0;
+    try {
+        _storage->ForEachUnlocked([&writer, &items](const std::string &key, const std::string &value) {
+            writer.AppendInt(key.size(), 4);
+            writer.AppendInt(value.size(), 4);
+            writer.Append(key.data(), key.size());
+            writer.Append(value.data(), value.size());
+            items++;
+        });
+    } catch (std::exception &) {
+        close(fd);
+        unlink(tmp.c_str());
+        return 1;
+    }
+
+    writer.AppendInt(kEnd, 4);
+    writer.AppendInt(items, 8);
+    writer.AppendInt(writer.crc(), 4);
+    writer.Flush();
+
+    const bool ok = !writer.failed() && fsync(fd) == 0;
+    if (close(fd) != 0 || !ok || rename(tmp.c_str(), _path.c_str()) != 0) {
+        unlink(tmp.c_str());
+        return 1;
+    }
+
+    // Make rename durable
+    std::string dir_path = _path;
+    int dir = open(dirname(&dir_path[0]), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir >= 0) {
+        fsync(dir);
+        close(dir);
+    }
+    return 0;
+}
+
+// See Snapshot.h
+void Snapshot::_Reap() {
+    if (_child <= 0) {
+        return;
+    }
+
+    int status = 0;
+    pid_t result = waitpid(_child, &status, WNOHANG);
+    if (result == 0 || (result < 0 && errno == EINTR)) {
+        return;
+    }
+
+    _status.in_progress = false;
+    _status.last_time = std::time(nullptr);
+    _status.last_ok = result == _child && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    _status.last_duration_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _started).count();
+
+    struct stat st;
+    _status.last_bytes = _status.last_ok && stat(_path.c_str(), &st) == 0 ? st.st_size : 0;
+    _child = -1;
+    _changed.notify_all();
+
+    if (_on_finish) {
+        _on_finish(_status.last_ok);
+    }
+}
+
+// See Snapshot.h
+void Snapshot::_OnRun() {
+    auto next = std::chrono::steady_clock::now() + _interval;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_running) {
+        _Reap();
+
+        const auto now = std::chrono::steady_clock::now();
+        if (_interval.count() > 0 && now >= next) {
+            next = now + _interval;
+            lock.unlock();
+            try {
+                Trigger();
+            } catch (std::exception &) {
+                // Fork failed, try again next time
+            }
+            lock.lock();
+            continue;
+        }
+
+        auto wait = _interval.count() > 0 ? next - now : std::chrono::steady_clock::duration(std::chrono::seconds(1));
+        if (_child > 0) {
+            wait = std::min<std::chrono::steady_clock::duration>(wait, kReapInterval);
+        }
+        _changed.wait_for(lock, wait);
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
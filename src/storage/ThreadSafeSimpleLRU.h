@@ -1,32 +1,40 @@
 #ifndef AFINA_STORAGE_THREAD_SAFE_SIMPLE_LRU_H
 #define AFINA_STORAGE_THREAD_SAFE_SIMPLE_LRU_H
 
+#include <functional>
 #include <map>
 #include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include <afina/coroutine/Sync.h>
+
+#include "ClockLRU.h"
 #include "SimpleLRU.h"
+#include "SlabLRU.h"
 
 namespace Afina {
 namespace Backend {
 
 /**
  * # SimpleLRU thread safe version
- *
- *
+ * All operations are serialized by the global lock of the given type. With Coroutine::Mutex routine waiting
+ * for the storage gets parked, so the scheduler thread continues to serve other routines. Any other single
+ * threaded backend could be wrapped the same way
  */
-class ThreadSafeSimplLRU : public SimpleLRU {
+template <typename Mutex, typename Base = SimpleLRU> class BasicThreadSafeSimplLRU : public Base {
 public:
-    ThreadSafeSimplLRU(size_t max_size = 1024) : SimpleLRU(max_size) {}
-    ~ThreadSafeSimplLRU() {}
+    template <typename... Args> BasicThreadSafeSimplLRU(Args &&... args) : Base(std::forward<Args>(args)...) {}
+    ~BasicThreadSafeSimplLRU() {}
 
     // see SimpleLRU.h
     bool Put(const std::string &key, const std::string &value) override {
         // TODO: sinchronization
         bool result;
         {
-            std::lock_guard<std::mutex> lock(_locker);
-            result = SimpleLRU::Put(key, value);
+            std::lock_guard<Mutex> lock(_locker);
+            result = Base::Put(key, value);
         }
         return result;
     }
@@ -36,8 +44,8 @@ public:
         // TODO: sinchronization
         bool result;
         {
-            std::lock_guard<std::mutex> lock(_locker);
-            result = SimpleLRU::PutIfAbsent(key, value);
+            std::lock_guard<Mutex> lock(_locker);
+            result = Base::PutIfAbsent(key, value);
         }
         return result;
     }
@@ -47,8 +55,8 @@ public:
         // TODO: sinchronization
         bool result;
         {
-            std::lock_guard<std::mutex> lock(_locker);
-            result = SimpleLRU::Set(key, value);
+            std::lock_guard<Mutex> lock(_locker);
+            result = Base::Set(key, value);
         }
         return result;
     }
@@ -58,8 +66,8 @@ public:
         // TODO: sinchronization
         bool result;
         {
-            std::lock_guard<std::mutex> lock(_locker);
-            result = SimpleLRU::Delete(key);
+            std::lock_guard<Mutex> lock(_locker);
+            result = Base::Delete(key);
         }
         return result;
     }
@@ -69,17 +77,53 @@ public:
         // TODO: sinchronization
         bool result;
         {
-            std::lock_guard<std::mutex> lock(_locker);
-            result = SimpleLRU::Get(key, value);
+            std::lock_guard<Mutex> lock(_locker);
+            result = Base::Get(key, value);
         }
         return result;
     }
 
+    // see Storage.h
+    void Stats(std::vector<std::pair<std::string, std::string>> &stats) override {
+        std::lock_guard<Mutex> lock(_locker);
+        Base::Stats(stats);
+    }
+
+    // see Storage.h
+    void ForEach(const std::function<void(const std::string &key, const std::string &value)> &visitor) override {
+        std::lock_guard<Mutex> lock(_locker);
+        Base::ForEach(visitor);
+    }
+
+    // see Storage.h
+    void ForEachUnlocked(
+        const std::function<void(const std::string &key, const std::string &value)> &visitor) override {
+        Base::ForEach(visitor);
+    }
+
+    // see Storage.h
+    void Exclusive(const std::function<void()> &fn) override {
+        std::lock_guard<Mutex> lock(_locker);
+        fn();
+    }
+
 private:
     // TODO: sinchronization primitives
-    mutable std::mutex _locker;
+    mutable Mutex _locker;
 };
 
+// Storage to be used from ordinary threads
+using ThreadSafeSimplLRU = BasicThreadSafeSimplLRU<std::mutex>;
+
+// Storage to be used from Coroutine::Scheduler routines
+using CoroutineSafeSimplLRU = BasicThreadSafeSimplLRU<Coroutine::Mutex>;
+
+// Slab based storage to be used from ordinary threads
+using ThreadSafeSlabLRU = BasicThreadSafeSimplLRU<std::mutex, SlabLRU>;
+
+// CLOCK based storage to be used from ordinary threads
+using ThreadSafeClockLRU = BasicThreadSafeSimplLRU<std::mutex, ClockLRU>;
+
 } // namespace Backend
 } // namespace Afina
 
@@ -0,0 +1,79 @@
+#ifndef AFINA_TEST_HISTOGRAM_H
+#define AFINA_TEST_HISTOGRAM_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Afina {
+namespace Test {
+
+/**
+ * Log-linear latency histogram, 16 buckets per power of two so percentiles are within 1/16 of the real value.
+ * Shared by the storage benchmark and the load generator
+ */
+class Histogram {
+public:
+    Histogram() : _buckets(64 * kSub, 0) {}
+
+    void add(uint64_t value) {
+        _buckets[_Index(value)]++;
+        _count++;
+        _max = std::max(_max, value);
+    }
+
+    void merge(const Histogram &other) {
+        for (std::size_t i = 0; i < _buckets.size(); i++) {
+            _buckets[i] += other._buckets[i];
+        }
+        _count += other._count;
+        _max = std::max(_max, other._max);
+    }
+
+    // Returns upper bound of the bucket holding requested percentile
+    uint64_t percentile(double p) const {
+        const uint64_t rank = std::max<uint64_t>(1, std::ceil(_count * p / 100.0));
+        uint64_t seen = 0;
+        for (std::size_t i = 0; i < _buckets.size(); i++) {
+            seen += _buckets[i];
+            if (seen >= rank) {
+                return std::min(_Upper(i), _max);
+            }
+        }
+        return _max;
+    }
+
+    uint64_t count() const { return _count; }
+    uint64_t max() const { return _max; }
+
+private:
+    static const unsigned kSub = 16;
+
+    static std::size_t _Index(uint64_t value) {
+        if (value < kSub) {
+            return value;
+        }
+        const unsigned msb = 63 - __builtin_clzll(value);
+        return (msb - 3) * kSub + ((value >> (msb - 4)) & (kSub - 1));
+    }
+
+    static uint64_t _Upper(std::size_t index) {
+        if (index < kSub) {
+            return index;
+        }
+        const unsigned msb = index / kSub + 3;
+        const uint64_t sub = index % kSub;
+        return ((kSub + sub + 1) << (msb - 4)) - 1;
+    }
+
+    std::vector<uint64_t> _buckets;
+    uint64_t _count = 0;
+    uint64_t _max = 0;
+};
+
+} // namespace Test
+} // namespace Afina
+
+#endif // AFINA_TEST_HISTOGRAM_H
@@ -0,0 +1,66 @@
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <afina/allocator/Arena.h>
+#include <afina/allocator/StlAllocator.h>
+
+using namespace std;
+using namespace Afina::Allocator;
+
+TEST(ArenaTest, AlignedBump) {
+    Arena arena(256);
+
+    char *a = static_cast<char *>(arena.alloc(3, 1));
+    char *b = static_cast<char *>(arena.alloc(8, 8));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % 8, 0);
+    EXPECT_GE(b, a + 3);
+    EXPECT_LT(b, a + 16);
+
+    // Larger than block
+    void *large = arena.alloc(1000);
+    EXPECT_NE(large, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(large) % alignof(std::max_align_t), 0);
+}
+
+TEST(ArenaTest, ResetReusesMemory) {
+    Arena arena(64);
+
+    // Warm up: request needs several blocks, reset merges them
+    void *first = nullptr;
+    for (int i = 0; i < 10; i++) {
+        void *p = arena.alloc(48);
+        if (i == 0) {
+            first = p;
+        }
+    }
+    size_t capacity = arena.capacity();
+    arena.reset();
+    EXPECT_GE(arena.capacity(), capacity);
+
+    // Same pattern fits the single block now
+    first = arena.alloc(48);
+    for (int i = 1; i < 10; i++) {
+        arena.alloc(48);
+    }
+    EXPECT_EQ(arena.capacity(), capacity);
+
+    arena.reset();
+    EXPECT_EQ(arena.alloc(48), first);
+}
+
+TEST(ArenaTest, Containers) {
+    Arena arena;
+    using string_type = basic_string<char, char_traits<char>, StlAllocator<char, Arena>>;
+
+    vector<string_type, StlAllocator<string_type, Arena>> keys{StlAllocator<string_type, Arena>(arena)};
+    for (int i = 0; i < 20; i++) {
+        keys.emplace_back(("some long key number " + to_string(i)).c_str(), StlAllocator<char, Arena>(arena));
+    }
+    EXPECT_EQ(keys[13], "some long key number 13");
+
+    keys.clear();
+    keys.shrink_to_fit();
+    arena.reset();
+}
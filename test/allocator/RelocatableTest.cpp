@@ -0,0 +1,132 @@
+#include "gtest/gtest.h"
+#include <cstring>
+#include <vector>
+
+#include <afina/allocator/Error.h>
+#include <afina/allocator/Relocatable.h>
+
+using namespace std;
+using namespace Afina::Allocator;
+
+namespace {
+
+void Fill(Relocatable &a, Relocatable::Handle h, size_t size, char seed) {
+    char *data = static_cast<char *>(a.get(h));
+    for (size_t i = 0; i < size; i++) {
+        data[i] = static_cast<char>(seed + i % 31);
+    }
+}
+
+bool Check(Relocatable &a, Relocatable::Handle h, size_t size, char seed) {
+    const char *data = static_cast<const char *>(a.get(h));
+    for (size_t i = 0; i < size; i++) {
+        if (data[i] != static_cast<char>(seed + i % 31)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(RelocatableTest, AllocFree) {
+    vector<char> buf(65536);
+    Relocatable *a = Relocatable::Create(buf.data(), buf.size());
+    ASSERT_NE(nullptr, a);
+
+    Relocatable::Handle h = a->alloc(500);
+    ASSERT_NE(0, h);
+    EXPECT_GE(a->size(h), 500);
+    char *data = static_cast<char *>(a->get(h));
+    EXPECT_GE(data, buf.data());
+    EXPECT_LE(data + 500, buf.data() + buf.size());
+
+    a->free(h);
+    EXPECT_THROW(a->free(h), AllocError);
+    EXPECT_THROW(a->free(12345), AllocError);
+    EXPECT_EQ(0, a->used_bytes());
+}
+
+TEST(RelocatableTest, ReuseFreeBlocks) {
+    vector<char> buf(65536);
+    Relocatable *a = Relocatable::Create(buf.data(), buf.size());
+
+    vector<Relocatable::Handle> handles;
+    while (Relocatable::Handle h = a->alloc(100)) {
+        handles.push_back(h);
+    }
+    ASSERT_GT(handles.size(), 100);
+    EXPECT_EQ(0, a->alloc(100));
+
+    // Freed block is taken by the allocation of the same size
+    a->free(handles[10]);
+    handles[10] = a->alloc(100);
+    EXPECT_NE(0, handles[10]);
+
+    // Larger one gets split
+    a->free(handles[20]);
+    a->free(handles[21]);
+    EXPECT_EQ(0, a->alloc(200));
+    a->free(handles[22]);
+    EXPECT_EQ(0, a->alloc(300));
+    handles[20] = a->alloc(60);
+    handles[21] = a->alloc(16);
+    EXPECT_NE(0, handles[20]);
+    EXPECT_NE(0, handles[21]);
+}
+
+TEST(RelocatableTest, Defrag) {
+    vector<char> buf(65536);
+    Relocatable *a = Relocatable::Create(buf.data(), buf.size());
+
+    vector<Relocatable::Handle> handles;
+    vector<size_t> sizes;
+    for (size_t i = 0; Relocatable::Handle h = a->alloc(50 + i % 7 * 30); i++) {
+        handles.push_back(h);
+        sizes.push_back(50 + i % 7 * 30);
+        Fill(*a, h, sizes.back(), static_cast<char>(i));
+    }
+
+    for (size_t i = 0; i < handles.size(); i += 2) {
+        a->free(handles[i]);
+    }
+    EXPECT_EQ(0, a->alloc(4096));
+
+    a->defrag();
+    EXPECT_EQ(0, a->free_bytes());
+    EXPECT_NE(0, a->alloc(4096));
+    for (size_t i = 1; i < handles.size(); i += 2) {
+        EXPECT_TRUE(Check(*a, handles[i], sizes[i], static_cast<char>(i)));
+    }
+}
+
+TEST(RelocatableTest, AttachAtOtherAddress) {
+    vector<char> buf(65536);
+    Relocatable *a = Relocatable::Create(buf.data(), buf.size());
+
+    vector<Relocatable::Handle> handles;
+    for (int i = 0; i < 100; i++) {
+        handles.push_back(a->alloc(64));
+        Fill(*a, handles.back(), 64, static_cast<char>(i));
+    }
+    a->free(handles[50]);
+
+    // Area is copied as is, like another process maps it
+    vector<char> copy(buf);
+    Relocatable *b = Relocatable::Attach(copy.data(), copy.size());
+    ASSERT_NE(nullptr, b);
+    for (int i = 0; i < 100; i++) {
+        if (i != 50) {
+            EXPECT_TRUE(Check(*b, handles[i], 64, static_cast<char>(i)));
+            EXPECT_GE(static_cast<char *>(b->get(handles[i])), copy.data());
+            EXPECT_LT(static_cast<char *>(b->get(handles[i])), copy.data() + copy.size());
+        }
+    }
+    EXPECT_THROW(b->free(handles[50]), AllocError);
+    EXPECT_NE(0, b->alloc(64));
+
+    // Garbage and area of other size aren't attached
+    vector<char> garbage(65536, 'x');
+    EXPECT_EQ(nullptr, Relocatable::Attach(garbage.data(), garbage.size()));
+    EXPECT_EQ(nullptr, Relocatable::Attach(copy.data(), copy.size() - 4096));
+}
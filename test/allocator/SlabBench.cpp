@@ -0,0 +1,129 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <afina/allocator/Slab.h>
+#include <afina/allocator/SlabPool.h>
+
+using namespace Afina::Allocator;
+
+// Slab shared under the single lock, baseline for the pool
+class LockedSlab {
+public:
+    explicit LockedSlab(std::size_t max_size) : _slab(max_size) {}
+
+    void *alloc(std::size_t size) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _slab.alloc(size);
+    }
+
+    void free(void *p) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _slab.free(p);
+    }
+
+private:
+    std::mutex _mutex;
+    Slab _slab;
+};
+
+// System allocator
+class Malloc {
+public:
+    void *alloc(std::size_t size) { return std::malloc(size); }
+    void free(void *p) { std::free(p); }
+};
+
+/**
+ * Every thread allocates batch of chunks of random sizes, passes it to the neighbour through the mailbox and frees
+ * the batch received from another neighbour, so half of frees are cross thread ones
+ */
+template <typename Allocator> double _run(Allocator &allocator, std::size_t threads, std::size_t rounds) {
+    const std::size_t batch = 64;
+    std::vector<std::atomic<std::vector<void *> *>> mailboxes(threads);
+    for (auto &mailbox : mailboxes) {
+        mailbox.store(nullptr);
+    }
+
+    auto worker = [&](std::size_t id) {
+        unsigned seed = static_cast<unsigned>(id) + 1;
+        std::vector<void *> *local = new std::vector<void *>();
+        for (std::size_t round = 0; round < rounds; round++) {
+            for (std::size_t i = 0; i < batch; i++) {
+                seed = seed * 1103515245 + 12345;
+                void *p = allocator.alloc(16 + (seed >> 16) % 496);
+                if (p != nullptr) {
+                    local->push_back(p);
+                }
+            }
+
+            // Odd rounds free own chunks, even ones exchange them with neighbours
+            if (round % 2 == 0) {
+                local = mailboxes[(id + 1) % threads].exchange(local);
+                if (local == nullptr) {
+                    local = new std::vector<void *>();
+                }
+            }
+            for (void *p : *local) {
+                allocator.free(p);
+            }
+            local->clear();
+        }
+        delete local;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (std::size_t id = 0; id < threads; id++) {
+        workers.emplace_back(worker, id);
+    }
+    for (auto &t : workers) {
+        t.join();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    for (auto &mailbox : mailboxes) {
+        std::vector<void *> *left = mailbox.exchange(nullptr);
+        if (left != nullptr) {
+            for (void *p : *left) {
+                allocator.free(p);
+            }
+            delete left;
+        }
+    }
+
+    double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    return ns / (threads * rounds * batch);
+}
+
+/**
+ * Multithreaded alloc/free throughput of the slab pool compared to the locked slab and malloc, reports average
+ * time of alloc+free pair per thread
+ *
+ * Usage: runSlabBench [threads] [rounds]
+ */
+int main(int argc, char **argv) {
+    std::size_t threads = argc > 1 ? std::atoi(argv[1]) : std::thread::hardware_concurrency();
+    std::size_t rounds = argc > 2 ? std::atoi(argv[2]) : 100000;
+    const std::size_t max_size = 256 << 20;
+
+    std::cout << "threads: " << threads << std::endl;
+    {
+        SlabPool pool(max_size);
+        std::cout << "slab pool: " << _run(pool, threads, rounds) << " ns" << std::endl;
+    }
+    {
+        LockedSlab slab(max_size);
+        std::cout << "locked slab: " << _run(slab, threads, rounds) << " ns" << std::endl;
+    }
+    {
+        Malloc malloc;
+        std::cout << "malloc: " << _run(malloc, threads, rounds) << " ns" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,179 @@
+#include "gtest/gtest.h"
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <afina/allocator/Error.h>
+#include <afina/allocator/Slab.h>
+#include <afina/allocator/SlabPool.h>
+
+using namespace std;
+using namespace Afina::Allocator;
+
+TEST(SlabTest, SizeClasses) {
+    Slab slab(1 << 20, 64 << 10);
+
+    size_t prev = 0;
+    for (unsigned cls = 0; cls < slab.classes(); cls++) {
+        size_t size = slab.stats(cls).chunk_size;
+        EXPECT_GT(size, prev);
+        if (prev != 0 && cls + 1 < slab.classes()) {
+            EXPECT_LE(size, prev * 5 / 4 + sizeof(void *));
+        }
+        prev = size;
+    }
+    EXPECT_EQ(prev, slab.page_size());
+
+    EXPECT_EQ(slab.class_of(1), 0);
+    EXPECT_EQ(slab.class_of(slab.page_size()), slab.classes() - 1);
+    EXPECT_EQ(slab.class_of(slab.page_size() + 1), Slab::kNoClass);
+    EXPECT_EQ(slab.alloc(slab.page_size() + 1), nullptr);
+}
+
+TEST(SlabTest, AllocReadWrite) {
+    Slab slab(1 << 20, 64 << 10);
+
+    vector<pair<char *, size_t>> chunks;
+    for (size_t size = 1; size < 10000; size = size * 3 + 1) {
+        char *p = static_cast<char *>(slab.alloc(size));
+        ASSERT_NE(p, nullptr);
+        EXPECT_GE(slab.usable_size(p), size);
+        memset(p, size % 251, size);
+        chunks.emplace_back(p, size);
+    }
+
+    for (auto &chunk : chunks) {
+        for (size_t i = 0; i < chunk.second; i++) {
+            ASSERT_EQ(chunk.first[i], char(chunk.second % 251));
+        }
+        slab.free(chunk.first);
+    }
+
+    for (unsigned cls = 0; cls < slab.classes(); cls++) {
+        EXPECT_EQ(slab.stats(cls).used, 0);
+    }
+}
+
+TEST(SlabTest, Limit) {
+    Slab slab(4 << 10, 1 << 10);
+    ASSERT_EQ(slab.pages(), 4);
+
+    vector<void *> chunks;
+    void *p;
+    while ((p = slab.alloc(100)) != nullptr) {
+        chunks.push_back(p);
+    }
+
+    unsigned cls = slab.class_of(100);
+    EXPECT_EQ(chunks.size(), slab.stats(cls).per_page * 4);
+    EXPECT_EQ(slab.stats(cls).fails, 1);
+    EXPECT_EQ(slab.free_pages(), 0);
+
+    for (void *chunk : chunks) {
+        slab.free(chunk);
+    }
+    EXPECT_THROW(slab.free(&chunks), AllocError);
+}
+
+TEST(SlabTest, PageReassign) {
+    Slab slab(4 << 10, 1 << 10);
+
+    // Fill all pages with small chunks, then free them
+    vector<void *> chunks;
+    void *p;
+    while ((p = slab.alloc(64)) != nullptr) {
+        chunks.push_back(p);
+    }
+    for (void *chunk : chunks) {
+        slab.free(chunk);
+    }
+
+    // Class keeps single empty page, the rest go back to the pool
+    unsigned small = slab.class_of(64);
+    EXPECT_EQ(slab.stats(small).pages, 1);
+    EXPECT_EQ(slab.free_pages(), 3);
+
+    // Large class gets all pages, the last one is taken away from the small class
+    unsigned large = slab.class_of(1 << 10);
+    for (int i = 0; i < 4; i++) {
+        EXPECT_NE(slab.alloc(1 << 10), nullptr);
+    }
+    EXPECT_EQ(slab.stats(small).pages, 0);
+    EXPECT_EQ(slab.stats(large).pages, 4);
+    EXPECT_EQ(slab.stats(large).reassigned, 1);
+    EXPECT_EQ(slab.alloc(1 << 10), nullptr);
+}
+
+TEST(SlabTest, HugePages) {
+    // Falls back to ordinary pages if there are no huge pages in the system
+    Slab slab(3 << 20, 1 << 20, 48, 1.25, true);
+    EXPECT_TRUE(slab.memory_page_size() == (2 << 20) || slab.memory_page_size() == 4096);
+    EXPECT_EQ(slab.pages(), 3);
+
+    vector<char *> chunks;
+    while (char *p = static_cast<char *>(slab.alloc(100 << 10))) {
+        memset(p, 'x', 100 << 10);
+        chunks.push_back(p);
+    }
+    EXPECT_GT(chunks.size(), 20);
+    for (char *p : chunks) {
+        EXPECT_EQ(p[0], 'x');
+        slab.free(p);
+    }
+
+    Slab plain(1 << 20);
+    EXPECT_EQ(plain.memory_page_size(), 4096);
+}
+
+TEST(SlabPoolTest, CrossThreadFree) {
+    SlabPool pool(64 << 10, 4 << 10);
+
+    const int threads = 4;
+    vector<vector<char *>> chunks(threads);
+    vector<thread> workers;
+    for (int id = 0; id < threads; id++) {
+        workers.emplace_back([&pool, &chunks, id]() {
+            for (int i = 0; i < 200; i++) {
+                char *p = static_cast<char *>(pool.alloc(64));
+                if (p == nullptr) {
+                    break;
+                }
+                memset(p, id, 64);
+                chunks[id].push_back(p);
+            }
+        });
+    }
+    for (auto &t : workers) {
+        t.join();
+    }
+    workers.clear();
+
+    set<char *> unique;
+    for (int id = 0; id < threads; id++) {
+        for (char *p : chunks[id]) {
+            EXPECT_TRUE(unique.insert(p).second);
+            EXPECT_EQ(p[0], char(id));
+            EXPECT_EQ(p[63], char(id));
+        }
+    }
+
+    // Every thread frees chunks allocated by the neighbour
+    for (int id = 0; id < threads; id++) {
+        workers.emplace_back([&pool, &chunks, id]() {
+            for (char *p : chunks[(id + 1) % threads]) {
+                pool.free(p);
+            }
+        });
+    }
+    for (auto &t : workers) {
+        t.join();
+    }
+
+    // Cached chunks get back to slab, so all pages could be reassigned to another class
+    size_t pages = 0;
+    while (pool.alloc(4 << 10) != nullptr) {
+        pages++;
+    }
+    EXPECT_EQ(pages, 16);
+}
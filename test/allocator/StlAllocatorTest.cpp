@@ -0,0 +1,62 @@
+#include "gtest/gtest.h"
+#include <map>
+#include <string>
+#include <vector>
+
+#include <afina/allocator/Simple.h>
+#include <afina/allocator/Slab.h>
+#include <afina/allocator/StlAllocator.h>
+
+using namespace std;
+using namespace Afina::Allocator;
+
+template <typename Arena> using arena_string = basic_string<char, char_traits<char>, StlAllocator<char, Arena>>;
+
+TEST(StlAllocatorTest, SlabContainers) {
+    Slab slab(64 << 10, 4 << 10);
+    using string_type = arena_string<Slab>;
+    using allocator_type = StlAllocator<pair<const string_type, string_type>, Slab>;
+
+    map<string_type, string_type, less<string_type>, allocator_type> index{allocator_type(slab)};
+    for (int i = 0; i < 50; i++) {
+        string_type key(("key" + to_string(i)).c_str(), string_type::allocator_type(slab));
+        string_type value(string(100, 'a' + i % 26).c_str(), string_type::allocator_type(slab));
+        index.emplace(key, value);
+    }
+
+    size_t used = 0;
+    for (unsigned cls = 0; cls < slab.classes(); cls++) {
+        used += slab.stats(cls).used;
+    }
+    EXPECT_GE(used, 100);
+
+    string_type key("key7", string_type::allocator_type(slab));
+    EXPECT_EQ(index.at(key), string(100, 'h').c_str());
+
+    index.clear();
+    used = 0;
+    for (unsigned cls = 0; cls < slab.classes(); cls++) {
+        used += slab.stats(cls).used;
+    }
+    EXPECT_EQ(used, 0);
+}
+
+TEST(StlAllocatorTest, BoundedBySimple) {
+    static char buf[4096];
+    Simple simple(buf, sizeof(buf));
+
+    vector<int, StlAllocator<int, Simple>> v{StlAllocator<int, Simple>(simple)};
+    EXPECT_THROW(
+        {
+            for (int i = 0; i < 10000; i++) {
+                v.push_back(i);
+            }
+        },
+        bad_alloc);
+
+    for (size_t i = 0; i < v.size(); i++) {
+        EXPECT_EQ(v[i], int(i));
+    }
+    EXPECT_GE(reinterpret_cast<char *>(v.data()), buf);
+    EXPECT_LE(reinterpret_cast<char *>(v.data() + v.size()), buf + sizeof(buf));
+}
@@ -0,0 +1,54 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include <afina/coroutine/Channel.h>
+#include <afina/coroutine/Scheduler.h>
+
+using namespace Afina::Coroutine;
+
+// Sends token to the peer and waits for it back
+void _ping(Channel<int> &out, Channel<int> &in, int rounds) {
+    int token = 0;
+    for (int i = 0; i < rounds; i++) {
+        out.send(token);
+        in.recv(token);
+    }
+    out.close();
+}
+
+// Returns every token back
+void _pong(Channel<int> &in, Channel<int> &out) {
+    int token;
+    while (in.recv(token)) {
+        out.send(token + 1);
+    }
+}
+
+/**
+ * Ping-pong between two routines over a pair of channels, reports average latency of one handoff
+ *
+ * Usage: runChannelBench [threads] [rounds]
+ */
+int main(int argc, char **argv) {
+    std::size_t threads = argc > 1 ? std::atoi(argv[1]) : 1;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 1000000;
+
+    Scheduler scheduler(threads);
+    Channel<int> ping(1), pong(1);
+    scheduler.spawn(_ping, std::ref(ping), std::ref(pong), rounds);
+    scheduler.spawn(_pong, std::ref(ping), std::ref(pong));
+
+    auto start = std::chrono::steady_clock::now();
+    scheduler.Start();
+    scheduler.Stop();
+    scheduler.Join();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    std::cout << "threads: " << scheduler.Threads() << std::endl;
+    std::cout << "handoffs: " << 2L * rounds << std::endl;
+    std::cout << "handoff latency: " << ns / (2.0 * rounds) << " ns" << std::endl;
+    std::cout << "switches: " << scheduler.GetStats().switches << std::endl;
+    return 0;
+}
@@ -69,3 +69,46 @@ TEST(CoroutineTest, Printer) {
     engine.start(_printer, engine, result);
     ASSERT_STREQ("A1 B1 A2 B2 A3 B3 END", result.c_str());
 }
+
+void _noop(int &counter) { counter++; }
+
+void _spawner(Afina::Coroutine::Engine &pe, int &counter, int total) {
+    for (int i = 0; i < total; i++) {
+        void *routine = pe.run(_noop, counter);
+        ASSERT_NE(nullptr, routine);
+        pe.sched(routine);
+    }
+}
+
+TEST(CoroutineTest, StackReuse) {
+    Afina::Coroutine::Engine engine;
+    Afina::Coroutine::StackPool::Stats before = Afina::Coroutine::StackPool::GlobalStats();
+
+    int counter = 0;
+    engine.start(_spawner, engine, counter, 100);
+    ASSERT_EQ(100, counter);
+
+    // Short living routines must get stacks from the pool rather than map new ones
+    Afina::Coroutine::StackPool::Stats after = Afina::Coroutine::StackPool::GlobalStats();
+    ASSERT_GE(after.reused - before.reused, 90);
+    ASSERT_LE(after.allocated - before.allocated, 10);
+}
+
+TEST(CoroutineTest, StackPoolLimit) {
+    Afina::Coroutine::StackPool pool(8192, 0);
+
+    uint32_t capacity = 0;
+    char *first = pool.Acquire(5000, capacity);
+    ASSERT_NE(nullptr, first);
+    ASSERT_EQ(8192, capacity);
+
+    // Whole limit is used already
+    uint32_t other_capacity = 0;
+    ASSERT_EQ(nullptr, pool.Acquire(10, other_capacity));
+
+    pool.Release(first, capacity);
+    char *second = pool.Acquire(10, other_capacity);
+    ASSERT_NE(nullptr, second);
+    ASSERT_EQ(4096, other_capacity);
+    pool.Release(second, other_capacity);
+}
@@ -0,0 +1,114 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include <afina/coroutine/Scheduler.h>
+
+using Afina::Coroutine::Scheduler;
+
+void _yielder(std::atomic<int> &counter, int times) {
+    for (int i = 0; i < times; i++) {
+        counter++;
+        Scheduler::yield();
+    }
+}
+
+TEST(SchedulerTest, RunAll) {
+    Scheduler scheduler(4);
+
+    std::atomic<int> counter(0);
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(scheduler.spawn(_yielder, std::ref(counter), 10));
+    }
+
+    scheduler.Start();
+    scheduler.Stop();
+    scheduler.Join();
+
+    ASSERT_EQ(10000, counter.load());
+
+    Scheduler::Stats stats = scheduler.GetStats();
+    ASSERT_EQ(1000, stats.spawned);
+    ASSERT_EQ(1000, stats.completed);
+    ASSERT_GE(stats.switches, 11000);
+}
+
+struct Mailbox {
+    std::mutex mutex;
+    void *waiter = nullptr;
+    int value = 0;
+};
+
+void _receiver(Mailbox &box, int &result) {
+    std::unique_lock<std::mutex> lock(box.mutex);
+    while (box.value == 0) {
+        box.waiter = Scheduler::current();
+        Scheduler::park(lock);
+    }
+    result = box.value;
+}
+
+void _sender(Mailbox &box) {
+    // Let receiver park first in most of the runs
+    for (int i = 0; i < 10; i++) {
+        Scheduler::yield();
+    }
+
+    std::unique_lock<std::mutex> lock(box.mutex);
+    box.value = 42;
+    if (box.waiter != nullptr) {
+        Scheduler::wake(box.waiter);
+        box.waiter = nullptr;
+    }
+}
+
+TEST(SchedulerTest, ParkWake) {
+    Scheduler scheduler(2);
+
+    Mailbox box;
+    int result = 0;
+    scheduler.spawn(_receiver, std::ref(box), std::ref(result));
+    scheduler.spawn(_sender, std::ref(box));
+
+    scheduler.Start();
+    scheduler.Stop();
+    scheduler.Join();
+
+    ASSERT_EQ(42, result);
+}
+
+void _spawner(Scheduler &scheduler, std::atomic<int> &counter) {
+    for (int i = 0; i < 100; i++) {
+        scheduler.spawn(_yielder, std::ref(counter), 1);
+    }
+}
+
+TEST(SchedulerTest, SpawnFromRoutine) {
+    Scheduler scheduler(3);
+
+    std::atomic<int> counter(0);
+    scheduler.spawn(_spawner, std::ref(scheduler), std::ref(counter));
+
+    scheduler.Start();
+    scheduler.Stop();
+    scheduler.Join();
+
+    ASSERT_EQ(100, counter.load());
+}
+
+TEST(SchedulerTest, ExceptionTerminates) {
+    ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+    ASSERT_DEATH(
+        {
+            Scheduler scheduler(2);
+            scheduler.spawn([] { throw std::runtime_error("routine failed"); });
+            scheduler.Start();
+            scheduler.Stop();
+            scheduler.Join();
+        },
+        "routine failed");
+}
@@ -0,0 +1,134 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include <afina/coroutine/Channel.h>
+#include <afina/coroutine/Scheduler.h>
+#include <afina/coroutine/Sync.h>
+
+using namespace Afina::Coroutine;
+
+void _producer(Channel<int> &channel, int from, int to) {
+    for (int i = from; i < to; i++) {
+        ASSERT_TRUE(channel.send(i));
+    }
+}
+
+void _consumer(Channel<int> &channel, std::atomic<long> &sum, WaitGroup &group) {
+    int value;
+    while (channel.recv(value)) {
+        sum += value;
+    }
+    group.done();
+}
+
+void _closer(Channel<int> &channel, WaitGroup &producers) {
+    producers.wait();
+    channel.close();
+}
+
+void _counted_producer(Channel<int> &channel, int from, int to, WaitGroup &group) {
+    _producer(channel, from, to);
+    group.done();
+}
+
+TEST(SyncTest, ChannelMPMC) {
+    Scheduler scheduler(4);
+    Channel<int> channel(8);
+    WaitGroup producers, consumers;
+    std::atomic<long> sum(0);
+
+    producers.add(4);
+    consumers.add(4);
+    for (int i = 0; i < 4; i++) {
+        scheduler.spawn(_counted_producer, std::ref(channel), i * 1000, (i + 1) * 1000, std::ref(producers));
+        scheduler.spawn(_consumer, std::ref(channel), std::ref(sum), std::ref(consumers));
+    }
+    scheduler.spawn(_closer, std::ref(channel), std::ref(producers));
+
+    scheduler.Start();
+
+    // Ordinary thread could wait on the same primitives
+    consumers.wait();
+    ASSERT_EQ(3999L * 4000L / 2, sum.load());
+
+    scheduler.Stop();
+    scheduler.Join();
+}
+
+TEST(SyncTest, ChannelClosed) {
+    Channel<int> channel(2);
+    ASSERT_TRUE(channel.try_send(1));
+    ASSERT_TRUE(channel.try_send(2));
+    ASSERT_FALSE(channel.try_send(3));
+
+    channel.close();
+    ASSERT_FALSE(channel.send(4));
+
+    int value = 0;
+    ASSERT_TRUE(channel.recv(value));
+    ASSERT_EQ(1, value);
+    ASSERT_TRUE(channel.recv(value));
+    ASSERT_EQ(2, value);
+    ASSERT_FALSE(channel.recv(value));
+}
+
+void _incrementer(Mutex &mutex, long &counter, int times) {
+    for (int i = 0; i < times; i++) {
+        std::lock_guard<Mutex> lock(mutex);
+        long value = counter;
+        Scheduler::yield();
+        counter = value + 1;
+    }
+}
+
+TEST(SyncTest, MutexExclusive) {
+    Scheduler scheduler(4);
+    Mutex mutex;
+    long counter = 0;
+
+    for (int i = 0; i < 16; i++) {
+        scheduler.spawn(_incrementer, std::ref(mutex), std::ref(counter), 100);
+    }
+
+    scheduler.Start();
+    scheduler.Stop();
+    scheduler.Join();
+
+    ASSERT_EQ(1600, counter);
+}
+
+struct Gate {
+    Mutex mutex;
+    ConditionVariable condition;
+    bool open = false;
+};
+
+void _gate_waiter(Gate &gate, std::atomic<int> &passed) {
+    std::unique_lock<Mutex> lock(gate.mutex);
+    gate.condition.wait(lock, [&gate] { return gate.open; });
+    passed++;
+}
+
+TEST(SyncTest, ConditionVariable) {
+    Scheduler scheduler(2);
+    Gate gate;
+    std::atomic<int> passed(0);
+
+    for (int i = 0; i < 10; i++) {
+        scheduler.spawn(_gate_waiter, std::ref(gate), std::ref(passed));
+    }
+    scheduler.Start();
+
+    {
+        std::lock_guard<Mutex> lock(gate.mutex);
+        gate.open = true;
+    }
+    gate.condition.notify_all();
+
+    scheduler.Stop();
+    scheduler.Join();
+    ASSERT_EQ(10, passed.load());
+}
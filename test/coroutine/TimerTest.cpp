@@ -0,0 +1,111 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <afina/coroutine/Scheduler.h>
+#include <afina/coroutine/TimerWheel.h>
+
+using namespace Afina::Coroutine;
+
+TEST(TimerWheelTest, ExpireInOrder) {
+    TimerWheel wheel(100);
+
+    // Cover all levels of the wheel
+    std::vector<uint64_t> delays = {1, 5, 63, 64, 65, 1000, 4095, 4096, 5000, 300000, 300001};
+    std::vector<TimerWheel::timer> timers(delays.size());
+    for (std::size_t i = 0; i < delays.size(); i++) {
+        timers[i].data = &delays[i];
+        wheel.Add(&timers[i], 100 + delays[i]);
+    }
+    ASSERT_EQ(delays.size(), wheel.Size());
+
+    std::vector<uint64_t> fired_at;
+    for (uint64_t now = 101; now <= 100 + 300001; now++) {
+        wheel.Advance(now, [&](TimerWheel::timer *t) {
+            ASSERT_EQ(now, t->expires);
+            fired_at.push_back(now - 100);
+        });
+    }
+
+    ASSERT_EQ(delays, fired_at);
+    ASSERT_EQ(0, wheel.Size());
+}
+
+TEST(TimerWheelTest, Cancel) {
+    TimerWheel wheel;
+    TimerWheel::timer a, b;
+    wheel.Add(&a, 10);
+    wheel.Add(&b, 5000);
+    wheel.Cancel(&a);
+    wheel.Cancel(&a);
+    ASSERT_FALSE(a.active());
+    ASSERT_EQ(1, wheel.Size());
+    ASSERT_EQ(10, wheel.NextExpiration(10));
+
+    int fired = 0;
+    wheel.Advance(6000, [&](TimerWheel::timer *t) {
+        ASSERT_EQ(&b, t);
+        fired++;
+    });
+    ASSERT_EQ(1, fired);
+}
+
+void _sleeper(std::atomic<int> &done) {
+    Scheduler::sleep(std::chrono::milliseconds(30));
+    done++;
+}
+
+TEST(TimerTest, SleepDoesNotHoldThread) {
+    Scheduler scheduler(1);
+
+    std::atomic<int> done(0);
+    for (int i = 0; i < 100; i++) {
+        scheduler.spawn(_sleeper, std::ref(done));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    scheduler.Start();
+    scheduler.Stop();
+    scheduler.Join();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // All routines slept at the same time on the single thread
+    ASSERT_EQ(100, done.load());
+    ASSERT_GE(elapsed, std::chrono::milliseconds(30));
+    ASSERT_LT(elapsed, std::chrono::milliseconds(1000));
+}
+
+void _reader(int fd, uint32_t &timed_out, uint32_t &ready) {
+    timed_out = Scheduler::wait_io(fd, EPOLLIN, std::chrono::milliseconds(10));
+    ready = Scheduler::wait_io(fd, EPOLLIN, std::chrono::milliseconds(5000));
+}
+
+void _writer(int fd) {
+    Scheduler::sleep(std::chrono::milliseconds(50));
+    ASSERT_EQ(1, write(fd, "x", 1));
+}
+
+TEST(TimerTest, WaitIO) {
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+
+    Scheduler scheduler(2);
+    uint32_t timed_out = 1, ready = 0;
+    scheduler.spawn(_reader, fds[0], std::ref(timed_out), std::ref(ready));
+    scheduler.spawn(_writer, fds[1]);
+
+    scheduler.Start();
+    scheduler.Stop();
+    scheduler.Join();
+
+    ASSERT_EQ(0, timed_out);
+    ASSERT_TRUE(ready & EPOLLIN);
+
+    close(fds[0]);
+    close(fds[1]);
+}
@@ -0,0 +1,75 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <afina/allocator/Arena.h>
+#include <afina/execute/Get.h>
+
+#include "storage/SimpleLRU.h"
+
+using namespace Afina;
+
+namespace {
+
+// Number of global operator new calls made by the process
+std::atomic<uint64_t> g_allocations(0);
+
+} // namespace
+
+void *operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void *p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+TEST(GetTest, Response) {
+    Backend::SimpleLRU storage;
+    storage.Put("foo", "bar");
+    storage.Put("key", "value");
+
+    std::string out;
+    Execute::Get get({"foo", "missing", "key"});
+    get.Execute(storage, "", out);
+    EXPECT_EQ("VALUE foo 0 3\r\nbar\r\nVALUE key 0 5\r\nvalue\r\nEND", out);
+}
+
+TEST(GetTest, HeapFreeOnceWarmedUp) {
+    // Keys and values are long enough to not fit into std::string itself
+    Backend::SimpleLRU storage(1 << 20);
+    std::vector<std::string> keys;
+    for (int i = 0; i < 8; i++) {
+        keys.push_back("rather_long_key_number_" + std::to_string(i));
+        storage.Put(keys.back(), std::string(100 + i, 'v'));
+    }
+    keys.push_back("rather_long_missing_key");
+
+    Allocator::Arena arena;
+    std::string out;
+    auto request = [&]() {
+        out.resize(0);
+        Execute::Get *get = arena.make<Execute::Get>(keys, arena);
+        get->Execute(storage, "", out);
+        get->~Get();
+        arena.reset();
+    };
+
+    for (int i = 0; i < 4; i++) {
+        request();
+    }
+
+    const uint64_t before = g_allocations.load();
+    for (int i = 0; i < 100; i++) {
+        request();
+    }
+    EXPECT_EQ(before, g_allocations.load());
+    EXPECT_EQ(0, out.compare(0, 36, "VALUE rather_long_key_number_0 0 100"));
+}
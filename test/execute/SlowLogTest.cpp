@@ -0,0 +1,42 @@
+#include "gtest/gtest.h"
+
+#include <afina/execute/SlowLog.h>
+
+using namespace Afina::Execute;
+
+TEST(SlowLogTest, Threshold) {
+    SlowLog log(4, 1000);
+    EXPECT_EQ(1000, log.Threshold());
+    EXPECT_FALSE(log.IsSlow(TscClock::from_ns(500 * 1000)));
+    EXPECT_TRUE(log.IsSlow(TscClock::from_ns(2000 * 1000)));
+
+    log.SetThreshold(0);
+    EXPECT_TRUE(log.IsSlow(0));
+}
+
+TEST(SlowLogTest, KeepsNewest) {
+    SlowLog log(3, 0);
+    for (int i = 0; i < 5; i++) {
+        log.Add("get", i, 10 * i, 20 * i, "-", TscClock::from_ns(i * 1000 * 1000));
+    }
+    EXPECT_EQ(5, log.Total());
+
+    std::vector<SlowLog::Entry> entries = log.Entries();
+    ASSERT_EQ(3, entries.size());
+    for (int i = 0; i < 3; i++) {
+        const SlowLog::Entry &e = entries[i];
+        EXPECT_EQ(4 - i, e.id);
+        EXPECT_EQ("get", e.command);
+        EXPECT_EQ(4 - i, e.keys);
+        EXPECT_EQ(10 * (4 - i), e.bytes_in);
+        EXPECT_EQ(20 * (4 - i), e.bytes_out);
+        EXPECT_EQ("-", e.client);
+        EXPECT_NEAR(1000 * (4 - i), e.elapsed_us, 1);
+    }
+}
+
+TEST(SlowLogTest, Clock) {
+    const uint64_t start = TscClock::now();
+    EXPECT_GT(TscClock::ticks_per_ns(), 0);
+    EXPECT_GE(TscClock::now(), start);
+}
@@ -0,0 +1,106 @@
+#include "gtest/gtest.h"
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <spdlog/sinks/ostream_sink.h>
+
+#include <afina/logging/Context.h>
+
+#include "logging/ContextLogger.h"
+
+using namespace std;
+using namespace Afina::Logging;
+
+static string Render() {
+    char buffer[256];
+    return string(buffer, ContextTag::Render(buffer, sizeof(buffer)));
+}
+
+TEST(ContextTest, NestedTags) {
+    EXPECT_EQ(Render(), "");
+    {
+        ContextTag conn("conn", int64_t(5));
+        EXPECT_EQ(Render(), " {conn=5}");
+
+        string command;
+        ContextTag cmd("cmd", command);
+        EXPECT_EQ(Render(), " {conn=5}");
+
+        command = "get";
+        EXPECT_EQ(Render(), " {conn=5, cmd=get}");
+
+        cmd.set("set");
+        EXPECT_EQ(Render(), " {conn=5, cmd=set}");
+    }
+    EXPECT_EQ(Render(), "");
+}
+
+TEST(ContextTest, ThreadLocal) {
+    ContextTag tag("thread", "main");
+
+    string other;
+    thread([&other] { other = Render(); }).join();
+    EXPECT_EQ(other, "");
+    EXPECT_EQ(Render(), " {thread=main}");
+}
+
+TEST(ContextTest, Truncated) {
+    ContextTag tag("key", "0123456789");
+
+    char buffer[8];
+    EXPECT_EQ(ContextTag::Render(buffer, sizeof(buffer)), sizeof(buffer));
+    EXPECT_EQ(string(buffer, sizeof(buffer)), " {key=01");
+}
+
+TEST(ContextTest, PeerAddress) {
+    PeerAddress peer(-1);
+    ContextTag tag("client", peer);
+    EXPECT_EQ(Render(), " {client=?}");
+}
+
+TEST(ContextTest, PeerAddressOutlivesSocket) {
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_NE(-1, server);
+
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(0, ::bind(server, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)));
+    ASSERT_EQ(0, listen(server, 1));
+    ASSERT_EQ(0, getsockname(server, reinterpret_cast<struct sockaddr *>(&addr), &addr_len));
+
+    int client = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(0, connect(client, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)));
+    ASSERT_EQ(0, getsockname(client, reinterpret_cast<struct sockaddr *>(&addr), &addr_len));
+    int accepted = accept(server, nullptr, nullptr);
+    ASSERT_NE(-1, accepted);
+
+    PeerAddress peer(accepted);
+    ContextTag tag("client", peer);
+    close(accepted);
+    close(client);
+    close(server);
+
+    EXPECT_EQ(Render(), " {client=127.0.0.1:" + to_string(ntohs(addr.sin_port)) + "}");
+}
+
+TEST(ContextTest, RenderedOnlyIfEmitted) {
+    ostringstream out;
+    auto sink = make_shared<spdlog::sinks::ostream_sink_mt>(out);
+    ContextLogger logger("test", sink);
+    logger.set_pattern("%v");
+    logger.set_level(spdlog::level::info);
+
+    ContextTag tag("conn", int64_t(7));
+    logger.debug("filtered");
+    logger.info("emitted");
+    EXPECT_EQ(out.str(), "emitted {conn=7}\n");
+}
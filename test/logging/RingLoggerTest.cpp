@@ -0,0 +1,169 @@
+#include "gtest/gtest.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <spdlog/sinks/base_sink.h>
+
+#include "logging/RingLogger.h"
+
+using namespace std;
+using namespace Afina::Logging;
+
+namespace {
+
+// Collects lines written one by one and by batches
+class test_sink : public spdlog::sinks::base_sink<std::mutex>, public batch_sink {
+public:
+    void flush() override {}
+
+    void write_batch(struct iovec *iov, int count) override {
+        std::lock_guard<std::mutex> lock(_mutex);
+        batches++;
+        for (int i = 0; i < count; i++) {
+            lines.emplace_back(static_cast<char *>(iov[i].iov_base), iov[i].iov_len);
+        }
+    }
+
+    vector<string> lines;
+    size_t batches = 0;
+
+protected:
+    void _sink_it(const spdlog::details::log_msg &msg) override {
+        lines.emplace_back(msg.formatted.data(), msg.formatted.size());
+    }
+};
+
+} // namespace
+
+TEST(RingBufferTest, Wrap) {
+    RingBuffer ring(4096);
+
+    string text;
+    for (int i = 0; i < 1000; i++) {
+        text.assign(i % 300, 'a' + i % 26);
+        ASSERT_TRUE(ring.push(&ring, i, i, i, text.data(), text.size()));
+
+        size_t popped = ring.pop([&](const RingBuffer::record &r) {
+            EXPECT_EQ(r.level, i);
+            EXPECT_EQ(string(r.text(), r.text_size), text);
+        });
+        EXPECT_EQ(popped, 1);
+        EXPECT_TRUE(ring.empty());
+    }
+}
+
+TEST(RingBufferTest, Full) {
+    RingBuffer ring(4096);
+
+    string text(100, 'x');
+    size_t pushed = 0;
+    while (ring.push(&ring, 0, 0, 0, text.data(), text.size())) {
+        pushed++;
+    }
+    EXPECT_GT(pushed, 20);
+    EXPECT_LT(pushed, 4096 / 100);
+
+    size_t popped = ring.pop([](const RingBuffer::record &) {});
+    EXPECT_EQ(popped, pushed);
+    EXPECT_TRUE(ring.push(&ring, 0, 0, 0, text.data(), text.size()));
+}
+
+TEST(RingBufferTest, ProducerConsumer) {
+    RingBuffer ring(4096);
+    const uint32_t count = 100000;
+
+    thread producer([&] {
+        for (uint32_t i = 0; i < count; i++) {
+            string text = to_string(i);
+            while (!ring.push(&ring, i, 0, 0, text.data(), text.size())) {
+                this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    while (expected < count) {
+        size_t popped = ring.pop([&](const RingBuffer::record &r) {
+            ASSERT_EQ(r.level, expected);
+            ASSERT_EQ(string(r.text(), r.text_size), to_string(expected));
+            expected++;
+        });
+        if (popped == 0) {
+            this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(RingLoggerTest, ManyThreads) {
+    auto writer = make_shared<RingWriter>(4096, RingWriter::Overflow::Block);
+    auto sink = make_shared<test_sink>();
+    writer->Start();
+
+    {
+        RingLogger logger("test", sink, writer);
+        logger.set_pattern("%n %v");
+
+        vector<thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&logger, t] {
+                for (int i = 0; i < 1000; i++) {
+                    logger.info("{}:{}", t, i);
+                }
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+        logger.flush();
+    }
+
+    ASSERT_EQ(sink->lines.size(), 4000);
+    vector<int> next(4, 0);
+    for (const string &line : sink->lines) {
+        int t, i;
+        ASSERT_EQ(sscanf(line.c_str(), "test %d:%d", &t, &i), 2);
+        EXPECT_EQ(i, next[t]++);
+    }
+    EXPECT_LT(sink->batches, 4000);
+    writer->Stop();
+}
+
+TEST(RingLoggerTest, DropsCounted) {
+    auto writer = make_shared<RingWriter>(4096, RingWriter::Overflow::Drop);
+    auto sink = make_shared<test_sink>();
+    RingLogger logger("test", sink, writer);
+    logger.set_pattern("%v");
+
+    // Nobody drains rings yet
+    for (int i = 0; i < 5; i++) {
+        logger.warn("lost");
+    }
+    EXPECT_EQ(writer->dropped(), 5);
+
+    writer->Start();
+    logger.warn("written");
+    logger.flush();
+
+    ASSERT_EQ(sink->lines.size(), 2);
+    EXPECT_EQ(sink->lines[0].find("Dropped 5 log records"), 0);
+    EXPECT_EQ(sink->lines[1].find("written"), 0);
+    writer->Stop();
+}
+
+TEST(RingLoggerTest, PostRunsOnLoggingThread) {
+    RingWriter writer(4096, RingWriter::Overflow::Drop);
+    writer.Start();
+
+    thread::id task_thread;
+    writer.Post([&task_thread] { task_thread = this_thread::get_id(); });
+    writer.Sync();
+    EXPECT_NE(task_thread, thread::id());
+    EXPECT_NE(task_thread, this_thread::get_id());
+
+    writer.Stop();
+}
@@ -0,0 +1,129 @@
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+#include <afina/logging/Config.h>
+
+#include "logging/ServiceImpl.h"
+
+using namespace std;
+using namespace Afina::Logging;
+
+static string ReadFile(const string &path) {
+    ifstream in(path);
+    stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+// Returns number of write system calls made by the process so far
+static uint64_t WriteCalls() {
+    ifstream in("/proc/self/io");
+    string key;
+    uint64_t value = 0;
+    while (in >> key >> value) {
+        if (key == "syscw:") {
+            return value;
+        }
+    }
+    return 0;
+}
+
+TEST(ServiceImplTest, ColoredConsoleBatched) {
+    string path = "/tmp/afina_logging_console_" + to_string(getpid()) + ".log";
+    string file_path = path + ".file";
+
+    // Logger with two appenders gets distribution sink over them
+    shared_ptr<Config> cfg = make_shared<Config>();
+    Appender &console = cfg->appenders["console"];
+    console.type = Appender::Type::STDOUT;
+    console.color = true;
+    Appender &file = cfg->appenders["file"];
+    file.type = Appender::Type::FILE;
+    file.file = file_path;
+
+    Logger &root = cfg->loggers["root"];
+    root.level = Logger::Level::INFO;
+    root.format = "%v";
+    root.appenders.push_back("console");
+    root.appenders.push_back("file");
+
+    // Console output goes to the file for the time of the test
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    int out = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT_NE(-1, out);
+    dup2(out, STDOUT_FILENO);
+    close(out);
+
+    const int records = 200;
+    uint64_t writes = 0;
+    {
+        ServiceImpl service(cfg);
+        service.Start();
+        auto log = service.select("root");
+
+        const uint64_t before = WriteCalls();
+        for (int i = 0; i < records; i++) {
+            log->info("record {}", i);
+        }
+        log->flush();
+        writes = WriteCalls() - before;
+        service.Stop();
+    }
+    spdlog::drop_all();
+
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    // Records written one by one take a write per appender each
+    EXPECT_LT(writes, records / 4);
+
+    string colored = ReadFile(path);
+    EXPECT_EQ(0, colored.find("\033[1mrecord 0\n\033[00m\033[1mrecord 1\n\033[00m"));
+    EXPECT_EQ(0, ReadFile(file_path).find("record 0\nrecord 1\n"));
+    unlink(path.c_str());
+    unlink(file_path.c_str());
+}
+
+TEST(ServiceImplTest, ReopenRotatedFile) {
+    string path = "/tmp/afina_logging_test_" + to_string(getpid()) + ".log";
+    string rotated = path + ".1";
+
+    shared_ptr<Config> cfg = make_shared<Config>();
+    Appender &file = cfg->appenders["file"];
+    file.type = Appender::Type::FILE;
+    file.file = path;
+
+    Logger &root = cfg->loggers["root"];
+    root.level = Logger::Level::INFO;
+    root.format = "%v";
+    root.appenders.push_back("file");
+
+    ServiceImpl service(cfg);
+    service.Start();
+
+    auto log = service.select("root");
+    log->info("before");
+    log->flush();
+
+    ASSERT_EQ(rename(path.c_str(), rotated.c_str()), 0);
+    service.reopen_all();
+    log->flush();
+
+    log->info("after");
+    service.Stop();
+
+    EXPECT_EQ(ReadFile(rotated), "before\n");
+    EXPECT_EQ(ReadFile(path), "after\n");
+    unlink(path.c_str());
+    unlink(rotated.c_str());
+}
@@ -0,0 +1,153 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <afina/logging/Config.h>
+
+#include "logging/ServiceImpl.h"
+#include "network/Handoff.h"
+
+using namespace Afina;
+using namespace std;
+
+namespace {
+
+shared_ptr<Logging::Service> LogService() {
+    static shared_ptr<Logging::ServiceImpl> service;
+    if (!service) {
+        shared_ptr<Logging::Config> cfg = make_shared<Logging::Config>();
+        cfg->appenders["console"].type = Logging::Appender::Type::STDERR;
+
+        Logging::Logger &root = cfg->loggers["root"];
+        root.level = Logging::Logger::Level::WARNING;
+        root.format = "%v";
+        root.appenders.push_back("console");
+
+        service = make_shared<Logging::ServiceImpl>(cfg);
+        service->Start();
+    }
+    return service;
+}
+
+string HandoffPath() { return "/tmp/afina_handoff_test_" + to_string(getpid()) + ".sock"; }
+
+// Listening socket on the loopback ephemeral port
+int Listen(uint16_t &port) {
+    int s = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (s == -1 || bind(s, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(s, 16) == -1 ||
+        getsockname(s, (struct sockaddr *)&addr, &len) == -1) {
+        return -1;
+    }
+    port = ntohs(addr.sin_port);
+    return s;
+}
+
+uint16_t Port(int s) {
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    getsockname(s, (struct sockaddr *)&addr, &len);
+    return ntohs(addr.sin_port);
+}
+
+bool WaitFor(const atomic<bool> &flag) {
+    for (int i = 0; i < 500 && !flag.load(); i++) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    return flag.load();
+}
+
+} // namespace
+
+TEST(HandoffTest, NoPreviousProcess) {
+    Network::Handoff handoff(HandoffPath(), LogService());
+    EXPECT_EQ(-1, handoff.Request());
+    EXPECT_NO_THROW(handoff.Confirm());
+}
+
+TEST(HandoffTest, TakeOver) {
+    uint16_t port = 0;
+    int listen_socket = Listen(port);
+    ASSERT_NE(-1, listen_socket);
+
+    atomic<bool> taken_over(false);
+    Network::Handoff old(HandoffPath(), LogService());
+    old.Start(listen_socket, [&taken_over]() { taken_over.store(true); });
+
+    Network::Handoff next(HandoffPath(), LogService());
+    int received = next.Request();
+    ASSERT_NE(-1, received);
+    EXPECT_EQ(port, Port(received));
+    EXPECT_FALSE(taken_over.load());
+
+    next.Confirm();
+    EXPECT_TRUE(WaitFor(taken_over));
+
+    // Next process accepts on the same socket even after the old one closed its descriptor
+    old.Stop();
+    close(listen_socket);
+
+    int client = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(0, connect(client, (struct sockaddr *)&addr, sizeof(addr)));
+
+    int accepted = accept(received, nullptr, nullptr);
+    EXPECT_NE(-1, accepted);
+    close(accepted);
+    close(client);
+
+    // The next process serves the path now
+    next.Start(received, []() {});
+    Network::Handoff third(HandoffPath(), LogService());
+    int again = third.Request();
+    EXPECT_EQ(port, Port(again));
+    close(again);
+    next.Stop();
+    close(received);
+}
+
+TEST(HandoffTest, KeepServingIfNotConfirmed) {
+    uint16_t port = 0;
+    int listen_socket = Listen(port);
+    ASSERT_NE(-1, listen_socket);
+
+    atomic<bool> taken_over(false);
+    Network::Handoff old(HandoffPath(), LogService());
+    old.Start(listen_socket, [&taken_over]() { taken_over.store(true); });
+
+    // Next process dies before it confirms
+    {
+        Network::Handoff failed(HandoffPath(), LogService());
+        int received = failed.Request();
+        ASSERT_NE(-1, received);
+        close(received);
+    }
+
+    Network::Handoff next(HandoffPath(), LogService());
+    int received = next.Request();
+    ASSERT_NE(-1, received);
+    EXPECT_EQ(port, Port(received));
+    EXPECT_FALSE(taken_over.load());
+
+    next.Confirm();
+    EXPECT_TRUE(WaitFor(taken_over));
+    old.Stop();
+    close(received);
+    close(listen_socket);
+}
@@ -3,6 +3,7 @@
 #include <memory>
 #include <string>
 
+#include <afina/allocator/Arena.h>
 #include <afina/execute/Add.h>
 #include <afina/execute/Get.h>
 #include <afina/execute/Set.h>
@@ -37,6 +38,27 @@ TEST(MemcachedParserTest, SimpleSet) {
     ASSERT_EQ(0, tmp->expire());
 }
 
+// Verify command could be placed into the arena
+TEST(MemcachedParserTest, BuildInArena) {
+    Protocol::Parser parser;
+    Allocator::Arena arena;
+
+    size_t consumed = 0;
+    ASSERT_TRUE(parser.Parse("set foo 0 0 6\r\nfooval\r\n", consumed));
+
+    size_t value_size;
+    Execute::CommandPtr cmd = parser.Build(value_size, arena);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ(6, value_size);
+    ASSERT_GT(arena.capacity(), 0);
+
+    Execute::Set *tmp = reinterpret_cast<Execute::Set *>(cmd.get());
+    ASSERT_EQ("foo", tmp->key());
+
+    cmd.reset();
+    arena.reset();
+}
+
 // Verify simple add command passed in a single string
 TEST(MemcachedParserTest, SimpleAdd) {
     Protocol::Parser parser;
@@ -98,3 +120,35 @@ TEST(MemcachedParserTest, Stats) {
     Execute::Stats *tmp = reinterpret_cast<Execute::Stats *>(cmd.get());
     ASSERT_FALSE(tmp == nullptr);
 }
+
+TEST(MemcachedParserTest, StatsSlowLog) {
+    Protocol::Parser parser;
+
+    size_t consumed = 0;
+    bool cmd_avail = parser.Parse("stats slowlog\r\n", consumed);
+    ASSERT_TRUE(cmd_avail);
+    ASSERT_EQ(15, consumed);
+    ASSERT_EQ("stats", parser.Name());
+    ASSERT_EQ(1, parser.Keys().size());
+    ASSERT_EQ("slowlog", parser.Keys()[0]);
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ(0, value_size);
+}
+
+TEST(MemcachedParserTest, Snapshot) {
+    Protocol::Parser parser;
+
+    size_t consumed = 0;
+    bool cmd_avail = parser.Parse("snapshot\r\n", consumed);
+    ASSERT_TRUE(cmd_avail);
+    ASSERT_EQ(10, consumed);
+    ASSERT_EQ("snapshot", parser.Name());
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ(0, value_size);
+}
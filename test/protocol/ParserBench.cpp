@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <afina/allocator/Arena.h>
+#include <afina/execute/Command.h>
+
+#include "protocol/Parser.h"
+
+using namespace Afina;
+
+namespace {
+
+/**
+ * Feeds input to the parser the same way network layer does, command bodies are skipped. State persists between
+ * calls, so command could be split across any number of them
+ */
+class Driver {
+public:
+    // Feeds input by chunks of the given size, returns number of commands completed
+    std::size_t Feed(const std::string &input, std::size_t chunk) {
+        std::size_t commands = 0;
+        for (std::size_t offset = 0; offset < input.size(); offset += chunk) {
+            commands += Feed(input.data() + offset, std::min(chunk, input.size() - offset));
+        }
+        return commands;
+    }
+
+    std::size_t Feed(const char *data, std::size_t size) {
+        std::size_t commands = 0;
+        while (size > 0) {
+            if (!_command) {
+                std::size_t parsed = 0;
+                if (_parser.Parse(data, size, parsed)) {
+                    _command = _parser.Build(_body_remains, _arena);
+                    if (_body_remains > 0) {
+                        _body_remains += 2;
+                    }
+                }
+                if (parsed == 0) {
+                    break;
+                }
+                data += parsed;
+                size -= parsed;
+            }
+
+            if (_command && _body_remains > 0) {
+                const std::size_t skip = std::min(_body_remains, size);
+                data += skip;
+                size -= skip;
+                _body_remains -= skip;
+            }
+
+            if (_command && _body_remains == 0) {
+                commands++;
+                _command.reset();
+                _arena.reset();
+                _parser.Reset();
+            }
+        }
+        return commands;
+    }
+
+private:
+    Protocol::Parser _parser;
+    Allocator::Arena _arena;
+    Execute::CommandPtr _command;
+    std::size_t _body_remains = 0;
+};
+
+struct Scenario {
+    const char *name;
+
+    // Bytes and commands processed by one run
+    std::size_t bytes;
+    std::size_t commands;
+
+    std::function<void()> run;
+};
+
+void Measure(const Scenario &scenario, double seconds) {
+    // Warm up arena and parser buffers
+    scenario.run();
+
+    std::size_t runs = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = start - start;
+    do {
+        for (int i = 0; i < 16; i++) {
+            scenario.run();
+        }
+        runs += 16;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed < std::chrono::duration<double>(seconds));
+
+    const double sec = std::chrono::duration_cast<std::chrono::duration<double>>(elapsed).count();
+    std::printf("%-24s %10.1f MB/s %12.0f cmd/s %10.1f ns/cmd\n", scenario.name,
+                runs * scenario.bytes / sec / (1 << 20), runs * scenario.commands / sec,
+                sec * 1e9 / (runs * scenario.commands));
+}
+
+std::string Key(std::size_t i) { return "user:session:" + std::to_string(1000000 + i); }
+
+std::string Set(std::size_t i, std::size_t value_size) {
+    return "set " + Key(i) + " 0 0 " + std::to_string(value_size) + "\r\n" + std::string(value_size, 'v') + "\r\n";
+}
+
+} // namespace
+
+/**
+ * Parser throughput on pipelines network layer could see: many small commands in the single buffer, multi-get
+ * with many keys, commands split at every byte boundary and large bodies
+ *
+ * Usage: runParserBench [seconds per scenario]
+ */
+int main(int argc, char **argv) {
+    const double seconds = argc > 1 ? std::atof(argv[1]) : 1.0;
+
+    Driver driver;
+    std::vector<Scenario> scenarios;
+
+    // Pipeline of small gets and sets read by 4K chunks
+    std::string pipeline;
+    std::size_t pipeline_commands = 0;
+    for (std::size_t i = 0; pipeline.size() < (64 << 10); i++, pipeline_commands++) {
+        pipeline += i % 10 == 0 ? Set(i, 32) : "get " + Key(i) + "\r\n";
+    }
+    scenarios.push_back({"pipeline get/set", pipeline.size(), pipeline_commands,
+                         [&] { driver.Feed(pipeline, 4096); }});
+
+    // Multi-get of 100 keys
+    std::string multiget = "get";
+    for (std::size_t i = 0; i < 100; i++) {
+        multiget += " " + Key(i);
+    }
+    multiget += "\r\n";
+    std::string multigets;
+    for (int i = 0; i < 16; i++) {
+        multigets += multiget;
+    }
+    scenarios.push_back({"multi-get 100 keys", multigets.size(), 16, [&] { driver.Feed(multigets, 4096); }});
+
+    // Set split at every possible position, each part arrives in own read
+    const std::string set = Set(42, 64);
+    scenarios.push_back({"set split everywhere", set.size() * (set.size() - 1), set.size() - 1, [&] {
+                             for (std::size_t split = 1; split < set.size(); split++) {
+                                 std::size_t commands = driver.Feed(set.data(), split);
+                                 commands += driver.Feed(set.data() + split, set.size() - split);
+                                 if (commands != 1) {
+                                     throw std::runtime_error("Split command isn't parsed");
+                                 }
+                             }
+                         }});
+
+    // Byte by byte input
+    scenarios.push_back({"set byte by byte", set.size(), 1, [&] { driver.Feed(set, 1); }});
+
+    // Large bodies, parser has to deal with the header only
+    std::string large;
+    for (int i = 0; i < 4; i++) {
+        large += Set(i, 1 << 20);
+    }
+    scenarios.push_back({"set 1MB bodies", large.size(), 4, [&] { driver.Feed(large, 64 << 10); }});
+
+    try {
+        for (const Scenario &scenario : scenarios) {
+            Measure(scenario, seconds);
+        }
+    } catch (std::exception &e) {
+        std::fprintf(stderr, "Error: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
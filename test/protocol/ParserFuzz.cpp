@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <afina/allocator/Arena.h>
+#include <afina/execute/Command.h>
+
+#include "protocol/Parser.h"
+
+using namespace Afina;
+
+/**
+ * First byte of the input selects size of chunks the rest is fed to the parser by, so split commands get covered
+ * too. Malformed input must be rejected by std::runtime_error, anything else is a bug
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+
+    const std::size_t chunk = data[0] % 64 + 1;
+    const char *input = reinterpret_cast<const char *>(data + 1);
+    size--;
+
+    Protocol::Parser parser;
+    Allocator::Arena arena;
+    Execute::CommandPtr command;
+    std::size_t body_remains = 0;
+    try {
+        for (std::size_t offset = 0; offset < size; offset += chunk) {
+            const char *buffer = input + offset;
+            std::size_t remains = std::min(chunk, size - offset);
+
+            while (remains > 0) {
+                if (!command) {
+                    std::size_t parsed = 0;
+                    const bool complete = parser.Parse(buffer, remains, parsed);
+                    if (parsed > remains) {
+                        std::abort();
+                    }
+                    if (complete) {
+                        command = parser.Build(body_remains, arena);
+                        if (!command) {
+                            std::abort();
+                        }
+                        if (body_remains > 0) {
+                            body_remains += 2;
+                        }
+                    }
+                    if (parsed == 0) {
+                        break;
+                    }
+                    buffer += parsed;
+                    remains -= parsed;
+                }
+
+                if (command && body_remains > 0) {
+                    const std::size_t skip = std::min(body_remains, remains);
+                    buffer += skip;
+                    remains -= skip;
+                    body_remains -= skip;
+                }
+
+                if (command && body_remains == 0) {
+                    command.reset();
+                    arena.reset();
+                    parser.Reset();
+                }
+            }
+        }
+    } catch (const std::runtime_error &) {
+        // Malformed input
+    }
+    return 0;
+}
+
+#ifndef AFINA_LIBFUZZER
+namespace {
+
+void Replay(const std::string &path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        throw std::runtime_error("Can't access " + path);
+    }
+
+    if (S_ISDIR(st.st_mode)) {
+        DIR *dir = opendir(path.c_str());
+        if (dir == nullptr) {
+            throw std::runtime_error("Can't open " + path);
+        }
+        while (struct dirent *entry = readdir(dir)) {
+            const std::string name = entry->d_name;
+            if (name != "." && name != "..") {
+                Replay(path + "/" + name);
+            }
+        }
+        closedir(dir);
+        return;
+    }
+
+    // Every input is tried with all chunk sizes
+    std::ifstream file(path, std::ios::binary);
+    std::string input(1, '\0');
+    input.append(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    for (int chunk = 0; chunk < 64; chunk++) {
+        input[0] = static_cast<char>(chunk);
+        LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(input.data()), input.size());
+    }
+    std::printf("%s: ok\n", path.c_str());
+}
+
+} // namespace
+
+/**
+ * Without libFuzzer runs inputs from given files and directories, for example to check crashes found elsewhere
+ *
+ * Usage: runParserFuzz <file or directory>...
+ */
+int main(int argc, char **argv) {
+    try {
+        for (int i = 1; i < argc; i++) {
+            Replay(argv[i]);
+        }
+    } catch (std::exception &e) {
+        std::fprintf(stderr, "Error: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
+#endif // AFINA_LIBFUZZER
@@ -0,0 +1,113 @@
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+
+#include "storage/ClockLRU.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+
+using namespace Afina::Backend;
+using namespace std;
+
+namespace {
+
+string Stat(Afina::Storage &storage, const string &name) {
+    vector<pair<string, string>> stats;
+    storage.Stats(stats);
+    for (auto &stat : stats) {
+        if (stat.first == name) {
+            return stat.second;
+        }
+    }
+    return "";
+}
+
+} // namespace
+
+TEST(ClockLRUTest, PutGetDelete) {
+    ClockLRU storage;
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY1", "val2"));
+    EXPECT_TRUE(storage.PutIfAbsent("KEY2", "val3"));
+    EXPECT_FALSE(storage.PutIfAbsent("KEY2", "val4"));
+    EXPECT_FALSE(storage.Set("KEY3", "val5"));
+
+    string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("val2", value);
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_EQ("val3", value);
+
+    EXPECT_TRUE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Put("KEY4", string(2000, 'x')));
+
+    // Slot of the deleted item is reused
+    EXPECT_TRUE(storage.Put("KEY5", "val6"));
+    EXPECT_EQ("2", Stat(storage, "clock_slots"));
+}
+
+TEST(ClockLRUTest, ReferencedItemSurvives) {
+    // Ten items of 10 bytes
+    ClockLRU storage(100);
+    for (int i = 0; i < 10; i++) {
+        ASSERT_TRUE(storage.Put("key" + to_string(i), "value" + to_string(i)));
+    }
+
+    // Hand passes referenced item and takes the next one
+    string value;
+    ASSERT_TRUE(storage.Get("key0", value));
+    ASSERT_TRUE(storage.Put("key10", "val10"));
+    EXPECT_TRUE(storage.Get("key0", value));
+    EXPECT_FALSE(storage.Get("key1", value));
+    EXPECT_TRUE(storage.Get("key10", value));
+    EXPECT_EQ("val10", value);
+
+    // Item which keeps being read stays, others go in turn
+    for (int i = 11; i < 40; i++) {
+        ASSERT_TRUE(storage.Get("key0", value));
+        ASSERT_TRUE(storage.Put("key" + to_string(i), "val" + to_string(i)));
+    }
+    EXPECT_TRUE(storage.Get("key0", value));
+    EXPECT_FALSE(storage.Get("key20", value));
+    EXPECT_TRUE(storage.Get("key39", value));
+    EXPECT_EQ("10", Stat(storage, "storage_items"));
+    EXPECT_EQ("100", Stat(storage, "storage_used_bytes"));
+    EXPECT_EQ("10", Stat(storage, "clock_slots"));
+
+    size_t items = 0;
+    storage.ForEach([&items](const string &key, const string &value) { items++; });
+    EXPECT_EQ(10, items);
+}
+
+TEST(ClockLRUTest, BudgetWithVariousSizes) {
+    const size_t budget = 10000;
+    ClockLRU storage(budget);
+    for (int i = 0; i < 5000; i++) {
+        const string key = "key" + to_string(i % 700);
+        ASSERT_TRUE(storage.Put(key, string(i % 97 * 7, 'a' + i % 26)));
+        ASSERT_LE(stoul(Stat(storage, "storage_used_bytes")), budget);
+
+        string value;
+        ASSERT_TRUE(storage.Get(key, value));
+        ASSERT_EQ(string(i % 97 * 7, 'a' + i % 26), value);
+    }
+
+    // Growing value of existing item evicts others but not it
+    ASSERT_TRUE(storage.Put("key1", "small"));
+    ASSERT_TRUE(storage.Set("key1", string(9000, 'z')));
+    string value;
+    EXPECT_TRUE(storage.Get("key1", value));
+    EXPECT_EQ(9000, value.size());
+}
+
+TEST(ClockLRUTest, ThreadSafeOverwrite) {
+    // Overwrite must not go through the locked interface again
+    ThreadSafeClockLRU storage(100);
+    ASSERT_TRUE(storage.Put("KEY1", "val1"));
+    ASSERT_TRUE(storage.Put("KEY1", string(90, 'x')));
+
+    string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ(string(90, 'x'), value);
+}
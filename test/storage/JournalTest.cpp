@@ -0,0 +1,257 @@
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include <afina/storage/Journal.h>
+#include <afina/storage/Snapshot.h>
+
+#include "storage/SimpleLRU.h"
+#include "storage/SlabLRU.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+
+using namespace Afina::Backend;
+using namespace std;
+
+namespace {
+
+// Temporary directory removed with everything inside
+class TempDir {
+public:
+    TempDir() {
+        char path[] = "/tmp/afina-journal-test-XXXXXX";
+        _path = mkdtemp(path);
+    }
+
+    ~TempDir() {
+        for (const string &name : Files()) {
+            unlink((_path + "/" + name).c_str());
+        }
+        rmdir(_path.c_str());
+    }
+
+    vector<string> Files() const {
+        vector<string> files;
+        DIR *dir = opendir(_path.c_str());
+        while (struct dirent *entry = readdir(dir)) {
+            const string name = entry->d_name;
+            if (name != "." && name != "..") {
+                files.push_back(name);
+            }
+        }
+        closedir(dir);
+        return files;
+    }
+
+    string Path(const string &name) const { return _path + "/" + name; }
+
+private:
+    string _path;
+};
+
+string Stat(Afina::Storage &storage, const string &name) {
+    vector<pair<string, string>> stats;
+    storage.Stats(stats);
+    for (auto &stat : stats) {
+        if (stat.first == name) {
+            return stat.second;
+        }
+    }
+    return "";
+}
+
+// Storage counting its stops
+class StopCounter : public SimpleLRU {
+public:
+    StopCounter() : SimpleLRU(1 << 20), stops(0) {}
+
+    void Stop() override { stops++; }
+
+    int stops;
+};
+
+} // namespace
+
+TEST(JournalTest, ReplayAfterRestart) {
+    TempDir dir;
+    {
+        auto journal = make_shared<Journal>(make_shared<SimpleLRU>(1 << 20), dir.Path("log"));
+        journal->Start();
+        EXPECT_TRUE(journal->Put("KEY1", "val1"));
+        EXPECT_TRUE(journal->PutIfAbsent("KEY2", "val2"));
+        EXPECT_FALSE(journal->PutIfAbsent("KEY2", "val3"));
+        EXPECT_TRUE(journal->Set("KEY1", "val4"));
+        EXPECT_FALSE(journal->Set("KEY3", "val5"));
+        EXPECT_TRUE(journal->Put("KEY3", "val6"));
+        EXPECT_TRUE(journal->Delete("KEY3"));
+        journal->Stop();
+        EXPECT_EQ("5", Stat(*journal, "journal_records"));
+    }
+
+    auto storage = make_shared<SimpleLRU>(1 << 20);
+    Journal journal(storage, dir.Path("log"));
+    journal.Start();
+    EXPECT_EQ(5, journal.Replayed());
+
+    string value;
+    EXPECT_TRUE(storage->Get("KEY1", value));
+    EXPECT_EQ("val4", value);
+    EXPECT_TRUE(storage->Get("KEY2", value));
+    EXPECT_EQ("val2", value);
+    EXPECT_FALSE(storage->Get("KEY3", value));
+    journal.Stop();
+
+    // Every start writes the new segment
+    EXPECT_EQ(2, dir.Files().size());
+}
+
+TEST(JournalTest, SyncAlways) {
+    TempDir dir;
+    const int threads_count = 4;
+    const int count = 200;
+    {
+        auto journal = make_shared<Journal>(make_shared<ThreadSafeSlabLRU>(1 << 20, 64 << 10), dir.Path("log"),
+                                            Journal::Sync::Always);
+        journal->Start();
+
+        vector<thread> threads;
+        for (int t = 0; t < threads_count; t++) {
+            threads.emplace_back([journal, t] {
+                for (int i = 0; i < count; i++) {
+                    ASSERT_TRUE(journal->Put("key" + to_string(t) + "_" + to_string(i), to_string(i)));
+                }
+            });
+        }
+        for (thread &t : threads) {
+            t.join();
+        }
+
+        EXPECT_EQ(to_string(threads_count * count), Stat(*journal, "journal_records"));
+        EXPECT_NE("0", Stat(*journal, "journal_syncs"));
+        journal->Stop();
+    }
+
+    auto storage = make_shared<ThreadSafeSlabLRU>(1 << 20, 64 << 10);
+    Journal journal(storage, dir.Path("log"));
+    journal.Start();
+    EXPECT_EQ(threads_count * count, journal.Replayed());
+
+    string value;
+    EXPECT_TRUE(storage->Get("key3_199", value));
+    EXPECT_EQ("199", value);
+    journal.Stop();
+}
+
+TEST(JournalTest, KeepSameKeyOrder) {
+    TempDir dir;
+    auto storage = make_shared<ThreadSafeSimplLRU>(1 << 20);
+    {
+        auto journal = make_shared<Journal>(storage, dir.Path("log"), Journal::Sync::Never);
+        journal->Start();
+
+        vector<thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([journal, t] {
+                for (int i = 0; i < 1000; i++) {
+                    journal->Put("key" + to_string(i % 10), to_string(t) + "_" + to_string(i));
+                }
+            });
+        }
+        for (thread &t : threads) {
+            t.join();
+        }
+        journal->Stop();
+    }
+
+    auto replayed = make_shared<SimpleLRU>(1 << 20);
+    Journal(replayed, dir.Path("log")).Start();
+    for (int i = 0; i < 10; i++) {
+        string expected, value;
+        ASSERT_TRUE(storage->Get("key" + to_string(i), expected));
+        ASSERT_TRUE(replayed->Get("key" + to_string(i), value));
+        EXPECT_EQ(expected, value);
+    }
+}
+
+TEST(JournalTest, IgnoreTornTail) {
+    TempDir dir;
+    {
+        Journal journal(make_shared<SimpleLRU>(1 << 20), dir.Path("log"));
+        journal.Start();
+        journal.Put("KEY1", "val1");
+        journal.Put("KEY2", "val2");
+        journal.Stop();
+    }
+
+    // Second record is cut in the middle
+    const int record_size = 9 + 4 + 4 + 4;
+    ASSERT_EQ(0, truncate(dir.Path("log.1").c_str(), record_size + 10));
+
+    auto storage = make_shared<SimpleLRU>(1 << 20);
+    Journal journal(storage, dir.Path("log"));
+    journal.Start();
+    EXPECT_EQ(1, journal.Replayed());
+
+    string value;
+    EXPECT_TRUE(storage->Get("KEY1", value));
+    EXPECT_FALSE(storage->Get("KEY2", value));
+    journal.Stop();
+}
+
+TEST(JournalTest, CompactBySnapshot) {
+    TempDir dir;
+    {
+        auto journal = make_shared<Journal>(make_shared<SimpleLRU>(1 << 20), dir.Path("log"));
+        Snapshot snapshot(journal, dir.Path("snapshot"));
+        snapshot.OnFinish([journal](bool ok) { journal->Compact(ok); });
+        journal->Start();
+
+        journal->Put("KEY1", "val1");
+        journal->Put("KEY2", "val2");
+        ASSERT_TRUE(snapshot.Trigger());
+        journal->Delete("KEY1");
+        ASSERT_TRUE(snapshot.Wait());
+        journal->Put("KEY3", "val3");
+        journal->Stop();
+    }
+
+    // Snapshot replaces the first segment
+    vector<string> files = dir.Files();
+    sort(files.begin(), files.end());
+    ASSERT_EQ(2, files.size());
+    EXPECT_EQ("log.2", files[0]);
+    EXPECT_EQ("snapshot", files[1]);
+
+    auto storage = make_shared<SimpleLRU>(1 << 20);
+    auto journal = make_shared<Journal>(storage, dir.Path("log"));
+    EXPECT_EQ(2, Snapshot(journal, dir.Path("snapshot")).Load());
+    journal->Start();
+    EXPECT_EQ(2, journal->Replayed());
+
+    string value;
+    EXPECT_FALSE(storage->Get("KEY1", value));
+    EXPECT_TRUE(storage->Get("KEY2", value));
+    EXPECT_EQ("val2", value);
+    EXPECT_TRUE(storage->Get("KEY3", value));
+    EXPECT_EQ("val3", value);
+    journal->Stop();
+}
+
+TEST(JournalTest, StopStorageOnce) {
+    TempDir dir;
+    auto storage = make_shared<StopCounter>();
+    {
+        Journal journal(storage, dir.Path("log"));
+        journal.Start();
+        journal.Stop();
+        journal.Stop();
+    }
+    EXPECT_EQ(1, storage->stops);
+}
@@ -0,0 +1,111 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/ReadMostlyLRU.h"
+
+using namespace Afina::Backend;
+using namespace std;
+
+TEST(ReadMostlyLRUTest, PutGetDelete) {
+    ReadMostlyLRU storage;
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.PutIfAbsent("KEY2", "val2"));
+    EXPECT_FALSE(storage.PutIfAbsent("KEY2", "val3"));
+    EXPECT_FALSE(storage.Set("KEY3", "val3"));
+    EXPECT_TRUE(storage.Set("KEY2", "val4"));
+
+    string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("val1", value);
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_EQ("val4", value);
+
+    EXPECT_TRUE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+
+    // Item larger than the whole storage
+    EXPECT_FALSE(storage.Put("KEY4", string(2000, 'x')));
+}
+
+TEST(ReadMostlyLRUTest, ReferencedItemSurvives) {
+    // Ten items of 10 bytes
+    ReadMostlyLRU storage(100);
+    for (int i = 0; i < 10; i++) {
+        ASSERT_TRUE(storage.Put("key" + to_string(i), "value" + to_string(i)));
+    }
+
+    // Oldest item is read, so the next one goes instead of it
+    string value;
+    ASSERT_TRUE(storage.Get("key0", value));
+    ASSERT_TRUE(storage.Put("key10", "val10"));
+    EXPECT_TRUE(storage.Get("key0", value));
+    EXPECT_FALSE(storage.Get("key1", value));
+
+    // Item which isn't read anymore is evicted eventually
+    for (int i = 11; i < 30; i++) {
+        ASSERT_TRUE(storage.Put("key" + to_string(i), "val" + to_string(i)));
+    }
+    EXPECT_FALSE(storage.Get("key0", value));
+
+    // Budget is kept and order is oldest first
+    vector<string> keys;
+    storage.ForEach([&keys](const string &key, const string &value) { keys.push_back(key); });
+    ASSERT_EQ(10, keys.size());
+    EXPECT_EQ("key20", keys.front());
+    EXPECT_EQ("key29", keys.back());
+}
+
+TEST(ReadMostlyLRUTest, SetEvictsOthers) {
+    ReadMostlyLRU storage(100);
+    ASSERT_TRUE(storage.Put("a", string(40, 'a')));
+    ASSERT_TRUE(storage.Put("b", string(40, 'b')));
+
+    // Larger value doesn't fit, older item goes
+    ASSERT_TRUE(storage.Set("b", string(90, 'c')));
+
+    string value;
+    EXPECT_FALSE(storage.Get("a", value));
+    EXPECT_TRUE(storage.Get("b", value));
+    EXPECT_EQ(string(90, 'c'), value);
+}
+
+TEST(ReadMostlyLRUTest, ConcurrentReads) {
+    ReadMostlyLRU storage(1 << 20);
+    const int keys = 1000;
+    for (int i = 0; i < keys; i++) {
+        ASSERT_TRUE(storage.Put("key" + to_string(i), "value" + to_string(i)));
+    }
+
+    // Readers see consistent values while writer keeps changing the storage
+    atomic<bool> stop(false);
+    atomic<int> errors(0);
+    vector<thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&storage, &stop, &errors, t]() {
+            string value;
+            for (int i = t; !stop.load(); i = (i + 7) % keys) {
+                const string key = "key" + to_string(i);
+                if (storage.Get(key, value) && value != "value" + to_string(i)) {
+                    errors++;
+                }
+            }
+        });
+    }
+
+    for (int round = 0; round < 20; round++) {
+        for (int i = round; i < keys; i += 20) {
+            const string key = "key" + to_string(i);
+            storage.Delete(key);
+            storage.Put(key, "value" + to_string(i));
+        }
+    }
+    stop.store(true);
+    for (auto &t : readers) {
+        t.join();
+    }
+    EXPECT_EQ(0, errors.load());
+}
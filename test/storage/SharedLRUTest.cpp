@@ -0,0 +1,165 @@
+#include "gtest/gtest.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "storage/SharedLRU.h"
+
+using namespace Afina::Backend;
+using namespace std;
+
+namespace {
+
+string SegmentName() { return "/afina-shared-lru-test-" + to_string(getpid()); }
+
+string Stat(Afina::Storage &storage, const string &name) {
+    vector<pair<string, string>> stats;
+    storage.Stats(stats);
+    for (auto &stat : stats) {
+        if (stat.first == name) {
+            return stat.second;
+        }
+    }
+    return "";
+}
+
+} // namespace
+
+TEST(SharedLRUTest, PutGetDelete) {
+    SharedLRU::Remove(SegmentName());
+    SharedLRU storage(SegmentName(), 1 << 20);
+    EXPECT_FALSE(storage.attached());
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.PutIfAbsent("KEY2", "val2"));
+    EXPECT_FALSE(storage.PutIfAbsent("KEY2", "val3"));
+    EXPECT_FALSE(storage.Set("KEY3", "val3"));
+
+    string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ(value, "val1");
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_EQ(value, "val2");
+
+    // Value doesn't fit the block anymore
+    string large(1000, 'x');
+    EXPECT_TRUE(storage.Set("KEY1", large));
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ(value, large);
+
+    EXPECT_TRUE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_TRUE(storage.Get("KEY2", value));
+
+    SharedLRU::Remove(SegmentName());
+}
+
+TEST(SharedLRUTest, EvictLeastRecent) {
+    SharedLRU::Remove(SegmentName());
+    SharedLRU storage(SegmentName(), 1 << 20);
+
+    // Sizes vary, so heap gets compacted from time to time
+    const int count = 20000;
+    for (int i = 0; i < count; i++) {
+        ASSERT_TRUE(storage.Put("key" + to_string(i), string(20 + i % 13 * 17, 'a' + i % 26)));
+
+        // Keep the first key hot
+        string value;
+        ASSERT_TRUE(storage.Get("key0", value));
+    }
+
+    string value;
+    EXPECT_FALSE(storage.Get("key1", value));
+    EXPECT_TRUE(storage.Get("key0", value));
+    EXPECT_TRUE(storage.Get("key" + to_string(count - 1), value));
+    EXPECT_EQ(string(20 + (count - 1) % 13 * 17, 'a' + (count - 1) % 26), value);
+    EXPECT_NE("0", Stat(storage, "storage_evictions"));
+    EXPECT_NE("0", Stat(storage, "shm_defrags"));
+
+    // Everything left is in order
+    size_t items = 0;
+    storage.ForEach([&items](const string &key, const string &value) {
+        const int i = stoi(key.substr(3));
+        EXPECT_EQ(string(20 + i % 13 * 17, 'a' + i % 26), value);
+        items++;
+    });
+    EXPECT_EQ(to_string(items), Stat(storage, "storage_items"));
+
+    SharedLRU::Remove(SegmentName());
+}
+
+TEST(SharedLRUTest, SurviveReopen) {
+    SharedLRU::Remove(SegmentName());
+    {
+        SharedLRU storage(SegmentName(), 1 << 20);
+        for (int i = 0; i < 100; i++) {
+            ASSERT_TRUE(storage.Put("key" + to_string(i), "value" + to_string(i)));
+        }
+    }
+
+    SharedLRU storage(SegmentName(), 1 << 20);
+    EXPECT_TRUE(storage.attached());
+    EXPECT_EQ("100", Stat(storage, "storage_items"));
+
+    // Second mapping of the same segment lives at other address
+    SharedLRU other(SegmentName(), 1 << 20);
+    ASSERT_TRUE(other.Put("key100", "value100"));
+
+    string value;
+    for (int i = 0; i <= 100; i++) {
+        ASSERT_TRUE(storage.Get("key" + to_string(i), value));
+        EXPECT_EQ("value" + to_string(i), value);
+    }
+
+    // Segment of other size is recreated, while the old one stays valid for processes having it mapped
+    SharedLRU resized(SegmentName(), 2 << 20);
+    EXPECT_FALSE(resized.attached());
+    EXPECT_FALSE(resized.Get("key0", value));
+    ASSERT_TRUE(resized.Put("key0", "resized"));
+
+    ASSERT_TRUE(storage.Get("key0", value));
+    EXPECT_EQ("value0", value);
+    ASSERT_TRUE(other.Put("key101", "value101"));
+    ASSERT_TRUE(storage.Get("key101", value));
+    EXPECT_EQ("value101", value);
+    EXPECT_EQ("102", Stat(storage, "storage_items"));
+
+    SharedLRU reopened(SegmentName(), 2 << 20);
+    EXPECT_TRUE(reopened.attached());
+    ASSERT_TRUE(reopened.Get("key0", value));
+    EXPECT_EQ("resized", value);
+
+    SharedLRU::Remove(SegmentName());
+}
+
+TEST(SharedLRUTest, ShareWithOtherProcess) {
+    const string name = SegmentName();
+    SharedLRU::Remove(name);
+    SharedLRU storage(name, 1 << 20);
+    ASSERT_TRUE(storage.Put("parent", "1"));
+
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        // Child opens segment by name, like the new server process does
+        SharedLRU child(name, 1 << 20);
+        string value;
+        const bool ok = child.attached() && child.Get("parent", value) && value == "1" && child.Put("child", "2");
+        _exit(ok ? 0 : 1);
+    }
+
+    int status = 0;
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(0, WEXITSTATUS(status));
+
+    string value;
+    EXPECT_TRUE(storage.Get("child", value));
+    EXPECT_EQ("2", value);
+
+    SharedLRU::Remove(name);
+}
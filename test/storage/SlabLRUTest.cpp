@@ -0,0 +1,112 @@
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+
+#include "storage/SlabLRU.h"
+
+using namespace Afina::Backend;
+using namespace std;
+
+TEST(SlabLRUTest, PutGetDelete) {
+    SlabLRU storage(1 << 20, 64 << 10);
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.PutIfAbsent("KEY2", "val2"));
+    EXPECT_FALSE(storage.PutIfAbsent("KEY2", "val3"));
+    EXPECT_FALSE(storage.Set("KEY3", "val3"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ(value, "val1");
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_EQ(value, "val2");
+
+    // Value moves to another size class
+    std::string large(1000, 'x');
+    EXPECT_TRUE(storage.Set("KEY1", large));
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ(value, large);
+
+    EXPECT_TRUE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_TRUE(storage.Get("KEY2", value));
+}
+
+TEST(SlabLRUTest, EvictLeastRecent) {
+    SlabLRU storage(16 << 10, 4 << 10);
+
+    const int count = 1000;
+    for (int i = 0; i < count; i++) {
+        ASSERT_TRUE(storage.Put("key" + to_string(i), "value" + to_string(i)));
+
+        // Keep the first key fresh
+        std::string value;
+        ASSERT_TRUE(storage.Get("key0", value));
+    }
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("key0", value));
+    EXPECT_FALSE(storage.Get("key1", value));
+    EXPECT_TRUE(storage.Get("key" + to_string(count - 1), value));
+    EXPECT_EQ(value, "value" + to_string(count - 1));
+
+    std::vector<std::pair<std::string, std::string>> stats;
+    storage.Stats(stats);
+    bool evicted = false, grown = false;
+    for (auto &stat : stats) {
+        evicted = evicted || (stat.first == "storage_evictions" && stat.second != "0");
+        grown = grown || (stat.first == "storage_index_buckets" && stat.second != "16");
+    }
+    EXPECT_TRUE(evicted);
+    EXPECT_TRUE(grown);
+}
+
+TEST(SlabLRUTest, ReassignBetweenClasses) {
+    SlabLRU storage(16 << 10, 4 << 10);
+
+    for (int i = 0; i < 500; i++) {
+        ASSERT_TRUE(storage.Put("small" + to_string(i), "v"));
+    }
+
+    // Large value needs page owned by the small class, the oldest small items go away
+    std::string large(3000, 'y');
+    ASSERT_TRUE(storage.Put("large", large));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("large", value));
+    EXPECT_EQ(value, large);
+    EXPECT_FALSE(storage.Get("small0", value));
+    EXPECT_TRUE(storage.Get("small499", value));
+}
+
+TEST(SlabLRUTest, KeepValueIfUpdateFails) {
+    SlabLRU storage(16 << 10, 4 << 10);
+    ASSERT_TRUE(storage.Put("key", "value"));
+
+    // Value fits the cache, but no size class
+    EXPECT_FALSE(storage.Put("key", std::string(8 << 10, 'x')));
+    EXPECT_FALSE(storage.Set("key", std::string(8 << 10, 'x')));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("key", value));
+    EXPECT_EQ("value", value);
+}
+
+TEST(SlabLRUTest, MoveLeastRecentBetweenClasses) {
+    SlabLRU storage(16 << 10, 4 << 10);
+
+    // Every page is taken, the updated item is the least recent one of the class giving its page away
+    std::string large(3000, 'y');
+    ASSERT_TRUE(storage.Put("key", large));
+    ASSERT_TRUE(storage.Put("other1", large));
+    ASSERT_TRUE(storage.Put("other2", large));
+
+    std::string moved(2000, 'z');
+    ASSERT_TRUE(storage.Put("key", moved));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("key", value));
+    EXPECT_EQ(moved, value);
+    EXPECT_FALSE(storage.Get("other1", value));
+    EXPECT_TRUE(storage.Get("other2", value));
+}
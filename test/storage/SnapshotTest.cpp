@@ -0,0 +1,182 @@
+#include "gtest/gtest.h"
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include <afina/storage/Snapshot.h>
+
+#include "storage/ReadMostlyLRU.h"
+#include "storage/SharedLRU.h"
+#include "storage/SimpleLRU.h"
+#include "storage/SlabLRU.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+
+using namespace Afina::Backend;
+using namespace std;
+
+namespace {
+
+typedef vector<pair<string, string>> Items;
+
+string SnapshotPath() { return "/tmp/afina-snapshot-test-" + to_string(getpid()); }
+
+Items Collect(Afina::Storage &storage) {
+    Items items;
+    storage.ForEach([&items](const string &key, const string &value) { items.emplace_back(key, value); });
+    return items;
+}
+
+void Save(shared_ptr<Afina::Storage> storage, const string &path) {
+    Snapshot snapshot(storage, path);
+    ASSERT_TRUE(snapshot.Trigger());
+    ASSERT_TRUE(snapshot.Wait());
+
+    Snapshot::Status status = snapshot.GetStatus();
+    EXPECT_FALSE(status.in_progress);
+    EXPECT_TRUE(status.last_ok);
+    EXPECT_GT(status.last_bytes, 0);
+}
+
+} // namespace
+
+TEST(SnapshotTest, SimpleLRURoundTrip) {
+    const string path = SnapshotPath();
+    auto storage = make_shared<SimpleLRU>(1 << 20);
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(storage->Put("key" + to_string(i), string(i, 'v')));
+    }
+
+    // Recently used item goes last
+    string value;
+    ASSERT_TRUE(storage->Get("key10", value));
+
+    Save(storage, path);
+
+    auto loaded = make_shared<SimpleLRU>(1 << 20);
+    Snapshot snapshot(loaded, path);
+    EXPECT_EQ(100, snapshot.Load());
+    EXPECT_EQ(Collect(*storage), Collect(*loaded));
+    EXPECT_EQ("key10", Collect(*loaded).back().first);
+
+    unlink(path.c_str());
+}
+
+TEST(SnapshotTest, SlabLRURoundTrip) {
+    const string path = SnapshotPath();
+    auto storage = make_shared<ThreadSafeSlabLRU>(1 << 20, 64 << 10);
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(storage->Put("key" + to_string(i), string(i % 300, 'a' + i % 26)));
+    }
+
+    Save(storage, path);
+
+    auto loaded = make_shared<ThreadSafeSlabLRU>(1 << 20, 64 << 10);
+    Snapshot snapshot(loaded, path);
+    EXPECT_EQ(1000, snapshot.Load());
+    EXPECT_EQ(Collect(*storage), Collect(*loaded));
+
+    unlink(path.c_str());
+}
+
+// Child forked inside Exclusive() must not touch the lock the parent holds, whatever lock that is
+template <typename Storage> void ThreadSafeRoundTrip(shared_ptr<Storage> storage, shared_ptr<Storage> loaded) {
+    const string path = SnapshotPath();
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(storage->Put("key" + to_string(i), string(i, 'v')));
+    }
+
+    Save(storage, path);
+
+    // Storage is still usable by the parent
+    string value;
+    EXPECT_TRUE(storage->Put("after", "snapshot"));
+    EXPECT_TRUE(storage->Get("after", value));
+
+    Snapshot snapshot(loaded, path);
+    EXPECT_EQ(100, snapshot.Load());
+    Items items = Collect(*loaded);
+    EXPECT_EQ(100, items.size());
+    EXPECT_TRUE(loaded->Get("key99", value));
+    EXPECT_EQ(string(99, 'v'), value);
+
+    unlink(path.c_str());
+}
+
+TEST(SnapshotTest, ThreadSafeSimpleLRU) {
+    ThreadSafeRoundTrip(make_shared<ThreadSafeSimplLRU>(1 << 20), make_shared<ThreadSafeSimplLRU>(1 << 20));
+}
+
+TEST(SnapshotTest, ThreadSafeClockLRU) {
+    ThreadSafeRoundTrip(make_shared<ThreadSafeClockLRU>(1 << 20), make_shared<ThreadSafeClockLRU>(1 << 20));
+}
+
+TEST(SnapshotTest, ReadMostlyLRU) {
+    ThreadSafeRoundTrip(make_shared<ReadMostlyLRU>(1 << 20), make_shared<ReadMostlyLRU>(1 << 20));
+}
+
+TEST(SnapshotTest, SharedLRU) {
+    const string name = "/afina-snapshot-test-" + to_string(getpid());
+    SharedLRU::Remove(name);
+    SharedLRU::Remove(name + "-loaded");
+    ThreadSafeRoundTrip(make_shared<SharedLRU>(name, 1 << 20), make_shared<SharedLRU>(name + "-loaded", 1 << 20));
+    SharedLRU::Remove(name);
+    SharedLRU::Remove(name + "-loaded");
+}
+
+TEST(SnapshotTest, StorageChangesDuringSnapshot) {
+    const string path = SnapshotPath();
+    auto storage = make_shared<SimpleLRU>(1 << 20);
+    ASSERT_TRUE(storage->Put("key", "before"));
+
+    // Child writes the storage as it was at fork
+    Snapshot snapshot(storage, path);
+    ASSERT_TRUE(snapshot.Trigger());
+    ASSERT_TRUE(storage->Set("key", "after"));
+    ASSERT_TRUE(snapshot.Wait());
+
+    auto loaded = make_shared<SimpleLRU>(1 << 20);
+    EXPECT_EQ(1, Snapshot(loaded, path).Load());
+
+    string value;
+    ASSERT_TRUE(loaded->Get("key", value));
+    EXPECT_EQ("before", value);
+
+    unlink(path.c_str());
+}
+
+TEST(SnapshotTest, RejectCorrupted) {
+    const string path = SnapshotPath();
+    auto storage = make_shared<SimpleLRU>(1 << 20);
+    for (int i = 0; i < 10; i++) {
+        ASSERT_TRUE(storage->Put("key" + to_string(i), "value" + to_string(i)));
+    }
+    Save(storage, path);
+
+    // Flip single byte of some value
+    {
+        fstream file(path, ios::in | ios::out | ios::binary);
+        file.seekp(30);
+        file.put('X');
+    }
+
+    auto loaded = make_shared<SimpleLRU>(1 << 20);
+    EXPECT_THROW(Snapshot(loaded, path).Load(), runtime_error);
+    EXPECT_TRUE(Collect(*loaded).empty());
+
+    // Truncated file
+    ASSERT_EQ(0, truncate(path.c_str(), 40));
+    EXPECT_THROW(Snapshot(loaded, path).Load(), runtime_error);
+
+    unlink(path.c_str());
+}
+
+TEST(SnapshotTest, MissingFile) {
+    auto storage = make_shared<SimpleLRU>(1 << 20);
+    Snapshot snapshot(storage, SnapshotPath());
+    EXPECT_EQ(0, snapshot.Load());
+}
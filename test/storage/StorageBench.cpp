@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <cxxopts.hpp>
+
+#include <afina/Storage.h>
+#include <afina/execute/SlowLog.h>
+
+#include "storage/ReadMostlyLRU.h"
+#include "storage/SharedLRU.h"
+#include "storage/SimpleLRU.h"
+#include "storage/SlabLRU.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+
+#include "Histogram.h"
+
+using namespace Afina;
+using Afina::Test::Histogram;
+
+namespace {
+
+/**
+ * Backends under test, new ones should be just added here. Single threaded backends are skipped once benchmark
+ * runs more than one thread
+ */
+struct Candidate {
+    const char *name;
+    bool thread_safe;
+    std::function<std::unique_ptr<Storage>(std::size_t memory)> create;
+};
+
+const std::vector<Candidate> candidates = {
+    {"st_lru", false, [](std::size_t memory) { return std::unique_ptr<Storage>(new Backend::SimpleLRU(memory)); }},
+    {"mt_lru", true,
+     [](std::size_t memory) { return std::unique_ptr<Storage>(new Backend::ThreadSafeSimplLRU(memory)); }},
+    {"st_slab", false, [](std::size_t memory) { return std::unique_ptr<Storage>(new Backend::SlabLRU(memory)); }},
+    {"mt_slab", true,
+     [](std::size_t memory) { return std::unique_ptr<Storage>(new Backend::ThreadSafeSlabLRU(memory)); }},
+    {"st_clock", false, [](std::size_t memory) { return std::unique_ptr<Storage>(new Backend::ClockLRU(memory)); }},
+    {"mt_clock", true,
+     [](std::size_t memory) { return std::unique_ptr<Storage>(new Backend::ThreadSafeClockLRU(memory)); }},
+    {"rw_lru", true, [](std::size_t memory) { return std::unique_ptr<Storage>(new Backend::ReadMostlyLRU(memory)); }},
+    // Segment is unlinked right away, mapping keeps it alive while storage exists
+    {"shm", true,
+     [](std::size_t memory) {
+         const std::string name = "/afina-bench-" + std::to_string(getpid());
+         std::unique_ptr<Storage> storage(new Backend::SharedLRU(name, memory));
+         Backend::SharedLRU::Remove(name);
+         return storage;
+     }},
+};
+
+/**
+ * Zipf distributed ranks in [0, n), rank 0 is the most popular. Theta 0 gives uniform distribution, the larger
+ * theta the more skewed it is. Algorithm by Gray et al, "Quickly generating billion-record synthetic databases",
+ * same as YCSB uses, it requires theta < 1
+ */
+class Zipf {
+public:
+    Zipf(uint64_t n, double theta) : _n(n), _theta(theta) {
+        if (n == 0 || theta < 0 || theta >= 1) {
+            throw std::runtime_error("Zipf needs n > 0 and 0 <= theta < 1");
+        }
+
+        double zeta2 = 0;
+        for (uint64_t i = 1; i <= n; i++) {
+            const double x = 1.0 / std::pow(double(i), theta);
+            _zetan += x;
+            if (i <= 2) {
+                zeta2 += x;
+            }
+        }
+
+        _alpha = 1.0 / (1.0 - theta);
+        _eta = (1.0 - std::pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / _zetan);
+    }
+
+    template <typename Rng> uint64_t operator()(Rng &rng) {
+        const double u = std::uniform_real_distribution<double>(0, 1)(rng);
+        const double uz = u * _zetan;
+        if (uz < 1.0) {
+            return 0;
+        } else if (uz < 1.0 + std::pow(0.5, _theta)) {
+            return std::min<uint64_t>(1, _n - 1);
+        }
+        return std::min<uint64_t>(_n * std::pow(_eta * u - _eta + 1.0, _alpha), _n - 1);
+    }
+
+private:
+    uint64_t _n;
+    double _theta;
+    double _zetan = 0;
+    double _alpha;
+    double _eta;
+};
+
+/**
+ * Size distribution given as "N" for fixed size, "A-B" for uniform in range or "A-B@theta" for Zipf skewed
+ * towards the smaller sizes
+ */
+class SizeDistribution {
+public:
+    explicit SizeDistribution(const std::string &spec) {
+        char sep = 0;
+        std::istringstream in(spec);
+        in >> _min;
+        _max = _min;
+        if (in >> sep) {
+            if (sep != '-' || !(in >> _max)) {
+                throw std::runtime_error("Bad size distribution: " + spec);
+            }
+            if (in >> sep) {
+                double theta;
+                if (sep != '@' || !(in >> theta)) {
+                    throw std::runtime_error("Bad size distribution: " + spec);
+                }
+                _zipf.reset(new Zipf(_max - _min + 1, theta));
+            }
+        }
+        if (in.fail() && !in.eof()) {
+            throw std::runtime_error("Bad size distribution: " + spec);
+        }
+        if (_min == 0 || _max < _min) {
+            throw std::runtime_error("Bad size distribution: " + spec);
+        }
+    }
+
+    template <typename Rng> std::size_t operator()(Rng &rng) {
+        if (_zipf) {
+            return _min + (*_zipf)(rng);
+        }
+        return std::uniform_int_distribution<std::size_t>(_min, _max)(rng);
+    }
+
+private:
+    std::size_t _min = 0;
+    std::size_t _max = 0;
+    std::unique_ptr<Zipf> _zipf;
+};
+
+struct Workload {
+    std::size_t keys;
+    double zipf;
+    double reads;
+    std::size_t threads;
+    std::size_t ops;
+    std::size_t memory;
+    std::string key_size;
+    std::string value_size;
+    uint64_t seed;
+};
+
+struct Result {
+    double ops_per_sec;
+    double hit_ratio;
+    Histogram get_latency;
+    Histogram put_latency;
+};
+
+// Spreads popular ranks over the key space, so hot keys don't get adjacent ids
+uint64_t Scramble(uint64_t rank, uint64_t n) {
+    uint64_t x = rank + 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return (x ^ (x >> 31)) % n;
+}
+
+Result Run(Storage &storage, const Workload &w, const std::vector<std::string> &keys,
+           const std::vector<std::string> &values) {
+    // Key space is loaded first, so reads miss only keys evicted by the backend
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        storage.Put(keys[i], values[i % values.size()]);
+    }
+
+    struct thread_result {
+        uint64_t gets = 0;
+        uint64_t hits = 0;
+        Histogram get_latency;
+        Histogram put_latency;
+    };
+    std::vector<thread_result> results(w.threads);
+    std::atomic<std::size_t> ready(0);
+
+    auto worker = [&](std::size_t id) {
+        std::mt19937_64 rng(w.seed + id);
+        std::uniform_real_distribution<double> coin(0, 1);
+        Zipf popularity(keys.size(), w.zipf);
+        thread_result &r = results[id];
+        std::string out;
+
+        // Start all threads at once
+        ready++;
+        while (ready.load() < w.threads) {
+            std::this_thread::yield();
+        }
+
+        for (std::size_t i = 0; i < w.ops; i++) {
+            const std::string &key = keys[Scramble(popularity(rng), keys.size())];
+            if (coin(rng) < w.reads) {
+                const uint64_t start = Execute::TscClock::now();
+                const bool hit = storage.Get(key, out);
+                r.get_latency.add(Execute::TscClock::now() - start);
+                r.gets++;
+                r.hits += hit;
+            } else {
+                const std::string &value = values[rng() % values.size()];
+                const uint64_t start = Execute::TscClock::now();
+                storage.Put(key, value);
+                r.put_latency.add(Execute::TscClock::now() - start);
+            }
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (std::size_t id = 0; id < w.threads; id++) {
+        workers.emplace_back(worker, id);
+    }
+    for (auto &t : workers) {
+        t.join();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    Result result;
+    uint64_t gets = 0, hits = 0;
+    for (const thread_result &r : results) {
+        gets += r.gets;
+        hits += r.hits;
+        result.get_latency.merge(r.get_latency);
+        result.put_latency.merge(r.put_latency);
+    }
+
+    const double sec = std::chrono::duration_cast<std::chrono::duration<double>>(elapsed).count();
+    result.ops_per_sec = w.threads * w.ops / sec;
+    result.hit_ratio = gets > 0 ? double(hits) / gets : 0;
+    return result;
+}
+
+// Prints percentiles of the histogram of clock ticks, in nanoseconds
+void PrintLatency(const char *op, const Histogram &h) {
+    auto ns = [](uint64_t ticks) { return static_cast<unsigned long long>(Execute::TscClock::to_ns(ticks)); };
+    std::printf("  %-4s p50 %8llu  p90 %8llu  p99 %8llu  p99.9 %8llu  max %8llu ns\n", op, ns(h.percentile(50)),
+                ns(h.percentile(90)), ns(h.percentile(99)), ns(h.percentile(99.9)), ns(h.max()));
+}
+
+} // namespace
+
+/**
+ * Throughput, hit ratio and latency percentiles of storage backends under the synthetic workload: keys popularity
+ * follows Zipf distribution, operation is either Get or Put of the value of random size
+ *
+ * Usage: runStorageBench [--storage st_lru,mt_slab] [--threads 4] [--zipf 0.99] [--reads 0.9] ...
+ */
+int main(int argc, char **argv) {
+    cxxopts::Options options("runStorageBench", "Storage backends benchmark");
+    options.add_options()("storage", "Comma separated backends to run, all by default", cxxopts::value<std::string>());
+    options.add_options()("threads", "Number of threads", cxxopts::value<std::size_t>()->default_value("1"));
+    options.add_options()("ops", "Operations per thread", cxxopts::value<std::size_t>()->default_value("1000000"));
+    options.add_options()("keys", "Number of distinct keys", cxxopts::value<std::size_t>()->default_value("100000"));
+    options.add_options()("zipf", "Skew of key popularity, 0 is uniform",
+                          cxxopts::value<double>()->default_value("0.99"));
+    options.add_options()("reads", "Fraction of Get operations", cxxopts::value<double>()->default_value("0.9"));
+    options.add_options()("key-size", "Key size: N, A-B or A-B@theta",
+                          cxxopts::value<std::string>()->default_value("16-32"));
+    options.add_options()("value-size", "Value size: N, A-B or A-B@theta",
+                          cxxopts::value<std::string>()->default_value("32-512@0.9"));
+    options.add_options()("memory", "Storage size, bytes", cxxopts::value<std::size_t>()->default_value("67108864"));
+    options.add_options()("seed", "Random seed", cxxopts::value<uint64_t>()->default_value("1"));
+    options.add_options()("h,help", "Print usage info");
+
+    try {
+        options.parse(argc, argv);
+        if (options.count("help") > 0) {
+            std::cout << options.help() << std::endl;
+            return 0;
+        }
+
+        Workload w;
+        w.keys = options["keys"].as<std::size_t>();
+        w.zipf = options["zipf"].as<double>();
+        w.reads = options["reads"].as<double>();
+        w.threads = std::max<std::size_t>(1, options["threads"].as<std::size_t>());
+        w.ops = options["ops"].as<std::size_t>();
+        w.memory = options["memory"].as<std::size_t>();
+        w.key_size = options["key-size"].as<std::string>();
+        w.value_size = options["value-size"].as<std::string>();
+        w.seed = options["seed"].as<uint64_t>();
+
+        std::string selected = ",";
+        if (options.count("storage") > 0) {
+            selected += options["storage"].as<std::string>() + ",";
+        }
+
+        // Key of the same id is always the same string, its size is drawn once
+        std::mt19937_64 rng(w.seed);
+        SizeDistribution key_size(w.key_size);
+        std::vector<std::string> keys(w.keys);
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            keys[i] = std::to_string(i);
+            keys[i].resize(std::max(keys[i].size(), key_size(rng)), '.');
+        }
+
+        SizeDistribution value_size(w.value_size);
+        std::vector<std::string> values(4096);
+        for (std::string &value : values) {
+            value.assign(value_size(rng), 'v');
+        }
+
+        std::printf("keys %zu, zipf %.2f, reads %.2f, threads %zu, ops %zu, key size %s, value size %s\n", w.keys,
+                    w.zipf, w.reads, w.threads, w.ops, w.key_size.c_str(), w.value_size.c_str());
+        for (const Candidate &backend : candidates) {
+            if (selected != "," && selected.find("," + std::string(backend.name) + ",") == std::string::npos) {
+                continue;
+            }
+            if (w.threads > 1 && !backend.thread_safe) {
+                std::printf("%s: skipped, not thread safe\n", backend.name);
+                continue;
+            }
+
+            std::unique_ptr<Storage> storage = backend.create(w.memory);
+            storage->Start();
+            Result r = Run(*storage, w, keys, values);
+            storage->Stop();
+
+            std::printf("%s: %.0f ops/s, hit ratio %.4f\n", backend.name, r.ops_per_sec, r.hit_ratio);
+            PrintLatency("get", r.get_latency);
+            PrintLatency("put", r.put_latency);
+        }
+    } catch (std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}